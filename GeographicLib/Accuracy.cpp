@@ -0,0 +1,1285 @@
+/**
+ * \file Accuracy.cpp
+ * \brief Utility for checking the accuracy of the GeographicLib calculations
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * http://charles.karney.info/geographic
+ * and licensed under the LGPL.
+ *
+ * Compile with
+ *
+ *   g++ -g -O3 -I.. -o Accuracy Accuracy.cpp Geodesic.cpp TransverseMercator.cpp TransverseMercatorExact.cpp EllipticFunction.cpp PolarStereographic.cpp Geocentric.cpp LocalCartesian.cpp Multilateration.cpp Constants.cpp
+ *
+ * See \ref accuracy for usage information.
+ **********************************************************************/
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <complex>
+#include <limits>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include "GeographicLib/Geodesic.hpp"
+#include "GeographicLib/TransverseMercator.hpp"
+#include "GeographicLib/TransverseMercatorExact.hpp"
+#include "GeographicLib/PolarStereographic.hpp"
+#include "GeographicLib/Geocentric.hpp"
+#include "GeographicLib/LocalCartesian.hpp"
+#include "GeographicLib/Multilateration.hpp"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+int usage(int retval) {
+  ( retval ? std::cerr : std::cout ) <<
+"Usage: Accuracy [-n count] [-s seed] [-t name] [-h]\n\
+$Id$\n\
+\n\
+Check the accuracy of the principal calculations of GeographicLib, both\n\
+the single point and the batch versions, against reference results\n\
+computed with long doubles.  The references are\n\
+\n\
+    geodesics: the integrals for the distance and longitude (and for\n\
+        the reduced length and the geodesic scales) on the auxiliary\n\
+        sphere evaluated by Gauss-Legendre quadrature\n\
+    transverse Mercator: Krueger's series to 8th order in n (from\n\
+        tmseries.mac)\n\
+    geodesics and transverse Mercator on a sphere of radius a: great\n\
+        circles and the closed form expressions\n\
+    polar stereographic, geocentric, and local cartesian coordinates:\n\
+        the closed form expressions for the forward transformation\n\
+\n\
+The errors of the forward calculations are the distances between the\n\
+results and the reference results.  The errors of the reverse\n\
+calculations (and of the inverse geodesic problem) are the distances\n\
+between the inputs and the reference forward calculation (or direct\n\
+geodesic) applied to the results.\n\
+\n\
+Each calculation is checked for count (default 10000) points from each\n\
+of several distributions generated with a fixed pseudo-random sequence\n\
+starting with seed (default 1).  For each case, a line is printed giving\n\
+the name of the calculation, the distribution, the maximum and RMS errors\n\
+(nm), the error budget (nm), the mean time per operation (ns), and \"ok\"\n\
+or \"FAIL\" according to whether the maximum error is within the budget.\n\
+The exit status is 1 if any case fails.\n\
+\n\
+The Jacobians given by Geodesic::InverseJacobian and\n\
+TransverseMercator::ForwardJacobian are checked against the reference\n\
+calculations differentiated by central differences.  Their errors are\n\
+relative to the largest element in each row of the Jacobian and are given\n\
+in nm per m (i.e., parts per 10^9).  Geodesics longer than 19000 km (and\n\
+the antipodal distribution) are skipped because the derivatives of the\n\
+azimuths are ill-conditioned there.\n\
+\n\
+Geodesic::CrossTrack is checked with points found by going along a\n\
+geodesic and then at right angles to it; its error is the largest of the\n\
+errors in the along-track and cross-track distances and the foot.\n\
+\n\
+The errors of the checks of the reduced length m12 and the geodesic\n\
+scales M12 and M21 (scales) are the largest of the errors in m12 and in a\n\
+times M12 and M21.  Geodesic::Inverse with a tolerance (tol) uses tol = 1\n\
+um with point 2 moved 100 times closer to point 1; its budget is sqrt(2)\n\
+tol.  The (tol, bound) check compares its errors in s12 and in s12\n\
+times the azimuths with the full Inverse for lines up to 8 km long,\n\
+which straddle the longest that use the local approximation; its budget\n\
+is tol plus 20 nm.  The (sphere) checks use a sphere of radius a, for which there are\n\
+separate branches in the code.  Multilateration::Solve is checked with 4\n\
+stations at exact ranges, also with the stations nearly on a line (line)\n\
+so that the restart from the reflected starting point is used; its budget\n\
+is set by the tolerance for convergence.\n\
+\n\
+-t name only checks the calculations whose names contain name.\n\
+\n\
+-h prints this help.\n";
+  return retval;
+}
+
+typedef long double real;
+
+// WGS84 and the UTM and UPS scale factors as in Constants.hpp
+const real
+  pi = 3.141592653589793238462643383279502884L,
+  degree = pi / 180,
+  a = 6378137,
+  f = 1 / 298.257223563L,
+  e2 = f * (2 - f),
+  e = std::sqrt(e2),
+  b = a * (1 - f),
+  ep2 = e2 / ((1 - f) * (1 - f)),
+  n = f / (2 - f),
+  utmk0 = 0.9996L,
+  upsk0 = 0.994L;
+
+real sq(real x) { return x * x; }
+
+real hypot3(real x, real y, real z) {
+  return std::sqrt(x * x + y * y + z * z);
+}
+
+real AngNormalize(real x) {
+  return x >= 180 ? x - 360 : x < -180 ? x + 360 : x;
+}
+
+// A linear congruential generator (Knuth's MMIX constants) so that the
+// inputs don't depend on the C library.
+class Random {
+private:
+  unsigned long long _state;
+public:
+  explicit Random(unsigned long long seed)
+    : _state(seed * 2862933555777941757ULL + 3037000493ULL) {}
+  // A uniform deviate in [0, 1)
+  double Uniform() {
+    _state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return double(_state >> 11) / 9007199254740992.0;
+  }
+  // A uniform deviate in [a, b)
+  double Uniform(double a, double b) { return a + (b - a) * Uniform(); }
+};
+
+// Reference geodesic calculations.  The distance and longitude are given by
+// integrals over the arc length sigma on the auxiliary sphere (Bessel's
+// method, see \ref geoddesc)
+//
+//   s = b * int(sqrt(1 + k2 * sin(sigma)^2), sigma)
+//   lambda = omega - f * sin(alp0) *
+//            int((2 - f) / (1 + (1 - f) * sqrt(1 + k2 * sin(sigma)^2)), sigma)
+//
+// where k2 = ep2 * cos(alp0)^2.  The reduced length and the geodesic scales
+// are given in terms of
+//
+//   J = int(w - 1/w, sigma), w = sqrt(1 + k2 * sin(sigma)^2)
+//
+// (see RefGeodesic).  These are evaluated with 5-point Gauss-Legendre
+// quadrature on panels of width at most 0.05, which is accurate to
+// round-off.
+
+real DistIntegrand(real k2, real sig) {
+  return std::sqrt(1 + k2 * sq(std::sin(sig)));
+}
+
+real LongIntegrand(real k2, real sig) {
+  return (2 - f) / (1 + (1 - f) * std::sqrt(1 + k2 * sq(std::sin(sig))));
+}
+
+real JIntegrand(real k2, real sig) {
+  real w = std::sqrt(1 + k2 * sq(std::sin(sig)));
+  return w - 1 / w;
+}
+
+real Integral(real (*fun)(real, real), real k2, real sig1, real sig2) {
+  static const real
+    x[3] = { 0,
+	     std::sqrt(5 - 2 * std::sqrt(10/7.0L)) / 3,
+	     std::sqrt(5 + 2 * std::sqrt(10/7.0L)) / 3 },
+    w[3] = { 128/225.0L,
+	     (322 + 13 * std::sqrt(70.0L)) / 900,
+	     (322 - 13 * std::sqrt(70.0L)) / 900 };
+  int panels = std::max(1, int(std::ceil(std::abs(sig2 - sig1) / 0.05L)));
+  real h = (sig2 - sig1) / panels, sum = 0;
+  for (int p = 0; p < panels; ++p) {
+    real c = sig1 + (p + 0.5L) * h;
+    sum += w[0] * fun(k2, c);
+    for (int j = 1; j < 3; ++j)
+      sum += w[j] * (fun(k2, c - x[j] * h / 2) + fun(k2, c + x[j] * h / 2));
+  }
+  return sum * h / 2;
+}
+
+// The longitude omega on the auxiliary sphere, on the same branch as
+// sigma (or -sigma if sin(alp0) < 0).
+real Omega(real salp0, real sig) {
+  real
+    w = std::atan2(salp0 * std::sin(sig), std::cos(sig)),
+    t = salp0 < 0 ? -sig : sig;
+  return t + (w - t) - 2 * pi * std::floor((w - t) / (2 * pi) + 0.5L);
+}
+
+// The reference geodesic from point 1 with azimuth azi1 to point 2 at a
+// distance s12 (or, if arcp, at an arc length s12 in degrees on the
+// auxiliary sphere).  Return the position and azimuth at point 2, the
+// distance s, and, if scales is non-null, the reduced length and the
+// geodesic scales (see Geodesic::Inverse) in scales[0..2]:
+//
+//   m12 = b * (w2 * cos(sig1) * sin(sig2) - w1 * sin(sig1) * cos(sig2)
+//              - cos(sig1) * cos(sig2) * (J2 - J1))
+//   M12 = cos(sig12) + (k2 * (sin(sig2)^2 - sin(sig1)^2) * sin(sig2) /
+//                       (w1 + w2) - cos(sig2) * (J2 - J1)) * sin(sig1) / w1
+//   M21 = cos(sig12) - (k2 * (sin(sig2)^2 - sin(sig1)^2) * sin(sig1) /
+//                       (w1 + w2) - cos(sig1) * (J2 - J1)) * sin(sig2) / w2
+//
+// where sig12 = sig2 - sig1, w = sqrt(1 + k2 * sin(sig)^2), and J2 - J1 =
+// int(w - 1/w, sig, sig1, sig2).
+void RefGeodesic(real lat1, real lon1, real azi1, bool arcp, real s12,
+		 real& lat2, real& lon2, real& azi2, real& s,
+		 real scales[] = 0) {
+  real
+    phi1 = lat1 * degree, alp1 = azi1 * degree,
+    bet1 = std::atan2((1 - f) * std::sin(phi1), std::cos(phi1)),
+    salp0 = std::sin(alp1) * std::cos(bet1),
+    calp0 = std::sqrt(sq(std::cos(alp1)) +
+		      sq(std::sin(alp1) * std::sin(bet1))),
+    sig1 = std::atan2(std::sin(bet1), std::cos(alp1) * std::cos(bet1)),
+    k2 = ep2 * sq(calp0),
+    sig2 = sig1 + (arcp ? s12 * degree : s12 / b);
+  s = b * Integral(DistIntegrand, k2, sig1, sig2);
+  // Unless arcp, solve s(sig2) - s(sig1) = s12 for sig2 by Newton's method
+  for (int i = 0; !arcp && i < 20; ++i) {
+    real v = (s - s12) / (b * DistIntegrand(k2, sig2));
+    if (!(std::abs(v) > 0))
+      break;
+    s -= b * Integral(DistIntegrand, k2, sig2 - v, sig2);
+    sig2 -= v;
+    if (std::abs(v) < 1e-21L)
+      break;
+  }
+  real
+    bet2 = std::atan2(calp0 * std::sin(sig2),
+		      std::sqrt(sq(calp0 * std::cos(sig2)) + sq(salp0))),
+    lam12 = Omega(salp0, sig2) - Omega(salp0, sig1) -
+    f * salp0 * Integral(LongIntegrand, k2, sig1, sig2);
+  lat2 = std::atan2(std::sin(bet2), (1 - f) * std::cos(bet2)) / degree;
+  lon2 = lon1 + lam12 / degree;
+  lon2 = AngNormalize(lon2 - 360 * std::floor(lon2 / 360 + 0.5L));
+  azi2 = std::atan2(salp0, calp0 * std::cos(sig2)) / degree;
+  if (scales) {
+    real
+      ssig1 = std::sin(sig1), csig1 = std::cos(sig1),
+      ssig2 = std::sin(sig2), csig2 = std::cos(sig2),
+      w1 = DistIntegrand(k2, sig1), w2 = DistIntegrand(k2, sig2),
+      dJ = Integral(JIntegrand, k2, sig1, sig2),
+      t = k2 * (sq(ssig2) - sq(ssig1)) / (w1 + w2);
+    scales[0] = b * (w2 * csig1 * ssig2 - w1 * ssig1 * csig2 -
+		     csig1 * csig2 * dJ);
+    scales[1] = std::cos(sig2 - sig1) + (t * ssig2 - csig2 * dJ) * ssig1 / w1;
+    scales[2] = std::cos(sig2 - sig1) - (t * ssig1 - csig1 * dJ) * ssig2 / w2;
+  }
+}
+
+// The reference direct geodesic calculation.
+void RefDirect(real lat1, real lon1, real azi1, real s12,
+	       real& lat2, real& lon2, real& azi2) {
+  real s;
+  RefGeodesic(lat1, lon1, azi1, false, s12, lat2, lon2, azi2, s);
+}
+
+// The reference direct geodesic calculation on a sphere of radius a (on
+// which the geodesics are great circles) with the reduced length and the
+// geodesic scales in scales[0..2].
+void RefSphereDirect(real lat1, real lon1, real azi1, real s12,
+		     real& lat2, real& lon2, real& azi2, real scales[]) {
+  real
+    phi1 = lat1 * degree, alp1 = azi1 * degree,
+    salp0 = std::sin(alp1) * std::cos(phi1),
+    calp0 = std::sqrt(sq(std::cos(alp1)) +
+		      sq(std::sin(alp1) * std::sin(phi1))),
+    sig1 = std::atan2(std::sin(phi1), std::cos(alp1) * std::cos(phi1)),
+    sig12 = s12 / a,
+    sig2 = sig1 + sig12;
+  lat2 = std::atan2(calp0 * std::sin(sig2),
+		    std::sqrt(sq(calp0 * std::cos(sig2)) + sq(salp0))) / degree;
+  lon2 = lon1 + (Omega(salp0, sig2) - Omega(salp0, sig1)) / degree;
+  lon2 = AngNormalize(lon2 - 360 * std::floor(lon2 / 360 + 0.5L));
+  azi2 = std::atan2(salp0, calp0 * std::cos(sig2)) / degree;
+  scales[0] = a * std::sin(sig12);
+  scales[1] = scales[2] = std::cos(sig12);
+}
+
+// The distance (nm) between two nearby points given by their latitudes and
+// longitudes.
+real PointError(real lat, real lon, real rlat, real rlon) {
+  real dlon = lon - rlon;
+  dlon -= 360 * std::floor(dlon / 360 + 0.5L);
+  return a * std::sqrt(sq((lat - rlat) * degree) +
+		       sq(std::cos(rlat * degree) * dlon * degree)) * 1e9L;
+}
+
+// The error (nm) of the reduced length m12 and the geodesic scales M12 and
+// M21 relative to the reference scales[0..2].  The errors in the scales are
+// multiplied by a.
+real ScaleError(double m12, double M12, double M21, const real scales[]) {
+  return std::max(std::abs(m12 - scales[0]),
+		  a * std::max(std::abs(M12 - scales[1]),
+			       std::abs(M21 - scales[2]))) * 1e9L;
+}
+
+// The derivatives of (lat2, lon2, azi2) given by RefDirect with respect to
+// azi1 (if ha > 0) or s12 (if hs > 0) in d[0..2].  These are estimated by
+// central differences with steps ha (degrees) or hs (meters) and half these
+// steps combined by Richardson extrapolation.
+void RefDirectDiff(real lat1, real lon1, real azi1, real s12,
+		   real ha, real hs, real d[]) {
+  real x[4][3];
+  for (int k = 0; k < 4; ++k) {
+    real t = (k & 1 ? -1 : 1) * (k & 2 ? 0.5L : 1);
+    RefDirect(lat1, lon1, azi1 + t * ha, s12 + t * hs,
+	      x[k][0], x[k][1], x[k][2]);
+  }
+  for (int j = 0; j < 3; ++j) {
+    real d1 = x[0][j] - x[1][j], d2 = x[2][j] - x[3][j];
+    if (j) {
+      d1 = AngNormalize(d1);
+      d2 = AngNormalize(d2);
+    }
+    d[j] = (8 * d2 - d1) / (6 * (ha + hs));
+  }
+}
+
+// The derivatives of the distance and the azimuths of a geodesic with
+// respect to the position of its end point at latitude lat2, d[0..5] =
+// [ds12/dlat2, ds12/dlon2, dazi1/dlat2, dazi1/dlon2, dazi2/dlat2,
+// dazi2/dlon2].  These are found by inverting the Jacobian of RefDirect
+// with respect to azi1 and s12.  The steps move point 2 by at most 10 m and
+// by at most 1/1000 of its distance from the pole (where the latitude and
+// longitude change rapidly) and change azi1 by at most 0.001 radians; the
+// truncation errors are then below round-off.
+void RefEndJacobian(real lat1, real lon1, real azi1, real s12, real lat2,
+		    real d[]) {
+  real
+    hs = std::min(real(10), (90 - std::abs(lat2)) * degree * a / 1000),
+    ha = std::min(real(1e-3L), hs / std::min(s12, a)) / degree,
+    da[3], ds[3];
+  RefDirectDiff(lat1, lon1, azi1, s12, ha, 0, da);
+  RefDirectDiff(lat1, lon1, azi1, s12, 0, hs, ds);
+  real det = da[0] * ds[1] - ds[0] * da[1];
+  d[0] = -da[1] / det; d[1] =  da[0] / det;
+  d[2] =  ds[1] / det; d[3] = -ds[0] / det;
+  d[4] = da[2] * d[2] + ds[2] * d[0];
+  d[5] = da[2] * d[3] + ds[2] * d[1];
+}
+
+// The reference Jacobian of the inverse geodesic problem (see
+// Geodesic::InverseJacobian) given its solution.  The derivatives with
+// respect to point 1 are those of the reversed geodesic with respect to its
+// end point.
+void RefInverseJacobian(real lat1, real lon1, real lat2, real lon2,
+			real s12, real azi1, real azi2, real jac[]) {
+  real d[6];
+  RefEndJacobian(lat1, lon1, azi1, s12, lat2, d);
+  jac[2] = d[0]; jac[3] = d[1];
+  jac[6] = d[2]; jac[7] = d[3];
+  jac[10] = d[4]; jac[11] = d[5];
+  RefEndJacobian(lat2, lon2, azi2 + 180, s12, lat1, d);
+  jac[0] = d[0]; jac[1] = d[1];
+  jac[8] = d[2]; jac[9] = d[3];
+  jac[4] = d[4]; jac[5] = d[5];
+}
+
+// The error (nm per m) of the Jacobian jac with rows x cols elements
+// relative to the reference rjac: the maximum over the rows of the largest
+// error in a row divided by the largest element in the reference row.
+real JacobianError(int rows, int cols, const double jac[], const real rjac[]) {
+  real err = 0;
+  for (int i = 0; i < rows; ++i) {
+    real e = 0, m = 0;
+    for (int j = 0; j < cols; ++j) {
+      e = std::max(e, std::abs(jac[i * cols + j] - rjac[i * cols + j]));
+      m = std::max(m, std::abs(rjac[i * cols + j]));
+    }
+    err = std::max(err, e / m);
+  }
+  return err * 1e9L;
+}
+
+// The reference transverse Mercator projection: Krueger's series to 8th
+// order in n (the output of tmseries.mac with maxpow = 8, which are the
+// coefficients used by TransverseMercator with TM_TX_MAXPOW = 8) evaluated
+// in long double.  This is for points within 90 degrees of lon0.
+void RefTM(real lon0, real lat, real lon, real& x, real& y) {
+  static real b1, hp[8];
+  static bool init = false;
+  if (!init) {
+    b1 = 1/(1+n)*(sq(n)*(sq(n)*(sq(n)*(25*sq(n)+64)+256)+4096)+16384)/16384;
+    hp[0] = n*(n*(n*(n*(n*(n*((37884525-75900428*n)*n+42422016)-89611200)+
+			46287360)+63504000)-135475200)+101606400)/203212800;
+    hp[1] = sq(n)*(n*(n*(n*(n*(n*(148003883*n+83274912)-178508970)+
+			     77690880)+67374720)-104509440)+47174400)/174182400;
+    hp[2] = sq(n)*n*(n*(n*(n*(n*(318729724*n-738126169)+294981280)+
+			    178924680)-234938880)+81164160)/319334400;
+    hp[3] = sq(sq(n))*(n*(n*((14967552000.L-40176129013.L*n)*n+
+			     6971354016.L)-8165836800.L)+2355138720.L)/
+      7664025600.L;
+    hp[4] = sq(sq(n))*n*(n*(n*(10421654396.L*n+3997835751.L)-4266773472.L)+
+			 1072709352.L)/2490808320.L;
+    hp[5] = sq(sq(n))*sq(n)*(n*(175214326799.L*n-171950693600.L)+
+			     38652967262.L)/58118860800.L;
+    hp[6] = (13700311101.L-67039739596.L*n)*sq(sq(n))*sq(n)*n/12454041600.L;
+    hp[7] = 1424729850961.L*sq(sq(sq(n)))/743921418240.L;
+    init = true;
+  }
+  real
+    phi = lat * degree,
+    lam = AngNormalize(lon - lon0) * degree,
+    // The isometric latitude
+    q = std::log(std::tan(phi) + 1 / std::cos(phi)) -
+    e * std::log((1 + e * std::sin(phi)) / (1 - e * std::sin(phi))) / 2,
+    xip = std::atan2(std::sinh(q), std::cos(lam)),
+    s = std::sin(lam) / std::cosh(q),
+    etap = std::log((1 + s) / (1 - s)) / 2;
+  std::complex<real> zetap(xip, etap), zeta(zetap);
+  for (int j = 1; j <= 8; ++j)
+    zeta += hp[j - 1] * std::sin(real(2 * j) * zetap);
+  x = b1 * a * utmk0 * zeta.imag();
+  y = b1 * a * utmk0 * zeta.real();
+}
+
+// The reference transverse Mercator projection on a sphere of radius a
+// (Snyder (8-1) and (8-3)).
+void RefSphereTM(real lon0, real lat, real lon, real& x, real& y) {
+  real
+    phi = lat * degree,
+    lam = AngNormalize(lon - lon0) * degree,
+    s = std::cos(phi) * std::sin(lam);
+  x = a * utmk0 * std::log((1 + s) / (1 - s)) / 2;
+  y = a * utmk0 * std::atan2(std::sin(phi), std::cos(phi) * std::cos(lam));
+}
+
+// The reference polar stereographic projection (Snyder (21-33)).
+void RefPS(bool northp, real lat, real lon, real& x, real& y) {
+  real
+    theta = (90 - (northp ? lat : -lat)) * degree,
+    ecos = e * std::cos(theta),
+    t = std::tan(theta / 2) * std::pow((1 + ecos) / (1 - ecos), e / 2),
+    rho = 2 * a * upsk0 * t /
+    std::sqrt(std::pow(1 + e, 1 + e) * std::pow(1 - e, 1 - e)),
+    lam = lon * degree;
+  x = rho * std::sin(lam);
+  y = (northp ? -rho : rho) * std::cos(lam);
+}
+
+// The reference geocentric coordinates.
+void RefGeocentric(real lat, real lon, real h, real& x, real& y, real& z) {
+  real
+    phi = lat * degree, lam = lon * degree,
+    nu = a / std::sqrt(1 - e2 * sq(std::sin(phi)));
+  x = (nu + h) * std::cos(phi) * std::cos(lam);
+  y = (nu + h) * std::cos(phi) * std::sin(lam);
+  z = (nu * (1 - e2) + h) * std::sin(phi);
+}
+
+// The reference local cartesian coordinates for the origin lat0, lon0, h0.
+void RefLocal(real lat0, real lon0, real h0,
+	      real lat, real lon, real h, real& x, real& y, real& z) {
+  real x0, y0, z0, xc, yc, zc;
+  RefGeocentric(lat0, lon0, h0, x0, y0, z0);
+  RefGeocentric(lat, lon, h, xc, yc, zc);
+  xc -= x0; yc -= y0; zc -= z0;
+  real
+    sphi = std::sin(lat0 * degree), cphi = std::cos(lat0 * degree),
+    slam = std::sin(lon0 * degree), clam = std::cos(lon0 * degree);
+  x = -slam * xc + clam * yc;
+  y = -clam * sphi * xc - slam * sphi * yc + cphi * zc;
+  z = clam * cphi * xc + slam * cphi * yc + sphi * zc;
+}
+
+double Now() {
+#if defined(_WIN32)
+  LARGE_INTEGER t, f;
+  QueryPerformanceCounter(&t);
+  QueryPerformanceFrequency(&f);
+  return double(t.QuadPart) / double(f.QuadPart);
+#else
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return double(t.tv_sec) + 1e-9 * double(t.tv_nsec);
+#endif
+}
+
+// The points for one distribution.
+struct Points {
+  std::string dist;
+  int n;
+  std::vector<double> lat1, lon1, azi1, lat2, lon2, s12, h, lon0;
+};
+
+enum { GLOBAL, ANTIPODAL, POLAR, UTM, WIDE, NDIST };
+const char* const distnames[NDIST] =
+  {"global", "antipodal", "polar", "utm", "wide"};
+
+// Fill p with n points of distribution dist (see Benchmark.cpp).  wide is
+// the same as utm except that the points lie within 35d of the central
+// meridian.  Points within 0.001d of the poles are avoided because the
+// reference geodesic calculation loses accuracy there.
+void Generate(int dist, int count, unsigned long long seed, Points& p) {
+  Random r(seed * NDIST + dist);
+  p.dist = distnames[dist];
+  p.n = count;
+  p.lat1.resize(count); p.lon1.resize(count); p.azi1.resize(count);
+  p.lat2.resize(count); p.lon2.resize(count); p.s12.resize(count);
+  p.h.resize(count); p.lon0.resize(count);
+  for (int i = 0; i < count; ++i) {
+    double lat1, lon1 = r.Uniform(-180, 180), lat2, lon2, s12,
+      lon0 = 6 * std::floor(lon1 / 6) + 3;
+    switch (dist) {
+    case GLOBAL:
+    case ANTIPODAL:
+      lat1 = std::asin(r.Uniform(-1, 1)) / double(degree);
+      break;
+    case POLAR:
+      lat1 = (r.Uniform() < 0.5 ? -1 : 1) * (89.999 - r.Uniform(0, 10));
+      break;
+    default:
+      lat1 = r.Uniform(-80, 84);
+      break;
+    }
+    switch (dist) {
+    case GLOBAL:
+      lat2 = std::asin(r.Uniform(-1, 1)) / double(degree);
+      lon2 = r.Uniform(-180, 180);
+      s12 = r.Uniform(0, 20e6);
+      break;
+    case ANTIPODAL:
+      lat2 = std::max(-89.999, std::min(89.999,
+					-lat1 + r.Uniform(-0.5, 0.5)));
+      lon2 = double(AngNormalize(lon1 + 180 + r.Uniform(-0.5, 0.5)));
+      s12 = r.Uniform(19.9e6, 20.0e6);
+      break;
+    case POLAR:
+      lat2 = (r.Uniform() < 0.5 ? -1 : 1) * (89.999 - r.Uniform(0, 10));
+      lon2 = r.Uniform(-180, 180);
+      s12 = r.Uniform(0, 2e6);
+      break;
+    default:
+      lat2 = lat1 + r.Uniform(-0.5, 0.5);
+      lon2 = double(AngNormalize(lon1 + r.Uniform(-0.5, 0.5)));
+      s12 = r.Uniform(0, 100e3);
+      break;
+    }
+    if (dist == WIDE) {
+      // Longitude within 35d of the central meridian
+      lon0 = 0;
+      lon1 = r.Uniform(-35, 35);
+    }
+    p.lat1[i] = lat1; p.lon1[i] = lon1; p.azi1[i] = r.Uniform(-180, 180);
+    p.lat2[i] = lat2; p.lon2[i] = lon2; p.s12[i] = s12;
+    p.h[i] = r.Uniform(-100, 9000);
+    p.lon0[i] = lon0;
+  }
+}
+
+// Accumulate the errors and timing for one case and report them.  Return
+// false if the budget is exceeded.
+class Check {
+private:
+  std::string _name, _dist;
+  double _budget, _start, _time;
+  real _max, _sum;
+  int _n, _ops;
+public:
+  Check(const std::string& name, const std::string& dist, double budget)
+    : _name(name), _dist(dist), _budget(budget), _start(0), _time(0)
+    , _max(0), _sum(0), _n(0), _ops(0) {}
+  // Bracket the timed calculations with Start and Stop(ops).
+  void Start() { _start = Now(); }
+  void Stop(int ops) { _time += Now() - _start; _ops += ops; }
+  void Add(real err) {
+    // A NaN counts as a large error
+    if (!(err <= _max))
+      _max = err == err ? err : std::numeric_limits<real>::infinity();
+    _sum += sq(err);
+    ++_n;
+  }
+  bool Report() const {
+    bool ok = _max <= _budget;
+    char line[256];
+    sprintf(line, "%-36s %-9s %10.3f %10.3f %7.1f %9.1f  %s\n",
+	    _name.c_str(), _dist.c_str(), double(_max),
+	    double(_n ? std::sqrt(_sum / _n) : 0), _budget,
+	    _ops ? _time * 1e9 / _ops : 0.0, ok ? "ok" : "FAIL");
+    std::cout << line << std::flush;
+    return ok;
+  }
+};
+
+// Error budgets in nm (from the documentation of the classes)
+const double
+  geodbudget = 12,              // Geodesic
+  crossbudget = 20,             // Geodesic::CrossTrack (Position + Inverse)
+  tolbudget = 1500,             // Geodesic::Inverse with tol = 1 um
+  boundbudget = 1020,           // The same compared with the full Inverse
+  scalebudget = 20,             // m12, a * M12, and a * M21 (not documented)
+  mlbudget = 2000,              // Multilateration (step below 1000 eps a)
+  tmbudget = 5,                 // TransverseMercator within 35d of lon0
+  tmebudget = 9,                // TransverseMercatorExact ("about 8 nm")
+  psbudget = 5,                 // PolarStereographic
+  geocbudget = 7,               // Geocentric within 5000 km of the surface
+  localbudget = 7,              // LocalCartesian
+  jacbudget = 1;                // Jacobians (nm per m)
+
+// Check the geodesic calculations.  Return the number of failures.
+int Geodesics(const Points& p, const std::string& filter) {
+  using namespace GeographicLib;
+  const Geodesic& g = Geodesic::WGS84;
+  const int m = p.n;
+  std::vector<double> lat2(m), lon2(m), azi2(m), s12(m), azi1(m);
+  std::vector<GeodesicLine> lines(m);
+  int fail = 0;
+  std::vector<real> rlat2(m), rlon2(m), razi2(m);
+  for (int i = 0; i < m; ++i)
+    RefDirect(p.lat1[i], p.lon1[i], p.azi1[i], p.s12[i],
+	      rlat2[i], rlon2[i], razi2[i]);
+  if (std::string("Geodesic::Direct").find(filter) != std::string::npos) {
+    Check c("Geodesic::Direct", p.dist, geodbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.Direct(p.lat1[i], p.lon1[i], p.azi1[i], p.s12[i],
+	       lat2[i], lon2[i], azi2[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i)
+      c.Add(PointError(lat2[i], lon2[i], rlat2[i], rlon2[i]));
+    fail += !c.Report();
+    Check cb("Geodesic::Direct (batch)", p.dist, geodbudget);
+    cb.Start();
+    g.Direct(m, &p.lat1[0], &p.lon1[0], &p.azi1[0], &p.s12[0],
+	     &lat2[0], &lon2[0], &azi2[0]);
+    cb.Stop(m);
+    for (int i = 0; i < m; ++i)
+      cb.Add(PointError(lat2[i], lon2[i], rlat2[i], rlon2[i]));
+    fail += !cb.Report();
+  }
+  if (std::string("Geodesic::DirectFan").find(filter) != std::string::npos) {
+    // All the geodesics start at the first point.
+    Check c("Geodesic::DirectFan", p.dist, geodbudget);
+    c.Start();
+    g.DirectFan(p.lat1[0], p.lon1[0], m, &p.azi1[0], &p.s12[0],
+		&lat2[0], &lon2[0], &azi2[0]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi;
+      RefDirect(p.lat1[0], p.lon1[0], p.azi1[i], p.s12[i], lat, lon, azi);
+      c.Add(PointError(lat2[i], lon2[i], lat, lon));
+    }
+    fail += !c.Report();
+  }
+  if (std::string("Geodesic::Direct (scales)").find(filter) !=
+      std::string::npos) {
+    // The error is the largest of the errors in the position and the
+    // scales.
+    std::vector<double> m12(m), M12(m), M21(m);
+    Check c("Geodesic::Direct (scales)", p.dist, scalebudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.Direct(p.lat1[i], p.lon1[i], p.azi1[i], p.s12[i],
+	       lat2[i], lon2[i], azi2[i], m12[i], M12[i], M21[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi, s, scales[3];
+      RefGeodesic(p.lat1[i], p.lon1[i], p.azi1[i], false, p.s12[i],
+		  lat, lon, azi, s, scales);
+      c.Add(std::max(PointError(lat2[i], lon2[i], lat, lon),
+		     ScaleError(m12[i], M12[i], M21[i], scales)));
+    }
+    fail += !c.Report();
+  }
+  if (std::string("GeodesicLine::Position").find(filter) !=
+      std::string::npos) {
+    for (int i = 0; i < m; ++i)
+      lines[i] = g.Line(p.lat1[i], p.lon1[i], p.azi1[i]);
+    Check c("GeodesicLine::Position", p.dist, geodbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      lines[i].Position(p.s12[i], lat2[i], lon2[i], azi2[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i)
+      c.Add(PointError(lat2[i], lon2[i], rlat2[i], rlon2[i]));
+    fail += !c.Report();
+    // The batch version uses a single line.
+    Check cb("GeodesicLine::Position (batch)", p.dist, geodbudget);
+    cb.Start();
+    lines[0].Position(m, &p.s12[0], &lat2[0], &lon2[0], &azi2[0]);
+    cb.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi;
+      RefDirect(p.lat1[0], p.lon1[0], p.azi1[0], p.s12[i], lat, lon, azi);
+      cb.Add(PointError(lat2[i], lon2[i], lat, lon));
+    }
+    fail += !cb.Report();
+  }
+  if (std::string("GeodesicLine::ArcPosition").find(filter) !=
+      std::string::npos) {
+    // The arc lengths correspond to distances of about s12.  The error is
+    // the largest of the errors in the position and the distance.
+    std::vector<double> a12(m);
+    for (int i = 0; i < m; ++i) {
+      a12[i] = double(p.s12[i] / b / degree);
+      lines[i] = g.Line(p.lat1[i], p.lon1[i], p.azi1[i]);
+    }
+    Check c("GeodesicLine::ArcPosition", p.dist, geodbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      lines[i].ArcPosition(a12[i], lat2[i], lon2[i], azi2[i], s12[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi, s;
+      RefGeodesic(p.lat1[i], p.lon1[i], p.azi1[i], true, a12[i],
+		  lat, lon, azi, s);
+      c.Add(std::max(PointError(lat2[i], lon2[i], lat, lon),
+		     std::abs(s12[i] - s) * 1e9L));
+    }
+    fail += !c.Report();
+    Check cb("GeodesicLine::ArcPosition (batch)", p.dist, geodbudget);
+    cb.Start();
+    lines[0].ArcPosition(m, &a12[0], &lat2[0], &lon2[0], &azi2[0], &s12[0]);
+    cb.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi, s;
+      RefGeodesic(p.lat1[0], p.lon1[0], p.azi1[0], true, a12[i],
+		  lat, lon, azi, s);
+      cb.Add(std::max(PointError(lat2[i], lon2[i], lat, lon),
+		      std::abs(s12[i] - s) * 1e9L));
+    }
+    fail += !cb.Report();
+  }
+  if (std::string("Geodesic::Inverse").find(filter) != std::string::npos) {
+    // The error is the distance between point 2 and the end of the
+    // reference geodesic with the computed azi1 and s12.
+    Check c("Geodesic::Inverse", p.dist, geodbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.Inverse(p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i],
+		s12[i], azi1[i], azi2[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi;
+      RefDirect(p.lat1[i], p.lon1[i], azi1[i], s12[i], lat, lon, azi);
+      c.Add(PointError(p.lat2[i], p.lon2[i], lat, lon));
+    }
+    fail += !c.Report();
+    Check cb("Geodesic::Inverse (batch)", p.dist, geodbudget);
+    cb.Start();
+    g.Inverse(m, &p.lat1[0], &p.lon1[0], &p.lat2[0], &p.lon2[0],
+	      &s12[0], &azi1[0], &azi2[0]);
+    cb.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi;
+      RefDirect(p.lat1[i], p.lon1[i], azi1[i], s12[i], lat, lon, azi);
+      cb.Add(PointError(p.lat2[i], p.lon2[i], lat, lon));
+    }
+    fail += !cb.Report();
+  }
+  if (std::string("Geodesic::Inverse (tol)").find(filter) !=
+      std::string::npos) {
+    // Point 2 is moved 100 times closer to point 1 so that the shorter
+    // lines use the local approximation.  The errors in s12 and in s12
+    // times the azimuths are within tol, so the error at point 2 is within
+    // sqrt(2) tol.
+    const double tol = 1e-6;
+    std::vector<double> lat(m), lon(m);
+    for (int i = 0; i < m; ++i) {
+      lat[i] = p.lat1[i] + (p.lat2[i] - p.lat1[i]) / 100;
+      lon[i] = double(AngNormalize(p.lon1[i] +
+				   AngNormalize(p.lon2[i] - p.lon1[i]) / 100));
+    }
+    for (int batch = 0; batch < 2; ++batch) {
+      Check c(batch ? "Geodesic::Inverse (tol, batch)" :
+	      "Geodesic::Inverse (tol)", p.dist, tolbudget);
+      c.Start();
+      if (batch)
+	g.Inverse(m, &p.lat1[0], &p.lon1[0], &lat[0], &lon[0], tol,
+		  &s12[0], &azi1[0], &azi2[0]);
+      else
+	for (int i = 0; i < m; ++i)
+	  g.Inverse(p.lat1[i], p.lon1[i], lat[i], lon[i], tol,
+		    s12[i], azi1[i], azi2[i]);
+      c.Stop(m);
+      for (int i = 0; i < m; ++i) {
+	real rlat, rlon, azi;
+	RefDirect(p.lat1[i], p.lon1[i], azi1[i], s12[i], rlat, rlon, azi);
+	c.Add(PointError(lat[i], lon[i], rlat, rlon));
+      }
+      fail += !c.Report();
+    }
+  }
+  if (std::string("Geodesic::Inverse (tol, bound)").find(filter) !=
+      std::string::npos) {
+    // Lines up to 8 km long straddle the largest for which the local
+    // approximation is used with tol = 1 um; the bound on its errors in s12
+    // and in s12 times the azimuths is checked against the full Inverse.
+    const double tol = 1e-6;
+    std::vector<double> lat(m), lon(m), s12f(m), azi1f(m), azi2f(m);
+    for (int i = 0; i < m; ++i) {
+      double azi;
+      g.Direct(p.lat1[i], p.lon1[i], p.azi1[i], 8e3 * (i + 0.5) / m,
+	       lat[i], lon[i], azi);
+    }
+    Check c("Geodesic::Inverse (tol, bound)", p.dist, boundbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.Inverse(p.lat1[i], p.lon1[i], lat[i], lon[i], tol,
+		s12[i], azi1[i], azi2[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      g.Inverse(p.lat1[i], p.lon1[i], lat[i], lon[i],
+		s12f[i], azi1f[i], azi2f[i]);
+      real
+	da1 = AngNormalize(real(azi1[i]) - azi1f[i]) * degree,
+	da2 = AngNormalize(real(azi2[i]) - azi2f[i]) * degree;
+      c.Add(1e9L * std::max(std::abs(real(s12[i]) - s12f[i]),
+			    s12f[i] * std::max(std::abs(da1),
+					       std::abs(da2))));
+    }
+    fail += !c.Report();
+  }
+  if (std::string("Geodesic::Inverse (scales)").find(filter) !=
+      std::string::npos) {
+    // The scales are compared with those of the reference geodesic with the
+    // computed azi1 and s12 (whose error is checked by Inverse).
+    std::vector<double> m12(m), M12(m), M21(m);
+    Check c("Geodesic::Inverse (scales)", p.dist, scalebudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.Inverse(p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i],
+		s12[i], azi1[i], azi2[i], m12[i], M12[i], M21[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi, s, scales[3];
+      RefGeodesic(p.lat1[i], p.lon1[i], azi1[i], false, s12[i],
+		  lat, lon, azi, s, scales);
+      c.Add(ScaleError(m12[i], M12[i], M21[i], scales));
+    }
+    fail += !c.Report();
+  }
+  if (std::string("Geodesic::CrossTrack").find(filter) !=
+      std::string::npos) {
+    // The point is constructed by going a distance along the line and then
+    // a distance at right angles to it, so that the foot and the along-track
+    // and cross-track distances are known.  The error is the largest of the
+    // errors in these.
+    std::vector<double> lat(m), lon(m), s(m), xtrack(m);
+    std::vector<real> along(m), cross(m), rlat(m), rlon(m);
+    for (int i = 0; i < m; ++i) {
+      lines[i] = g.Line(p.lat1[i], p.lon1[i], p.azi1[i]);
+      along[i] = p.s12[i] / 2;
+      cross[i] = (i % 2 ? 1 : -1) * p.s12[(i + 1) % m] / 4;
+      real azi, plat, plon;
+      RefDirect(p.lat1[i], p.lon1[i], p.azi1[i], along[i],
+		rlat[i], rlon[i], azi);
+      RefDirect(rlat[i], rlon[i], azi + 90, cross[i], plat, plon, azi);
+      lat[i] = double(plat); lon[i] = double(plon);
+    }
+    Check c("Geodesic::CrossTrack", p.dist, crossbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.CrossTrack(lines[i], lat[i], lon[i], s[i], xtrack[i],
+		   lat2[i], lon2[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i)
+      c.Add(std::max(std::max(std::abs(s[i] - along[i]),
+			      std::abs(xtrack[i] - cross[i])) * 1e9L,
+		     PointError(lat2[i], lon2[i], rlat[i], rlon[i])));
+    fail += !c.Report();
+  }
+  // The derivatives of the azimuths are ill-conditioned for nearly antipodal
+  // points and the reference loses accuracy, so these are skipped.
+  if (std::string("Geodesic::InverseJacobian").find(filter) !=
+      std::string::npos && p.dist != "antipodal") {
+    std::vector<double> jac(12 * m);
+    Check c("Geodesic::InverseJacobian", p.dist, jacbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.InverseJacobian(p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i],
+			s12[i], azi1[i], azi2[i], &jac[12 * i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      if (s12[i] > 19e6)
+	continue;
+      real rjac[12];
+      RefInverseJacobian(p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i],
+			 s12[i], azi1[i], azi2[i], rjac);
+      c.Add(JacobianError(3, 4, &jac[12 * i], rjac));
+    }
+    fail += !c.Report();
+  }
+  return fail;
+}
+
+// Check the geodesic calculations on a sphere of radius a (which Geodesic
+// treats separately) against great circles.  Return the number of failures.
+int SphereGeodesics(const Points& p, const std::string& filter) {
+  const GeographicLib::Geodesic g(double(a), 0);
+  const int m = p.n;
+  std::vector<double> lat2(m), lon2(m), azi2(m), s12(m), azi1(m),
+    m12(m), M12(m), M21(m);
+  int fail = 0;
+  if (std::string("Geodesic::Direct (sphere)").find(filter) !=
+      std::string::npos) {
+    Check c("Geodesic::Direct (sphere)", p.dist, geodbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.Direct(p.lat1[i], p.lon1[i], p.azi1[i], p.s12[i],
+	       lat2[i], lon2[i], azi2[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi, scales[3];
+      RefSphereDirect(p.lat1[i], p.lon1[i], p.azi1[i], p.s12[i],
+		      lat, lon, azi, scales);
+      c.Add(PointError(lat2[i], lon2[i], lat, lon));
+    }
+    fail += !c.Report();
+  }
+  if (std::string("Geodesic::DirectFan (sphere)").find(filter) !=
+      std::string::npos) {
+    Check c("Geodesic::DirectFan (sphere)", p.dist, geodbudget);
+    c.Start();
+    g.DirectFan(p.lat1[0], p.lon1[0], m, &p.azi1[0], &p.s12[0],
+		&lat2[0], &lon2[0], &azi2[0]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi, scales[3];
+      RefSphereDirect(p.lat1[0], p.lon1[0], p.azi1[i], p.s12[i],
+		      lat, lon, azi, scales);
+      c.Add(PointError(lat2[i], lon2[i], lat, lon));
+    }
+    fail += !c.Report();
+  }
+  if (std::string("Geodesic::Inverse (sphere)").find(filter) !=
+      std::string::npos) {
+    // The error is the largest of the errors at point 2 and in the scales.
+    Check c("Geodesic::Inverse (sphere)", p.dist, geodbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      g.Inverse(p.lat1[i], p.lon1[i], p.lat2[i], p.lon2[i],
+		s12[i], azi1[i], azi2[i], m12[i], M12[i], M21[i]);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real lat, lon, azi, scales[3];
+      RefSphereDirect(p.lat1[i], p.lon1[i], azi1[i], s12[i],
+		      lat, lon, azi, scales);
+      c.Add(std::max(PointError(p.lat2[i], p.lon2[i], lat, lon),
+		     ScaleError(m12[i], M12[i], M21[i], scales)));
+    }
+    fail += !c.Report();
+  }
+  return fail;
+}
+
+// Check Multilateration::Solve.  Each point has 4 stations with exact
+// ranges.  In the first case, these are at azimuths 90d apart and at
+// distances between 1 km and 1 km + the maximum s12 of the distribution.
+// In the second (line) case, they are spaced by d = 1 km + s12 along a
+// zigzag line at distances of d/8 and 1.05 d/8 from the point.  These lie
+// nearly on a geodesic, so the reflection of the point in it nearly fits
+// the ranges too; for some of the points, Solve ends at this reflection
+// and has to restart from the other starting point.  The error is the
+// distance from the point to the solution (infinite if Solve fails).
+// Return the number of failures.
+int Multilat(const Points& p, const std::string& filter) {
+  using namespace GeographicLib;
+  const Multilateration ml;
+  const int m = p.n, k = 4;
+  std::vector<double> lats(k * m), lons(k * m), ranges(k * m),
+    lat(m), lon(m), cov(3);
+  std::vector<int> start(m + 1), iter(m);
+  int fail = 0;
+  for (int collinear = 0; collinear < 2; ++collinear) {
+    std::string name = collinear ? "Multilateration::Solve (line)" :
+      "Multilateration::Solve";
+    if (name.find(filter) == std::string::npos)
+      continue;
+    for (int i = 0; i < m; ++i) {
+      start[i] = k * i;
+      for (int j = 0; j < k; ++j) {
+	real s, azi, lat2, lon2, azi2;
+	if (collinear) {
+	  real
+	    d = 1000 + p.s12[i],
+	    x = (j % 2 ? 1.05L : 1) * d / 8,
+	    y = (j - 1.5L) * d;
+	  s = std::sqrt(x * x + y * y);
+	  azi = p.azi1[i] + std::atan2(y, x) / degree;
+	} else {
+	  s = 1000 + p.s12[(i + j) % m];
+	  azi = p.azi1[i] + 90 * j;
+	}
+	RefDirect(p.lat1[i], p.lon1[i], azi, s, lat2, lon2, azi2);
+	lats[k * i + j] = double(lat2);
+	lons[k * i + j] = double(lon2);
+	ranges[k * i + j] = double(s);
+      }
+    }
+    start[m] = k * m;
+    for (int batch = 0; batch < 2; ++batch) {
+      Check c(batch ? (collinear ? "Multilateration::Solve (line, batch)" :
+		       "Multilateration::Solve (batch)") : name,
+	      p.dist, mlbudget);
+      c.Start();
+      if (batch)
+	ml.Solve(m, &start[0], &lats[0], &lons[0], &ranges[0], 0,
+		 &lat[0], &lon[0], 0, 0, &iter[0]);
+      else
+	for (int i = 0; i < m; ++i) {
+	  double chi2;
+	  iter[i] = ml.Solve(k, &lats[k * i], &lons[k * i], &ranges[k * i], 0,
+			     lat[i], lon[i], &cov[0], chi2);
+	}
+      c.Stop(m);
+      for (int i = 0; i < m; ++i)
+	c.Add(iter[i] < 0 ? std::numeric_limits<real>::infinity() :
+	      PointError(lat[i], lon[i], p.lat1[i], p.lon1[i]));
+      fail += !c.Report();
+    }
+  }
+  return fail;
+}
+
+// Check the forward and reverse transverse Mercator projection tm against
+// the reference function ref (RefTM or RefSphereTM); suffix is appended to
+// the names of the checks.  Return the number of failures.
+template<class TM> int Projection(const TM& tm,
+				  void (*ref)(real, real, real, real&, real&),
+				  const std::string& name,
+				  const std::string& suffix,
+				  double budget, const Points& p,
+				  const std::string& filter) {
+  const int m = p.n;
+  int fail = 0;
+  std::vector<double> x(m), y(m), lat(m), lon(m);
+  double gamma, k;
+  std::vector<real> rx(m), ry(m);
+  for (int i = 0; i < m; ++i)
+    ref(p.lon0[i], p.lat1[i], p.lon1[i], rx[i], ry[i]);
+  if ((name + "::Forward" + suffix).find(filter) != std::string::npos) {
+    Check c(name + "::Forward" + suffix, p.dist, budget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      tm.Forward(p.lon0[i], p.lat1[i], p.lon1[i], x[i], y[i], gamma, k);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i)
+      c.Add(std::sqrt(sq(x[i] - rx[i]) + sq(y[i] - ry[i])) * 1e9L);
+    fail += !c.Report();
+  }
+  if ((name + "::Reverse" + suffix).find(filter) != std::string::npos) {
+    // Start with the reference projection rounded to doubles.
+    for (int i = 0; i < m; ++i) {
+      x[i] = double(rx[i]);
+      y[i] = double(ry[i]);
+    }
+    Check c(name + "::Reverse" + suffix, p.dist, budget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      tm.Reverse(p.lon0[i], x[i], y[i], lat[i], lon[i], gamma, k);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real xx, yy;
+      ref(p.lon0[i], lat[i], lon[i], xx, yy);
+      c.Add(std::sqrt(sq(xx - x[i]) + sq(yy - y[i])) * 1e9L);
+    }
+    fail += !c.Report();
+  }
+  return fail;
+}
+
+// Check TransverseMercator::ForwardJacobian against the reference projection
+// differentiated by central differences.  Return the number of failures.
+int TMJacobian(const Points& p, const std::string& filter) {
+  const GeographicLib::TransverseMercator& tm =
+    GeographicLib::TransverseMercator::UTM;
+  if (std::string("TransverseMercator::ForwardJacobian").find(filter) ==
+      std::string::npos)
+    return 0;
+  const int m = p.n;
+  std::vector<double> x(m), y(m), jac(4 * m);
+  double gamma, k;
+  Check c("TransverseMercator::ForwardJacobian", p.dist, jacbudget);
+  c.Start();
+  for (int i = 0; i < m; ++i)
+    tm.ForwardJacobian(p.lon0[i], p.lat1[i], p.lon1[i], x[i], y[i],
+		       gamma, k, &jac[4 * i]);
+  c.Stop(m);
+  const real h = 1e-5L;
+  for (int i = 0; i < m; ++i) {
+    real xp, yp, xm, ym, rjac[4];
+    RefTM(p.lon0[i], p.lat1[i] + h, p.lon1[i], xp, yp);
+    RefTM(p.lon0[i], p.lat1[i] - h, p.lon1[i], xm, ym);
+    rjac[0] = (xp - xm) / (2 * h); rjac[2] = (yp - ym) / (2 * h);
+    RefTM(p.lon0[i], p.lat1[i], p.lon1[i] + h, xp, yp);
+    RefTM(p.lon0[i], p.lat1[i], p.lon1[i] - h, xm, ym);
+    rjac[1] = (xp - xm) / (2 * h); rjac[3] = (yp - ym) / (2 * h);
+    // Treat the 2 x 2 Jacobian as one row since its elements all scale
+    // with k
+    c.Add(JacobianError(1, 4, &jac[4 * i], rjac));
+  }
+  return c.Report() ? 0 : 1;
+}
+
+// Check the polar stereographic projection.  Return the number of failures.
+int Polar(const Points& p, const std::string& filter) {
+  const GeographicLib::PolarStereographic& ps =
+    GeographicLib::PolarStereographic::UPS;
+  const int m = p.n;
+  int fail = 0;
+  std::vector<double> x(m), y(m), lat(m), lon(m);
+  double gamma, k;
+  std::vector<real> rx(m), ry(m);
+  for (int i = 0; i < m; ++i)
+    RefPS(p.lat1[i] > 0, p.lat1[i], p.lon1[i], rx[i], ry[i]);
+  if (std::string("PolarStereographic::Forward").find(filter) !=
+      std::string::npos) {
+    Check c("PolarStereographic::Forward", p.dist, psbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      ps.Forward(p.lat1[i] > 0, p.lat1[i], p.lon1[i], x[i], y[i], gamma, k);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i)
+      c.Add(std::sqrt(sq(x[i] - rx[i]) + sq(y[i] - ry[i])) * 1e9L);
+    fail += !c.Report();
+  }
+  if (std::string("PolarStereographic::Reverse").find(filter) !=
+      std::string::npos) {
+    for (int i = 0; i < m; ++i) {
+      x[i] = double(rx[i]);
+      y[i] = double(ry[i]);
+    }
+    Check c("PolarStereographic::Reverse", p.dist, psbudget);
+    c.Start();
+    for (int i = 0; i < m; ++i)
+      ps.Reverse(p.lat1[i] > 0, x[i], y[i], lat[i], lon[i], gamma, k);
+    c.Stop(m);
+    for (int i = 0; i < m; ++i) {
+      real xx, yy;
+      RefPS(p.lat1[i] > 0, lat[i], lon[i], xx, yy);
+      c.Add(std::sqrt(sq(xx - x[i]) + sq(yy - y[i])) * 1e9L);
+    }
+    fail += !c.Report();
+  }
+  return fail;
+}
+
+// Check the single point and batch versions of the forward and reverse
+// conversions of conv (Geocentric or LocalCartesian) against the reference
+// function ref.  Return the number of failures.
+template<class Conv, class Ref>
+int Cartesian(const Conv& conv, const Ref& ref, const std::string& name,
+	      double budget, const Points& p, const std::string& filter) {
+  const int m = p.n;
+  int fail = 0;
+  std::vector<double> x(m), y(m), z(m), lat(m), lon(m), h(m);
+  std::vector<real> rx(m), ry(m), rz(m);
+  for (int i = 0; i < m; ++i)
+    ref(p.lat1[i], p.lon1[i], p.h[i], rx[i], ry[i], rz[i]);
+  for (int batch = 0; batch < 2; ++batch) {
+    std::string suffix = batch ? " (batch)" : "";
+    if ((name + "::Forward" + suffix).find(filter) != std::string::npos) {
+      Check c(name + "::Forward" + suffix, p.dist, budget);
+      c.Start();
+      if (batch)
+	conv.Forward(m, &p.lat1[0], &p.lon1[0], &p.h[0], &x[0], &y[0], &z[0]);
+      else
+	for (int i = 0; i < m; ++i)
+	  conv.Forward(p.lat1[i], p.lon1[i], p.h[i], x[i], y[i], z[i]);
+      c.Stop(m);
+      for (int i = 0; i < m; ++i)
+	c.Add(hypot3(x[i] - rx[i], y[i] - ry[i], z[i] - rz[i]) * 1e9L);
+      fail += !c.Report();
+    }
+    if ((name + "::Reverse" + suffix).find(filter) != std::string::npos) {
+      for (int i = 0; i < m; ++i) {
+	x[i] = double(rx[i]);
+	y[i] = double(ry[i]);
+	z[i] = double(rz[i]);
+      }
+      Check c(name + "::Reverse" + suffix, p.dist, budget);
+      c.Start();
+      if (batch)
+	conv.Reverse(m, &x[0], &y[0], &z[0], &lat[0], &lon[0], &h[0]);
+      else
+	for (int i = 0; i < m; ++i)
+	  conv.Reverse(x[i], y[i], z[i], lat[i], lon[i], h[i]);
+      c.Stop(m);
+      for (int i = 0; i < m; ++i) {
+	real xx, yy, zz;
+	ref(lat[i], lon[i], h[i], xx, yy, zz);
+	c.Add(hypot3(xx - x[i], yy - y[i], zz - z[i]) * 1e9L);
+      }
+      fail += !c.Report();
+    }
+  }
+  return fail;
+}
+
+// Reference functions for Cartesian
+struct GeocentricRef {
+  void operator()(real lat, real lon, real h, real& x, real& y, real& z)
+    const { RefGeocentric(lat, lon, h, x, y, z); }
+};
+
+struct LocalRef {
+  real lat0, lon0, h0;
+  LocalRef(real lat, real lon, real h) : lat0(lat), lon0(lon), h0(h) {}
+  void operator()(real lat, real lon, real h, real& x, real& y, real& z)
+    const { RefLocal(lat0, lon0, h0, lat, lon, h, x, y, z); }
+};
+
+int main(int argc, char* argv[]) {
+  using namespace GeographicLib;
+  int count = 10000;
+  unsigned long long seed = 1;
+  std::string filter;
+  for (int m = 1; m < argc; ++m) {
+    std::string arg = std::string(argv[m]);
+    if (arg == "-n" || arg == "-s") {
+      if (++m == argc) return usage(1);
+      std::istringstream str(argv[m]);
+      int x;
+      if (!(str >> x) || x <= 0) return usage(1);
+      if (arg == "-n")
+	count = x;
+      else
+	seed = x;
+    } else if (arg == "-t") {
+      if (++m == argc) return usage(1);
+      filter = std::string(argv[m]);
+    } else
+      return usage(arg != "-h");
+  }
+  if (std::numeric_limits<real>::digits <= std::numeric_limits<double>::digits)
+    std::cerr << "WARNING: long double is no more accurate than double\n";
+  std::cout << "# name                               distrib      max(nm)"
+	    << "    rms(nm)  budget     ns/op\n";
+  int fail = 0;
+  Points p;
+  for (int dist = 0; dist < NDIST; ++dist) {
+    Generate(dist, count, seed, p);
+    if (dist != WIDE) {
+      fail += Geodesics(p, filter);
+      fail += SphereGeodesics(p, filter);
+    }
+    if (dist == UTM || dist == POLAR)
+      fail += Multilat(p, filter);
+    if (dist == UTM || dist == WIDE) {
+      fail += Projection(TransverseMercator::UTM, RefTM,
+			 "TransverseMercator", "", tmbudget, p, filter);
+      fail += Projection(TransverseMercatorExact::UTM, RefTM,
+			 "TransverseMercatorExact", "", tmebudget, p, filter);
+      fail += Projection(TransverseMercator(double(a), 0, double(utmk0)),
+			 RefSphereTM, "TransverseMercator", " (sphere)",
+			 tmbudget, p, filter);
+      fail += TMJacobian(p, filter);
+    }
+    if (dist == POLAR)
+      fail += Polar(p, filter);
+    if (dist == GLOBAL || dist == POLAR)
+      fail += Cartesian(Geocentric::WGS84, GeocentricRef(), "Geocentric",
+			geocbudget, p, filter);
+    if (dist == UTM) {
+      // Points within 0.5d of a local origin at the first point
+      const double lat0 = p.lat1[0], lon0 = p.lon1[0], h0 = p.h[0];
+      for (int i = 0; i < p.n; ++i) {
+	p.lat1[i] = lat0 + (p.lat2[i] - p.lat1[i]);
+	p.lon1[i] = double(AngNormalize(lon0 + (p.lon2[i] - p.lon1[i])));
+      }
+      const LocalCartesian lc(lat0, lon0, h0);
+      fail += Cartesian(lc, LocalRef(lat0, lon0, h0),
+			"LocalCartesian", localbudget, p, filter);
+    }
+  }
+  if (fail)
+    std::cout << fail << " case" << (fail > 1 ? "s" : "")
+	      << " exceeded the error budget\n";
+  return fail ? 1 : 0;
+}
@@ -0,0 +1,584 @@
+/**
+ * \file Benchmark.cpp
+ * \brief Utility for timing the GeographicLib calculations
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * http://charles.karney.info/geographic
+ * and licensed under the LGPL.
+ *
+ * Compile with
+ *
+ *   g++ -g -O3 -I.. -o Benchmark Benchmark.cpp Geodesic.cpp TransverseMercator.cpp TransverseMercatorExact.cpp EllipticFunction.cpp PolarStereographic.cpp Geocentric.cpp UTMUPS.cpp MGRS.cpp DMS.cpp Constants.cpp Stats.cpp
+ *
+ * See \ref benchmark for usage information.
+ **********************************************************************/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+#include <cmath>
+#include "GeographicLib/Geodesic.hpp"
+#include "GeographicLib/TransverseMercator.hpp"
+#include "GeographicLib/TransverseMercatorExact.hpp"
+#include "GeographicLib/PolarStereographic.hpp"
+#include "GeographicLib/Geocentric.hpp"
+#include "GeographicLib/UTMUPS.hpp"
+#include "GeographicLib/MGRS.hpp"
+#include "GeographicLib/DMS.hpp"
+#include "GeographicLib/Stats.hpp"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+int usage(int retval) {
+  ( retval ? std::cerr : std::cout ) <<
+"Usage: Benchmark [-n count] [-s seed] [-c chunk] [-t name] [-o file] [-h]\n\
+$Id$\n\
+\n\
+Time the principal calculations of GeographicLib: Geodesic::Direct and\n\
+Inverse (also with a tolerance of 1 mm and with the Jacobian) and\n\
+CrossTrack, GeodesicLine::Position and ArcPosition, TransverseMercator\n\
+(also Forward with the Jacobian) and TransverseMercatorExact Forward and\n\
+Reverse, PolarStereographic, Geocentric, MGRS, and DMS.  Each calculation\n\
+is timed for count (default 100000) points from each of several\n\
+distributions:\n\
+\n\
+    global: latitudes and longitudes uniform over the ellipsoid\n\
+    antipodal: the second point of a geodesic within 0.5d of the\n\
+        antipode of the first (geodesic calculations only)\n\
+    polar: latitudes within 10d of a pole\n\
+    utm: latitudes in [-80d, 84d] and short geodesics (at most 100 km)\n\
+\n\
+The points are generated with a fixed pseudo-random sequence starting with\n\
+seed (default 1) so the inputs are the same on all machines.  The\n\
+calculations are timed in chunks of chunk (default 100) points after a\n\
+warm up pass.  For each case, a line is printed giving the name of the\n\
+calculation, the distribution, the mean time per operation (ns), the\n\
+number of operations per second, and the 50th, 90th, and 99th percentiles\n\
+of the time per operation (ns) over the chunks.\n\
+\n\
+-t name only runs the calculations whose names contain name, e.g.,\n\
+\"-t Geodesic::\" or \"-t Reverse\".\n\
+\n\
+-o file also writes the results to file in JSON format for comparison\n\
+between releases.\n\
+\n\
+If the library is compiled with GEOGRAPHICLIB_STATS = 1 (\"make STATS=1\"),\n\
+each line is followed by comment lines giving the nonzero instrumentation\n\
+counters (see the documentation of Stats) for the timed calls.\n\
+\n\
+-h prints this help.\n";
+  return retval;
+}
+
+// A linear congruential generator (Knuth's MMIX constants) so that the
+// inputs don't depend on the C library.
+class Random {
+private:
+  unsigned long long _state;
+public:
+  explicit Random(unsigned long long seed)
+    : _state(seed * 2862933555777941757ULL + 3037000493ULL) {}
+  // A uniform deviate in [0, 1)
+  double Uniform() {
+    _state = _state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return double(_state >> 11) / 9007199254740992.0;
+  }
+  // A uniform deviate in [a, b)
+  double Uniform(double a, double b) { return a + (b - a) * Uniform(); }
+};
+
+enum { GLOBAL, ANTIPODAL, POLAR, UTM, NDIST };
+const char* const distnames[NDIST] = {"global", "antipodal", "polar", "utm"};
+
+// The inputs and outputs of the calculations for n points.
+struct Data {
+  int n;
+  std::vector<double> lat1, lon1, azi1, lat2, lon2, s12, h, lon0;
+  // General purpose outputs (some are used as inputs to Reverse)
+  std::vector<double> out[6];
+  std::vector<int> zone, len;
+  std::vector<char> northp;
+  std::vector<GeographicLib::GeodesicLine> lines;
+  // Fixed width records of text for MGRS and DMS
+  std::vector<char> text;
+};
+
+double AngNormalize(double x) {
+  return x >= 180 ? x - 360 : x < -180 ? x + 360 : x;
+}
+
+// Fill d with n points of distribution dist.
+void Generate(int dist, int n, unsigned long long seed, Data& d) {
+  Random r(seed * NDIST + dist);
+  d.n = n;
+  d.lat1.resize(n); d.lon1.resize(n); d.azi1.resize(n);
+  d.lat2.resize(n); d.lon2.resize(n); d.s12.resize(n);
+  d.h.resize(n); d.lon0.resize(n);
+  for (int k = 0; k < 6; ++k)
+    d.out[k].assign(n, 0);
+  d.zone.assign(n, 0);
+  d.len.assign(n, 0);
+  d.northp.assign(n, 0);
+  const double deg = std::atan2(0.0, -1.0) / 180;
+  for (int i = 0; i < n; ++i) {
+    double lat1, lon1 = r.Uniform(-180, 180), lat2, lon2, s12;
+    switch (dist) {
+    case GLOBAL:
+    case ANTIPODAL:
+      lat1 = std::asin(r.Uniform(-1, 1)) / deg;
+      break;
+    case POLAR:
+      lat1 = (r.Uniform() < 0.5 ? -1 : 1) * (90 - r.Uniform(0, 10));
+      break;
+    default:
+      lat1 = r.Uniform(-80, 84);
+      break;
+    }
+    switch (dist) {
+    case GLOBAL:
+      lat2 = std::asin(r.Uniform(-1, 1)) / deg;
+      lon2 = r.Uniform(-180, 180);
+      s12 = r.Uniform(0, 20e6);
+      break;
+    case ANTIPODAL:
+      lat2 = std::max(-90.0, std::min(90.0, -lat1 + r.Uniform(-0.5, 0.5)));
+      lon2 = AngNormalize(lon1 + 180 + r.Uniform(-0.5, 0.5));
+      s12 = r.Uniform(19.9e6, 20.0e6);
+      break;
+    case POLAR:
+      lat2 = (r.Uniform() < 0.5 ? -1 : 1) * (90 - r.Uniform(0, 10));
+      lon2 = r.Uniform(-180, 180);
+      s12 = r.Uniform(0, 2e6);
+      break;
+    default:
+      lat2 = std::max(-90.0, std::min(90.0, lat1 + r.Uniform(-0.5, 0.5)));
+      lon2 = AngNormalize(lon1 + r.Uniform(-0.5, 0.5));
+      s12 = r.Uniform(0, 100e3);
+      break;
+    }
+    d.lat1[i] = lat1; d.lon1[i] = lon1; d.azi1[i] = r.Uniform(-180, 180);
+    d.lat2[i] = lat2; d.lon2[i] = lon2; d.s12[i] = s12;
+    d.h[i] = r.Uniform(-100, 9000);
+    // The central meridian of the UTM zone
+    d.lon0[i] = 6 * std::floor(lon1 / 6) + 3;
+  }
+  // GeodesicLine::Position cycles through these lines
+  d.lines.resize(std::min(n, 1000));
+  for (size_t j = 0; j < d.lines.size(); ++j)
+    d.lines[j] = GeographicLib::Geodesic::WGS84.Line(d.lat1[j], d.lon1[j],
+						     d.azi1[j]);
+}
+
+// The calculations being timed; each does the calculation for point i.
+
+struct GeodesicDirect {
+  void operator()(Data& d, int i) const {
+    GeographicLib::Geodesic::WGS84.Direct(d.lat1[i], d.lon1[i], d.azi1[i],
+					  d.s12[i], d.out[0][i], d.out[1][i],
+					  d.out[2][i]);
+  }
+};
+
+struct GeodesicInverse {
+  void operator()(Data& d, int i) const {
+    GeographicLib::Geodesic::WGS84.Inverse(d.lat1[i], d.lon1[i],
+					   d.lat2[i], d.lon2[i],
+					   d.out[0][i], d.out[1][i],
+					   d.out[2][i]);
+  }
+};
+
+// Inverse accepting the local approximation if it's good to 1 mm
+struct GeodesicInverseTol {
+  void operator()(Data& d, int i) const {
+    GeographicLib::Geodesic::WGS84.Inverse(d.lat1[i], d.lon1[i],
+					   d.lat2[i], d.lon2[i], 1e-3,
+					   d.out[0][i], d.out[1][i],
+					   d.out[2][i]);
+  }
+};
+
+// Inverse also returning the derivatives with respect to the end points
+struct GeodesicInverseJacobian {
+  void operator()(Data& d, int i) const {
+    double jac[12];
+    GeographicLib::Geodesic::WGS84.InverseJacobian(d.lat1[i], d.lon1[i],
+						   d.lat2[i], d.lon2[i],
+						   d.out[0][i], d.out[1][i],
+						   d.out[2][i], jac);
+    d.out[3][i] = jac[0];
+  }
+};
+
+// The foot of the perpendicular from point 2 to one of the lines
+struct GeodesicCrossTrack {
+  void operator()(Data& d, int i) const {
+    GeographicLib::Geodesic::WGS84.CrossTrack(d.lines[i % d.lines.size()],
+					      d.lat2[i], d.lon2[i],
+					      d.out[0][i], d.out[1][i],
+					      d.out[2][i], d.out[3][i]);
+  }
+};
+
+struct LinePosition {
+  void operator()(Data& d, int i) const {
+    d.lines[i % d.lines.size()].Position(d.s12[i], d.out[0][i], d.out[1][i],
+					 d.out[2][i]);
+  }
+};
+
+// The arc lengths (degrees) are the distances scaled by 1 degree = 111 km
+struct LineArcPosition {
+  void operator()(Data& d, int i) const {
+    d.lines[i % d.lines.size()].ArcPosition(d.s12[i] / 111e3, d.out[0][i],
+					    d.out[1][i], d.out[2][i]);
+  }
+};
+
+// Forward and Reverse for TransverseMercator and TransverseMercatorExact.
+// Reverse inverts the results of Forward (set up by Setup in Run).
+template<class TM> struct TMForward {
+  const TM& tm;
+  explicit TMForward(const TM& t) : tm(t) {}
+  void operator()(Data& d, int i) const {
+    tm.Forward(d.lon0[i], d.lat1[i], d.lon1[i], d.out[0][i], d.out[1][i],
+	       d.out[2][i], d.out[3][i]);
+  }
+};
+
+template<class TM> struct TMReverse {
+  const TM& tm;
+  explicit TMReverse(const TM& t) : tm(t) {}
+  void operator()(Data& d, int i) const {
+    tm.Reverse(d.lon0[i], d.out[0][i], d.out[1][i], d.out[2][i], d.out[3][i],
+	       d.out[4][i], d.out[5][i]);
+  }
+};
+
+struct TMForwardJacobian {
+  void operator()(Data& d, int i) const {
+    const GeographicLib::TransverseMercator& tm =
+      GeographicLib::TransverseMercator::UTM;
+    double jac[4];
+    tm.ForwardJacobian(d.lon0[i], d.lat1[i], d.lon1[i], d.out[0][i],
+		       d.out[1][i], d.out[2][i], d.out[3][i], jac);
+    d.out[4][i] = jac[0];
+  }
+};
+
+struct PSForward {
+  void operator()(Data& d, int i) const {
+    GeographicLib::PolarStereographic::UPS.Forward(d.lat1[i] > 0,
+						   d.lat1[i], d.lon1[i],
+						   d.out[0][i], d.out[1][i],
+						   d.out[2][i], d.out[3][i]);
+  }
+};
+
+struct PSReverse {
+  void operator()(Data& d, int i) const {
+    GeographicLib::PolarStereographic::UPS.Reverse(d.lat1[i] > 0,
+						   d.out[0][i], d.out[1][i],
+						   d.out[2][i], d.out[3][i],
+						   d.out[4][i], d.out[5][i]);
+  }
+};
+
+struct GeocentricForward {
+  void operator()(Data& d, int i) const {
+    GeographicLib::Geocentric::WGS84.Forward(d.lat1[i], d.lon1[i], d.h[i],
+					     d.out[0][i], d.out[1][i],
+					     d.out[2][i]);
+  }
+};
+
+struct GeocentricReverse {
+  void operator()(Data& d, int i) const {
+    GeographicLib::Geocentric::WGS84.Reverse(d.out[0][i], d.out[1][i],
+					     d.out[2][i], d.out[3][i],
+					     d.out[4][i], d.out[5][i]);
+  }
+};
+
+// MGRS::Forward converts the UTM/UPS coordinates in zone, northp, out[0],
+// and out[1] (set by UTMForward) to MGRS strings at 1 m precision.
+// MGRS::Reverse converts them back.
+struct UTMForward {
+  void operator()(Data& d, int i) const {
+    bool northp;
+    double gamma, k;
+    GeographicLib::UTMUPS::Forward(d.lat1[i], d.lon1[i], d.zone[i], northp,
+				   d.out[0][i], d.out[1][i], gamma, k);
+    d.northp[i] = northp;
+  }
+};
+
+struct MGRSForward {
+  void operator()(Data& d, int i) const {
+    using namespace GeographicLib;
+    d.len[i] = MGRS::Forward(d.zone[i], d.northp[i] != 0,
+			     d.out[0][i], d.out[1][i], d.lat1[i], 5,
+			     &d.text[i * MGRS::bufsize]);
+  }
+};
+
+struct MGRSReverse {
+  void operator()(Data& d, int i) const {
+    using namespace GeographicLib;
+    bool northp;
+    int prec;
+    MGRS::Reverse(&d.text[i * MGRS::bufsize], d.len[i], d.zone[i], northp,
+		  d.out[2][i], d.out[3][i], prec);
+  }
+};
+
+// DMS::Encode writes the latitudes to 0.0001" and DMS::Decode reads them.
+struct DMSEncode {
+  void operator()(Data& d, int i) const {
+    using namespace GeographicLib;
+    d.len[i] = DMS::Encode(d.lat1[i], 8, DMS::LATITUDE,
+			   &d.text[i * DMS::bufsize]);
+  }
+};
+
+struct DMSDecode {
+  void operator()(Data& d, int i) const {
+    using namespace GeographicLib;
+    DMS::flag ind;
+    DMS::Decode(&d.text[i * DMS::bufsize], d.len[i], d.out[0][i], ind);
+  }
+};
+
+// The timing of one calculation for one distribution.  Times are in ns.
+struct Result {
+  std::string name, dist;
+  int ops;
+  double mean, rate, p50, p90, p99;
+};
+
+double Now() {
+#if defined(_WIN32)
+  LARGE_INTEGER t, f;
+  QueryPerformanceCounter(&t);
+  QueryPerformanceFrequency(&f);
+  return double(t.QuadPart) / double(f.QuadPart);
+#else
+  timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return double(t.tv_sec) + 1e-9 * double(t.tv_nsec);
+#endif
+}
+
+// The pth percentile of the sorted times x.
+double Percentile(const std::vector<double>& x, double p) {
+  return x.empty() ? 0 : x[int(p / 100 * (x.size() - 1) + 0.5)];
+}
+
+// Time op applied to the points in d in chunks of chunk points.  Skip the
+// calculation if its name doesn't contain filter.
+template<class Op> void Time(const std::string& name, int dist,
+			     const Op& op, Data& d, int chunk,
+			     const std::string& filter,
+			     std::vector<Result>& results) {
+  if (name.find(filter) == std::string::npos)
+    return;
+  const int n = d.n;
+  for (int i = 0; i < std::min(n, chunk); ++i)
+    op(d, i);
+  GeographicLib::Stats::ResetAll();
+  std::vector<double> times;
+  times.reserve(n / chunk + 1);
+  double start = Now();
+  for (int i0 = 0; i0 < n; i0 += chunk) {
+    int i1 = std::min(n, i0 + chunk);
+    double t = Now();
+    for (int i = i0; i < i1; ++i)
+      op(d, i);
+    times.push_back((Now() - t) * 1e9 / (i1 - i0));
+  }
+  double total = Now() - start;
+  std::sort(times.begin(), times.end());
+  Result r;
+  r.name = name;
+  r.dist = distnames[dist];
+  r.ops = n;
+  r.mean = total * 1e9 / n;
+  r.rate = n / total;
+  r.p50 = Percentile(times, 50);
+  r.p90 = Percentile(times, 90);
+  r.p99 = Percentile(times, 99);
+  results.push_back(r);
+  char line[256];
+  sprintf(line, "%-35s %-10s %10.1f %12.0f %10.1f %10.1f %10.1f\n",
+	  r.name.c_str(), r.dist.c_str(), r.mean, r.rate, r.p50, r.p90, r.p99);
+  std::cout << line;
+  if (GeographicLib::Stats::Enabled())
+    for (int c = 0; c < GeographicLib::Stats::NUMCOUNTERS; ++c) {
+      GeographicLib::Stats::counter k = GeographicLib::Stats::counter(c);
+      GeographicLib::Stats::count_t t = GeographicLib::Stats::Total(k);
+      if (t)
+	std::cout << "#   " << GeographicLib::Stats::Name(k) << " "
+		  << t << "\n";
+    }
+  std::cout << std::flush;
+}
+
+// Apply op to all the points in d (not timed) to set up the inputs of the
+// calculation name, e.g., the results of Forward which Reverse inverts.
+// This is skipped if the calculation isn't run.
+template<class Op> void Setup(const std::string& name, const Op& op, Data& d,
+			      const std::string& filter) {
+  if (name.find(filter) == std::string::npos)
+    return;
+  for (int i = 0; i < d.n; ++i)
+    op(d, i);
+}
+
+// Run the calculations which apply to distribution dist.
+void Run(int dist, Data& d, int chunk, const std::string& filter,
+	 std::vector<Result>& results) {
+  using namespace GeographicLib;
+  Time("Geodesic::Direct", dist, GeodesicDirect(), d, chunk, filter,
+       results);
+  Time("Geodesic::Inverse", dist, GeodesicInverse(), d, chunk, filter,
+       results);
+  Time("Geodesic::Inverse(tol)", dist, GeodesicInverseTol(), d, chunk,
+       filter, results);
+  Time("Geodesic::InverseJacobian", dist, GeodesicInverseJacobian(), d,
+       chunk, filter, results);
+  Time("Geodesic::CrossTrack", dist, GeodesicCrossTrack(), d, chunk,
+       filter, results);
+  Time("GeodesicLine::Position", dist, LinePosition(), d, chunk, filter,
+       results);
+  Time("GeodesicLine::ArcPosition", dist, LineArcPosition(), d, chunk,
+       filter, results);
+  if (dist == ANTIPODAL)
+    return;
+  Time("TransverseMercator::Forward", dist,
+       TMForward<TransverseMercator>(TransverseMercator::UTM),
+       d, chunk, filter, results);
+  Setup("TransverseMercator::Reverse",
+	TMForward<TransverseMercator>(TransverseMercator::UTM), d, filter);
+  Time("TransverseMercator::Reverse", dist,
+       TMReverse<TransverseMercator>(TransverseMercator::UTM),
+       d, chunk, filter, results);
+  Time("TransverseMercator::ForwardJacobian", dist, TMForwardJacobian(), d,
+       chunk, filter, results);
+  Time("TransverseMercatorExact::Forward", dist,
+       TMForward<TransverseMercatorExact>(TransverseMercatorExact::UTM),
+       d, chunk, filter, results);
+  Setup("TransverseMercatorExact::Reverse",
+	TMForward<TransverseMercatorExact>(TransverseMercatorExact::UTM),
+	d, filter);
+  Time("TransverseMercatorExact::Reverse", dist,
+       TMReverse<TransverseMercatorExact>(TransverseMercatorExact::UTM),
+       d, chunk, filter, results);
+  if (dist == POLAR) {
+    Time("PolarStereographic::Forward", dist, PSForward(), d, chunk, filter,
+	 results);
+    Setup("PolarStereographic::Reverse", PSForward(), d, filter);
+    Time("PolarStereographic::Reverse", dist, PSReverse(), d, chunk, filter,
+	 results);
+  }
+  Time("Geocentric::Forward", dist, GeocentricForward(), d, chunk, filter,
+       results);
+  Setup("Geocentric::Reverse", GeocentricForward(), d, filter);
+  Time("Geocentric::Reverse", dist, GeocentricReverse(), d, chunk, filter,
+       results);
+  if (dist != GLOBAL) {
+    // Set up the UTM/UPS coordinates (not timed)
+    for (int i = 0; i < d.n; ++i)
+      UTMForward()(d, i);
+    d.text.assign(d.n * MGRS::bufsize, '\0');
+    Time("MGRS::Forward", dist, MGRSForward(), d, chunk, filter, results);
+    Setup("MGRS::Reverse", MGRSForward(), d, filter);
+    Time("MGRS::Reverse", dist, MGRSReverse(), d, chunk, filter, results);
+  } else {
+    d.text.assign(d.n * DMS::bufsize, '\0');
+    Time("DMS::Encode", dist, DMSEncode(), d, chunk, filter, results);
+    Setup("DMS::Decode", DMSEncode(), d, filter);
+    Time("DMS::Decode", dist, DMSDecode(), d, chunk, filter, results);
+  }
+}
+
+// Write the results to the stream str in JSON format.
+void WriteJSON(std::ostream& str, int count, unsigned long long seed,
+	       int chunk, const std::vector<Result>& results) {
+  str << "{\n"
+      << "  \"benchmark\": \"GeographicLib\",\n"
+      << "  \"count\": " << count << ",\n"
+      << "  \"seed\": " << seed << ",\n"
+      << "  \"chunk\": " << chunk << ",\n"
+      << "  \"units\": \"ns\",\n"
+      << "  \"results\": [\n";
+  char line[512];
+  for (size_t j = 0; j < results.size(); ++j) {
+    const Result& r = results[j];
+    sprintf(line, "    {\"name\": \"%s\", \"distribution\": \"%s\", "
+	    "\"ops\": %d, \"ns_per_op\": %.2f, \"ops_per_sec\": %.0f, "
+	    "\"p50\": %.2f, \"p90\": %.2f, \"p99\": %.2f}%s\n",
+	    r.name.c_str(), r.dist.c_str(), r.ops, r.mean, r.rate,
+	    r.p50, r.p90, r.p99, j + 1 < results.size() ? "," : "");
+    str << line;
+  }
+  str << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+  int count = 100000, chunk = 100;
+  unsigned long long seed = 1;
+  std::string filter, jsonfile;
+  for (int m = 1; m < argc; ++m) {
+    std::string arg = std::string(argv[m]);
+    if (arg == "-n" || arg == "-c" || arg == "-s") {
+      if (++m == argc) return usage(1);
+      std::istringstream str(argv[m]);
+      int x;
+      if (!(str >> x) || x <= 0) return usage(1);
+      if (arg == "-n")
+	count = x;
+      else if (arg == "-c")
+	chunk = x;
+      else
+	seed = x;
+    } else if (arg == "-t") {
+      if (++m == argc) return usage(1);
+      filter = std::string(argv[m]);
+    } else if (arg == "-o") {
+      if (++m == argc) return usage(1);
+      jsonfile = std::string(argv[m]);
+    } else
+      return usage(arg != "-h");
+  }
+  std::cout << "# name                              distribution   ns/op"
+	    << "        ops/s        p50        p90        p99\n";
+  std::vector<Result> results;
+  Data d;
+  try {
+    for (int dist = 0; dist < NDIST; ++dist) {
+      Generate(dist, count, seed, d);
+      Run(dist, d, chunk, filter, results);
+    }
+  }
+  catch (std::out_of_range& e) {
+    std::cerr << "ERROR: " << e.what() << "\n";
+    return 1;
+  }
+  if (!jsonfile.empty()) {
+    std::ofstream str(jsonfile.c_str());
+    WriteJSON(str, count, seed, chunk, results);
+    if (!str) {
+      std::cerr << "ERROR: Cannot write " << jsonfile << "\n";
+      return 1;
+    }
+  }
+  return 0;
+}
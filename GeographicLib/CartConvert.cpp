@@ -8,7 +8,7 @@
  *
  * Compile with
  *
- *   g++ -g -O3 -I.. -o CartConvert CartConvert.cpp Geocentric.cpp LocalCartesian.cpp Constants.cpp
+ *   g++ -g -O3 -I.. -o CartConvert CartConvert.cpp Geocentric.cpp LocalCartesian.cpp Constants.cpp PointFile.cpp Utility.cpp
  *
  * See \ref cartconvert for usage information.
  **********************************************************************/
@@ -17,12 +17,23 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <vector>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cmath>
 #include "GeographicLib/Geocentric.hpp"
 #include "GeographicLib/LocalCartesian.hpp"
+#include "GeographicLib/PointFile.hpp"
+#include "GeographicLib/Utility.hpp"
 
 int usage(int retval) {
   ( retval ? std::cerr : std::cout ) <<
-"Usage: CartConvert [-r] [-l lat0 lon0 h0] [-h]\n\
+"Usage: CartConvert [-r] [-l lat0 lon0 h0]... [-b] [-j threads] [-R file]\n\
+            [-W file] [-h]\n\
 $Id: CartConvert.cpp 6553 2009-02-24 03:10:01Z ckarney $\n\
 \n\
 Convert geodetic coordinates to either geocentric or local cartesian\n\
@@ -40,53 +51,379 @@ cartesian coordinates x, y, z (meters) are printed on standard output.\n\
 \n\
 If -r is given the reverse transformation is performed.\n\
 \n\
+-l may be given several times to convert each point to several local\n\
+coordinate systems in one pass.  The output then consists of x, y, z for\n\
+each of the systems in turn.  With -r, the input x, y, z is converted\n\
+from each of the local systems in turn and the output consists of lat,\n\
+lon, h for each.\n\
+\n\
+-j threads reads the standard input in large blocks and splits the\n\
+points of each block between threads (0 means use all the processors).\n\
+The output is the same as without -j, except that it is only written\n\
+at the end of each block.\n\
+\n\
+-b reads and writes binary records instead of lines of text.  Each\n\
+input record consists of three little-endian doubles, the same\n\
+quantities as for text input.  Each output record consists of three\n\
+little-endian doubles for each coordinate system.  The records are\n\
+processed in blocks as with -j (by default using all the processors).\n\
+\n\
+-R file reads the coordinates from the columns lat, lon, and h (or x, y,\n\
+and z with -r) of a point file instead of standard input.  -W file\n\
+writes the results to the columns x, y, and z (or lat, lon, and h) of a\n\
+point file.  With several -l options, the output columns are x1, y1, z1,\n\
+x2, etc. (or lat1, lon1, h1, lat2, etc.).  A point file is a memory\n\
+mapped binary file with named columns of doubles (see the documentation\n\
+of PointFile).\n\
+\n\
 -h prints this help\n";
   return retval;
 }
 
+// Don't give a thread fewer points than this
+const int minpoints = 1000;
+
+// Convert the n points in the columns v to the columns r using the local
+// system j of lcs (or geocentric coordinates if lcs is empty).
+void Convert(bool reverse,
+	     const std::vector<GeographicLib::LocalCartesian>& lcs,
+	     const GeographicLib::Geocentric& ec, int j, int n,
+	     const double* const v[], double* const r[]) {
+  if (reverse) {
+    if (lcs.empty())
+      ec.Reverse(n, v[0], v[1], v[2], r[0], r[1], r[2]);
+    else
+      lcs[j].Reverse(n, v[0], v[1], v[2], r[0], r[1], r[2]);
+  } else {
+    if (lcs.empty())
+      ec.Forward(n, v[0], v[1], v[2], r[0], r[1], r[2]);
+    else
+      lcs[j].Forward(n, v[0], v[1], v[2], r[0], r[1], r[2]);
+  }
+}
+
+// Append row i of the ncols columns r to os as a line of text.
+void Format(int ncols, const double* const r[], int i, std::string& os) {
+  // Same format as std::cout << std::setprecision(16)
+  char buf[32];
+  for (int k = 0; k < ncols; ++k) {
+    if (k)
+      os += ' ';
+    sprintf(buf, "%.16g", r[k][i]);
+    os += buf;
+  }
+  os += '\n';
+}
+
+// Write the first n rows of the ncols columns r to standard output,
+// formatting them with nthreads threads.
+void Write(int nthreads, int ncols, int n, const double* const r[],
+	   std::vector<std::string>& out) {
+  int nt = std::max(1, std::min(nthreads, n / minpoints));
+  out.resize(nt);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+  for (int t = 0; t < nt; ++t) {
+    std::string& os = out[t];
+    os.clear();
+    int
+      i0 = int(double(n) * t / nt),
+      i1 = int(double(n) * (t + 1) / nt);
+    for (int i = i0; i < i1; ++i)
+      Format(ncols, r, i, os);
+  }
+  for (int t = 0; t < nt; ++t)
+    fwrite(out[t].data(), 1, out[t].size(), stdout);
+}
+
+// Process the numbers on standard input in blocks using nthreads threads.
+// As with reading from std::cin, the input stops at the first item which
+// isn't a number.
+int Stream(int nthreads, bool reverse,
+	   const std::vector<GeographicLib::LocalCartesian>& lcs,
+	   const GeographicLib::Geocentric& ec) {
+  nthreads = GeographicLib::Utility::SetThreads(nthreads);
+  const size_t blocksize = 1 << 22;
+  const int
+    nframes = std::max(1, int(lcs.size())),
+    ncols = 3 * nframes;
+  std::vector<char> buf;
+  std::vector<size_t> beg, end;
+  std::vector<double> val, v[3];
+  std::vector<std::vector<double> > res(ncols);
+  std::vector<char> ok;
+  std::vector<std::string> out;
+  size_t carry = 0;
+  for (bool eof = false, done = false; !(eof || done);) {
+    buf.resize(carry + blocksize);
+    size_t
+      nread = fread(&buf[0] + carry, 1, blocksize, stdin),
+      len = carry + nread,
+      stop = len;
+    eof = nread < blocksize;
+    if (!eof) {
+      // Only process complete numbers; keep the rest for the next block.
+      while (stop > 0 && !isspace((unsigned char)(buf[stop - 1])))
+	--stop;
+      if (stop == 0) {
+	// No white space yet; read more
+	carry = len;
+	continue;
+      }
+    }
+    beg.clear();
+    end.clear();
+    for (size_t pos = 0;;) {
+      while (pos < stop && isspace((unsigned char)(buf[pos])))
+	++pos;
+      if (pos == stop)
+	break;
+      beg.push_back(pos);
+      while (pos < stop && !isspace((unsigned char)(buf[pos])))
+	++pos;
+      end.push_back(pos);
+    }
+    int
+      nwords = int(beg.size()),
+      nt = std::max(1, std::min(nthreads, nwords / (3 * minpoints)));
+    val.resize(nwords);
+    ok.assign(nwords, 0);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+    for (int t = 0; t < nt; ++t) {
+      int
+	i0 = int(double(nwords) * t / nt),
+	i1 = int(double(nwords) * (t + 1) / nt);
+      for (int i = i0; i < i1; ++i)
+	ok[i] = GeographicLib::Utility::ReadNumber(&buf[0] + beg[i],
+						   int(end[i] - beg[i]), val[i]);
+    }
+    int good = int(std::find(ok.begin(), ok.end(), 0) - ok.begin());
+    if (good < nwords) {
+      // Let std::istringstream have the final say on an unusual number (it
+      // accepts a leading number, e.g., 0 in 0x10).
+      std::istringstream str(std::string(&buf[0] + beg[good],
+					 end[good] - beg[good]));
+      if (str >> val[good])
+	++good;
+      done = true;
+    }
+    int n = good / 3;
+    if (!done) {
+      // Keep an incomplete point for the next block.
+      size_t keep = 3 * n < nwords ? beg[3 * n] : stop;
+      carry = len - keep;
+      if (carry)
+	memmove(&buf[0], &buf[0] + keep, carry);
+    }
+    if (n == 0)
+      continue;
+    for (int k = 0; k < 3; ++k) {
+      v[k].resize(n);
+      for (int i = 0; i < n; ++i)
+	v[k][i] = val[3 * i + k];
+    }
+    const double* vp[3] = {&v[0][0], &v[1][0], &v[2][0]};
+    std::vector<double*> rp(ncols);
+    for (int k = 0; k < ncols; ++k) {
+      res[k].resize(n);
+      rp[k] = &res[k][0];
+    }
+    for (int j = 0; j < nframes; ++j)
+      Convert(reverse, lcs, ec, j, n, vp, &rp[3 * j]);
+    Write(nthreads, ncols, n, &rp[0], out);
+  }
+  fflush(stdout);
+  return 0;
+}
+
+// Process binary records from standard input in blocks using nthreads
+// threads.  Return 1 if the input ends with an incomplete record.
+int BinaryStream(int nthreads, bool reverse,
+		 const std::vector<GeographicLib::LocalCartesian>& lcs,
+		 const GeographicLib::Geocentric& ec) {
+  GeographicLib::Utility::SetThreads(nthreads);
+  const int
+    blockrecs = 1 << 16,
+    nframes = std::max(1, int(lcs.size())),
+    ncols = 3 * nframes;
+  std::vector<double> inbuf(blockrecs * 3), outbuf(blockrecs * ncols),
+    v[3];
+  std::vector<std::vector<double> > res(ncols);
+  const double* vp[3];
+  std::vector<double*> rp(ncols);
+  for (int k = 0; k < 3; ++k) {
+    v[k].resize(blockrecs);
+    vp[k] = &v[k][0];
+  }
+  for (int k = 0; k < ncols; ++k) {
+    res[k].resize(blockrecs);
+    rp[k] = &res[k][0];
+  }
+  int retval = 0;
+  for (bool eof = false; !eof;) {
+    size_t
+      size = blockrecs * 3 * sizeof(double),
+      nread = fread(&inbuf[0], 1, size, stdin);
+    eof = nread < size;
+    if (nread % (3 * sizeof(double))) {
+      std::cerr << "ERROR: Incomplete record at end of input\n";
+      retval = 1;
+    }
+    int n = int(nread / (3 * sizeof(double)));
+    GeographicLib::Utility::LittleEndian(&inbuf[0], n * 3);
+    for (int i = 0; i < n; ++i)
+      for (int k = 0; k < 3; ++k)
+	v[k][i] = inbuf[3 * i + k];
+    for (int j = 0; j < nframes; ++j)
+      Convert(reverse, lcs, ec, j, n, vp, &rp[3 * j]);
+    for (int i = 0; i < n; ++i)
+      for (int k = 0; k < ncols; ++k)
+	outbuf[i * ncols + k] = res[k][i];
+    GeographicLib::Utility::LittleEndian(&outbuf[0], n * ncols);
+    fwrite(&outbuf[0], sizeof(double), n * ncols, stdout);
+  }
+  fflush(stdout);
+  return retval;
+}
+
+// Convert the coordinates in the point file infile (or standard input if
+// infile is empty) using nthreads threads writing the results to the point
+// file outfile (or standard output if outfile is empty).
+int Files(const std::string& infile, const std::string& outfile,
+	  int nthreads, bool reverse,
+	  const std::vector<GeographicLib::LocalCartesian>& lcs,
+	  const GeographicLib::Geocentric& ec) {
+  static const char* const names[2][3] =
+    {{"lat", "lon", "h"}, {"x", "y", "z"}};
+  const char
+    *const *innames = names[reverse ? 1 : 0],
+    *const *outnames = names[reverse ? 0 : 1];
+  const int
+    blockpts = 1 << 16,
+    nframes = std::max(1, int(lcs.size())),
+    ncols = 3 * nframes;
+  nthreads = GeographicLib::Utility::SetThreads(nthreads);
+  try {
+    GeographicLib::PointFile ifile, ofile;
+    std::vector<double> buf[3];
+    const double* src[3];
+    size_t n;
+    if (infile.empty()) {
+      double v[3];
+      while (std::cin >> v[0] >> v[1] >> v[2])
+	for (int k = 0; k < 3; ++k)
+	  buf[k].push_back(v[k]);
+      n = buf[0].size();
+      for (int k = 0; k < 3; ++k)
+	src[k] = n ? &buf[k][0] : 0;
+    } else {
+      ifile.Open(infile);
+      n = ifile.Size();
+      for (int k = 0; k < 3; ++k)
+	src[k] = ifile.Data(innames[k]);
+    }
+    std::vector<std::vector<double> > res;
+    std::vector<std::string> out;
+    if (outfile.empty()) {
+      res.resize(ncols);
+      for (int k = 0; k < ncols; ++k)
+	res[k].resize(blockpts);
+    } else {
+      std::ostringstream str;
+      for (int j = 0; j < nframes; ++j)
+	for (int k = 0; k < 3; ++k) {
+	  str << (j || k ? " " : "") << outnames[k];
+	  if (nframes > 1)
+	    str << j + 1;
+	}
+      ofile.Create(outfile, n, str.str(), false, &ifile);
+    }
+    std::vector<double*> rp(ncols);
+    for (size_t i0 = 0; i0 < n; i0 += blockpts) {
+      int m = int(std::min(size_t(blockpts), n - i0));
+      const double* vp[3] = {src[0] + i0, src[1] + i0, src[2] + i0};
+      for (int k = 0; k < ncols; ++k)
+	rp[k] = outfile.empty() ? &res[k][0] : ofile.Data(k) + i0;
+      for (int j = 0; j < nframes; ++j)
+	Convert(reverse, lcs, ec, j, m, vp, &rp[3 * j]);
+      if (outfile.empty())
+	Write(nthreads, ncols, m, &rp[0], out);
+    }
+    fflush(stdout);
+    ofile.Close();
+  }
+  catch (std::runtime_error& e) {
+    std::cerr << "ERROR: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
 int main(int argc, char* argv[]) {
-  bool localcartesian = false, reverse = false;
-  double latlonh0[3] = {0, 0, 0};
+  bool reverse = false, binary = false;
+  std::vector<double> origins;
+  int nthreads = -1;		// -1 = line at a time
+  std::string infile, outfile;
   for (int m = 1; m < argc; ++m) {
     std::string arg = std::string(argv[m]);
     if (arg == "-r")
       reverse = true;
     else if (arg == "-l") {
-      localcartesian = true;
       for (unsigned i = 0; i < 3; ++i) {
 	if (++m == argc) return usage(1);
 	std::string a = std::string(argv[m]);
 	std::istringstream str(a);
-	if (!(str >> latlonh0[i])) return usage(1);
+	double x;
+	if (!(str >> x)) return usage(1);
+	origins.push_back(x);
       }
+    } else if (arg == "-b")
+      binary = true;
+    else if (arg == "-j") {
+      if (++m == argc) return usage(1);
+      std::string a = std::string(argv[m]);
+      std::istringstream str(a);
+      if (!(str >> nthreads) || nthreads < 0) return usage(1);
+    } else if (arg == "-R") {
+      if (++m == argc) return usage(1);
+      infile = std::string(argv[m]);
+    } else if (arg == "-W") {
+      if (++m == argc) return usage(1);
+      outfile = std::string(argv[m]);
     } else
       return usage(arg != "-h");
   }
-  const GeographicLib::LocalCartesian lc(latlonh0[0], latlonh0[1], latlonh0[2]);
+  // Set up each local system once; an empty list means geocentric.
+  std::vector<GeographicLib::LocalCartesian> lcs(origins.size() / 3);
+  for (size_t j = 0; j < lcs.size(); ++j)
+    lcs[j].Reset(origins[3 * j], origins[3 * j + 1], origins[3 * j + 2]);
   const GeographicLib::Geocentric& ec = GeographicLib::Geocentric::WGS84;
+  if (!(infile.empty() && outfile.empty()))
+    return Files(infile, outfile, nthreads, reverse, lcs, ec);
+  if (binary)
+    return BinaryStream(nthreads, reverse, lcs, ec);
+  if (nthreads >= 0)
+    return Stream(nthreads, reverse, lcs, ec);
 
-  std::cout << std::setprecision(16);
-  while (true) {
-    double lat, lon, h, x, y, z;
-    if (reverse)
-      std::cin >> x >> y >> z;
-    else
-      std::cin >> lat >> lon >> h;
-    if (!std::cin.good())
-      break;
-    if (reverse) {
-      if (localcartesian)
-	lc.Reverse(x, y, z, lat, lon, h);
-      else
-	ec.Reverse(x, y, z, lat, lon, h);
-      std::cout << lat << " " << lon << " " << h << "\n";
-    } else {
-      if (localcartesian)
-	lc.Forward(lat, lon, h, x, y, z);
-      else
-	ec.Forward(lat, lon, h, x, y, z);
-      std::cout << x << " " << y << " " << z << "\n";
-    }
+  const int
+    nframes = std::max(1, int(lcs.size())),
+    ncols = 3 * nframes;
+  std::vector<double> res(ncols);
+  std::vector<double*> rp(ncols);
+  for (int k = 0; k < ncols; ++k)
+    rp[k] = &res[k];
+  double v[3];
+  const double* vp[3] = {&v[0], &v[1], &v[2]};
+  std::string os;
+  while (std::cin >> v[0] >> v[1] >> v[2]) {
+    for (int j = 0; j < nframes; ++j)
+      Convert(reverse, lcs, ec, j, 1, vp, &rp[3 * j]);
+    os.clear();
+    Format(ncols, &rp[0], 0, os);
+    std::cout << os << std::flush;
   }
   return 0;
 }
@@ -12,6 +12,7 @@
 #include <cmath>
 #include <stdexcept>
 #include <iomanip>
+#include <cstdio>
 
 namespace {
   char RCSID[] = "$Id: DMS.cpp 6572 2009-03-01 22:41:48Z ckarney $";
@@ -28,87 +29,137 @@ namespace GeographicLib {
   const string DMS::dmsindicators = "D'\"";
   const string DMS::components[] = {"degrees", "minutes", "seconds"};
 
-  double DMS::Decode(const std::string& dms, flag& ind) {
+  const signed char DMS::charclass[] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, 30, 30, 30, 30, 30, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    30, -1, 26, -1, -1, -1, -1, 25, -1, -1, -1, 21, -1, 20, 28, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, 24, 19, -1, -1, -1, -1, -1, -1, -1, -1, 17, -1,
+    -1, -1, -1, 16, -1, -1, -1, 18, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, 24, 19, -1, -1, -1, -1, -1, -1, -1, -1, 17, -1,
+    -1, -1, -1, 16, -1, -1, -1, 18, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+  };
+
+  const double DMS::pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+  };
+
+  double DMS::Fraction(const char* s, int n) {
+    // With at most 15 digits the numerator and denominator are exact and
+    // so the quotient is correctly rounded, the same as the result of
+    // reading the string.
+    if (n <= 16) {
+      double m = 0;
+      for (int i = 1; i < n; ++i)
+	m = 10 * m + (s[i] - '0');
+      return m / pow10[n - 1];
+    }
+    istringstream str(string(s, n));
+    double x;
+    str >> x;
+    return x;
+  }
+
+  int DMS::Parse(const char* dms, int len, double& angle, flag& ind,
+		 bool throwp) {
     double sign = 1;
-    unsigned
-      beg = 0,
-      end = unsigned(dms.size());
-    while (beg < end && isspace(dms[beg]))
+    int beg = 0, end = len;
+    while (beg < end && lookup(spaceclass, 1, dms[beg]) >= 0)
       ++beg;
-    while (beg < end && isspace(dms[end - 1]))
+    while (beg < end && lookup(spaceclass, 1, dms[end - 1]) >= 0)
       --end;
     ind = NONE;
     int k = -1;
-    if (end > beg && (k = lookup(hemispheres, dms[beg])) >= 0) {
+    if (end > beg && (k = lookup(hemisphereclass, 4, dms[beg])) >= 0) {
       ind = (k / 2) ? LONGITUDE : LATITUDE;
       sign = k % 2 ? 1 : -1;
       ++beg;
     }
-    if (end > beg && (k = lookup(hemispheres, dms[end-1])) >= 0) {
-      if (k >= 0) {
-	if (ind != NONE) {
-	  if (toupper(dms[beg - 1]) == toupper(dms[end - 1]))
-	    throw out_of_range("Repeated hemisphere indicators "
-			       + str(dms[beg - 1]) + " in "
-			       + dms.substr(beg - 1, end - beg + 1));
-	  else
-	    throw out_of_range("Contradictory hemisphere indicators "
-			       + str(dms[beg - 1]) + " and "
-			       + str(dms[end - 1]) + " in "
-			       + dms.substr(beg - 1, end - beg + 1));
-	}
-	ind = (k / 2) ? LONGITUDE : LATITUDE;
-	sign = k % 2 ? 1 : -1;
-	--end;
+    if (end > beg && (k = lookup(hemisphereclass, 4, dms[end - 1])) >= 0) {
+      if (ind != NONE) {
+	if (!throwp)
+	  return BADHEMISPHERE;
+	if (toupper(dms[beg - 1]) == toupper(dms[end - 1]))
+	  throw out_of_range("Repeated hemisphere indicators "
+			     + str(dms[beg - 1]) + " in "
+			     + string(dms + beg - 1, end - beg + 1));
+	else
+	  throw out_of_range("Contradictory hemisphere indicators "
+			     + str(dms[beg - 1]) + " and "
+			     + str(dms[end - 1]) + " in "
+			     + string(dms + beg - 1, end - beg + 1));
       }
+      ind = (k / 2) ? LONGITUDE : LATITUDE;
+      sign = k % 2 ? 1 : -1;
+      --end;
     }
-    if (end > beg && (k = lookup(signs, dms[beg])) >= 0) {
-      if (k >= 0) {
-	sign *= k ? 1 : -1;
-	++beg;
-      }
+    if (end > beg && (k = lookup(signclass, 2, dms[beg])) >= 0) {
+      sign *= k ? 1 : -1;
+      ++beg;
+    }
+    if (end == beg) {
+      if (!throwp)
+	return EMPTY;
+      throw out_of_range("Empty or incomplete DMS string "
+			 + string(dms, len));
     }
-    if (end == beg)
-      throw out_of_range("Empty or incomplete DMS string " + dms);
     double ipieces[] = {0, 0, 0};
     double fpieces[] = {0, 0, 0};
-    unsigned npiece = 0;
+    int npiece = 0;
     double icurrent = 0;
     double fcurrent = 0;
-    unsigned ncurrent = 0, p = beg;
+    int ncurrent = 0, p = beg;
     bool pointseen = false;
-    unsigned digcount = 0;
+    int digcount = 0;
     while (p < end) {
       char x = dms[p++];
-      if ((k = lookup(digits, x)) >= 0) {
+      int c = charclass[(unsigned char)(x)];
+      if (c >= 0 && c < 10) {
 	++ncurrent;
 	if (digcount > 0)
 	  ++digcount;		// Count of decimal digits
 	else
-	  icurrent = 10 * icurrent + k;
-      } else if (x == '.') {
-	if (pointseen)
+	  icurrent = 10 * icurrent + c;
+      } else if (c == pointclass) {
+	if (pointseen) {
+	  if (!throwp)
+	    return MULTIPLEPOINTS;
 	  throw out_of_range("Multiple decimal points in "
-			     + dms.substr(beg, end - beg));
+			     + string(dms + beg, end - beg));
+	}
 	pointseen = true;
 	digcount = 1;
-      } else if ((k = lookup(dmsindicators, x)) >= 0) {
-	if (unsigned(k) == npiece - 1)
-	  throw out_of_range("Repeated " + components[k]
-			     + " component in "
-			     + dms.substr(beg, end - beg));
-	else if (unsigned(k) < npiece)
-	  throw out_of_range(components[k] + " component follows "
-			     + components[npiece - 1] + " component in "
-			     + dms.substr(beg, end - beg));
-	if (ncurrent == 0)
+      } else if ((k = lookup(dmsindicatorclass, 3, x)) >= 0) {
+	if (k < npiece) {
+	  if (!throwp)
+	    return BADORDER;
+	  if (k == npiece - 1)
+	    throw out_of_range("Repeated " + components[k]
+			       + " component in "
+			       + string(dms + beg, end - beg));
+	  else
+	    throw out_of_range(components[k] + " component follows "
+			       + components[npiece - 1] + " component in "
+			       + string(dms + beg, end - beg));
+	}
+	if (ncurrent == 0) {
+	  if (!throwp)
+	    return MISSINGNUMBER;
 	  throw out_of_range("Missing numbers in " + components[k]
 			     + " component of "
-			     + dms.substr(beg, end - beg));
-	if (digcount > 1) {
-	  istringstream s(dms.substr(p-digcount-1, digcount));
-	  s >> fcurrent;
+			     + string(dms + beg, end - beg));
 	}
+	if (digcount > 1)
+	  fcurrent = Fraction(dms + p - digcount - 1, digcount);
 	ipieces[k] = icurrent;
 	fpieces[k] = icurrent + fcurrent;
 	if (p < end) {
@@ -116,80 +167,132 @@ namespace GeographicLib {
 	  icurrent = fcurrent = 0;
 	  ncurrent = digcount = 0;
 	}
-      } else if (lookup(signs, x) >= 0)
+      } else if (lookup(signclass, 2, x) >= 0) {
+	if (!throwp)
+	  return INTERNALSIGN;
 	throw out_of_range("Internal sign in DMS string "
-			   + dms.substr(beg, end - beg));
-      else
+			   + string(dms + beg, end - beg));
+      } else {
+	if (!throwp)
+	  return BADCHAR;
 	throw out_of_range("Illegal character " + str(x)
 			   + " in DMS string "
-			   + dms.substr(beg, end - beg));
+			   + string(dms + beg, end - beg));
+      }
     }
-    if (lookup(dmsindicators, dms[p - 1]) < 0) {
-      if (npiece >= 3)
+    if (lookup(dmsindicatorclass, 3, dms[p - 1]) < 0) {
+      if (npiece >= 3) {
+	if (!throwp)
+	  return EXTRATEXT;
 	throw out_of_range("Extra text following seconds in DMS string "
-			   + dms.substr(beg, end - beg));
-      if (ncurrent == 0)
-	throw out_of_range("Missing numbers in " + components[k]
+			   + string(dms + beg, end - beg));
+      }
+      if (ncurrent == 0) {
+	if (!throwp)
+	  return MISSINGNUMBER;
+	throw out_of_range("Missing numbers in " + components[npiece]
 			   + " component of "
-			   + dms.substr(beg, end - beg));
-      if (digcount > 1) {
-	istringstream s(dms.substr(p - digcount, digcount));
-	s >> fcurrent;
+			   + string(dms + beg, end - beg));
       }
+      if (digcount > 1)
+	fcurrent = Fraction(dms + p - digcount, digcount);
       ipieces[npiece] = icurrent;
       fpieces[npiece] = icurrent + fcurrent;
     }
-    if (pointseen && digcount == 0)
+    if (pointseen && digcount == 0) {
+      if (!throwp)
+	return NONTERMINALPOINT;
       throw out_of_range("Decimal point in non-terminal component of "
-			 + dms.substr(beg, end - beg));
+			 + string(dms + beg, end - beg));
+    }
     // Note that we accept 59.999999... even though it rounds to 60.
-    if (ipieces[1] >= 60)
+    if (ipieces[1] >= 60) {
+      if (!throwp)
+	return BADMINUTES;
       throw out_of_range("Minutes " + str(fpieces[1])
 			 + " not in range [0, 60)");
-    if (ipieces[2] >= 60)
+    }
+    if (ipieces[2] >= 60) {
+      if (!throwp)
+	return BADSECONDS;
       throw out_of_range("Seconds " + str(fpieces[2])
 			 + " not in range [0, 60)");
+    }
     // Assume check on range of result is made by calling routine (which might
     // be able to offer a better diagnostic).
-    return sign * (fpieces[0] + (fpieces[1] + fpieces[2] / 60) / 60);
+    angle = sign * (fpieces[0] + (fpieces[1] + fpieces[2] / 60) / 60);
+    return OK;
+  }
+
+  double DMS::Decode(const std::string& dms, flag& ind) {
+    double angle;
+    Parse(dms.data(), int(dms.size()), angle, ind, true);
+    return angle;
+  }
+
+  int DMS::Decode(const char* dms, int len, double& angle, flag& ind)
+    throw() {
+    return Parse(dms, len, angle, ind, false);
+  }
+
+  int DMS::ParseLatLon(const char* dmsa, int lena,
+		       const char* dmsb, int lenb,
+		       double& lat, double& lon, bool throwp) {
+    double a, b;
+    flag ia, ib;
+    int status;
+    if ((status = Parse(dmsa, lena, a, ia, throwp)) != OK ||
+	(status = Parse(dmsb, lenb, b, ib, throwp)) != OK)
+      return status;
+    if (ia == NONE && ib == NONE) {
+      // Default to lat, long
+      ia = LATITUDE;
+      ib = LONGITUDE;
+    } else if (ia == NONE)
+      ia = flag(LATITUDE + LONGITUDE - ib);
+    else if (ib == NONE)
+      ib = flag(LATITUDE + LONGITUDE - ia);
+    if (ia == ib) {
+      if (!throwp)
+	return SAMEAXIS;
+      throw out_of_range("Both " + string(dmsa, lena) + " and "
+			 + string(dmsb, lenb) + " interpreted as "
+			 + (ia == LATITUDE ? "latitudes" : "longitudes"));
+    }
+    double lat1 = ia == LATITUDE ? a : b, lon1 = ia == LATITUDE ? b : a;
+    if (! (lat1 >= -90 && lat1 <= 90)) {
+      if (!throwp)
+	return BADLATITUDE;
+      throw out_of_range("Latitude " + str(lat1) +
+			 "d not in [-90d, 90d]");
+    }
+    if (! (lon1 >= -180 && lon1 <= 360)) {
+      if (!throwp)
+	return BADLONGITUDE;
+      throw out_of_range("Latitude " + str(lon1) +
+			 "d not in [-180d, 360d]");
+    }
+    if (lon1 >= 180)
+      lon1 -= 360;
+    lat = lat1;
+    lon = lon1;
+    return OK;
   }
 
   void DMS::DecodeLatLon(const std::string& stra, const std::string& strb,
 			 double& lat, double& lon) {
-      double a, b;
-      flag ia, ib;
-      a = Decode(stra, ia);
-      b = Decode(strb, ib);
-      if (ia == NONE && ib == NONE) {
-	// Default to lat, long
-	ia = LATITUDE;
-	ib = LONGITUDE;
-      } else if (ia == NONE)
-	ia = flag(LATITUDE + LONGITUDE - ib);
-      else if (ib == NONE)
-	ib = flag(LATITUDE + LONGITUDE - ia);
-      if (ia == ib)
-	throw out_of_range("Both " + stra + " and " + strb +
-			   " interpreted as "
-			   + (ia == LATITUDE ? "latitudes"
-			      : "longitudes"));
-      if (ia == LATITUDE) {
-	lat = a; lon = b;
-      } else {
-	lat = b; lon = a;
-      }
-      if (! (lat >= -90 && lat <= 90))
-	throw out_of_range("Latitude " + str(lat) +
-			   "d not in [-90d, 90d]");
-      if (! (lon >= -180 && lon <= 360))
-	throw out_of_range("Latitude " + str(lon) +
-			   "d not in [-180d, 360d]");
-      if (lon >= 180)
-	lon -= 360;
+    ParseLatLon(stra.data(), int(stra.size()), strb.data(), int(strb.size()),
+		lat, lon, true);
   }
 
-  string DMS::Encode(double angle, component trailing, unsigned prec,
-		     flag ind) {
+  int DMS::DecodeLatLon(const char* dmsa, int lena,
+			const char* dmsb, int lenb,
+			double& lat, double& lon) throw() {
+    return ParseLatLon(dmsa, lena, dmsb, lenb, lat, lon, false);
+  }
+
+  int DMS::Split(double angle, component trailing, unsigned& prec,
+		 flag ind, double pieces[]) throw() {
     // Assume check on range of input angle has been made by calling
     // routine (which might be able to offer a better diagnostic).
     //
@@ -205,7 +308,7 @@ namespace GeographicLib {
       angle -= floor(angle/360) * 360;
     int sign = angle < 0 ? -1 : 1;
     angle *= sign;
-      
+
     // Break off integer part to preserve precision in manipulation of
     // fractional part.
     double
@@ -215,7 +318,8 @@ namespace GeographicLib {
       idegree += 1;
       fdegree -= 1;
     }
-    double pieces[3] = {fdegree, 0, 0};
+    pieces[0] = fdegree;
+    pieces[1] = pieces[2] = 0;
     for (unsigned i = 1; i <= unsigned(trailing); ++i) {
       double
 	ip = floor(pieces[i - 1]),
@@ -224,6 +328,11 @@ namespace GeographicLib {
       pieces[i - 1] = ip;
     }
     pieces[0] += idegree;
+    return sign;
+  }
+
+  string DMS::Format(int sign, const double pieces[], component trailing,
+		     unsigned prec, flag ind) {
     ostringstream s;
     s << fixed  << setfill('0');
     if (ind == NONE && sign < 0)
@@ -257,4 +366,69 @@ namespace GeographicLib {
     return s.str();
   }
 
+  int DMS::Encode(double angle, component trailing, unsigned prec, flag ind,
+		  char dms[]) {
+    double pieces[3];
+    int sign = Split(angle, trailing, prec, ind, pieces);
+    if (!(pieces[0] < 1e9)) {
+      // Too large (or not finite) for the buffer; format with iostreams and
+      // copy the result if it fits.
+      string s = Format(sign, pieces, trailing, prec, ind);
+      int n = int(s.size());
+      if (n >= int(bufsize)) {
+	dms[0] = '\0';
+	return -1;
+      }
+      copy(s.begin(), s.end(), dms);
+      dms[n] = '\0';
+      return n;
+    }
+    // The same formatting as Format with printf "%0*.*f" in place of
+    // setfill('0') << setw << setprecision.
+    char* p = dms;
+    if (ind == NONE && sign < 0)
+      *p++ = '-';
+    int
+      w = ind != NONE ? 1 + min(int(ind), 2) : 0,
+      wfrac = 2 + prec + (prec ? 1 : 0);
+    switch (trailing) {
+    case DEGREE:
+      p += sprintf(p, "%0*.*f", w ? w + int(prec) + (prec ? 1 : 0) : 0,
+		   int(prec), pieces[0]);
+      break;
+    default:
+      p += sprintf(p, "%0*.0f", w, pieces[0]);
+      *p++ = char(tolower(dmsindicators[0]));
+      switch (trailing) {
+      case MINUTE:
+	p += sprintf(p, "%0*.*f", wfrac, int(prec), pieces[1]);
+	*p++ = char(tolower(dmsindicators[1]));
+	break;
+      case SECOND:
+	p += sprintf(p, "%02.0f", pieces[1]);
+	*p++ = char(tolower(dmsindicators[1]));
+	p += sprintf(p, "%0*.*f", wfrac, int(prec), pieces[2]);
+	*p++ = char(tolower(dmsindicators[2]));
+	break;
+      default:
+	break;
+      }
+    }
+    if (ind != NONE && ind != AZIMUTH)
+      *p++ = hemispheres[(ind == LATITUDE ? 0 : 2) + (sign < 0 ? 0 : 1)];
+    *p = '\0';
+    return int(p - dms);
+  }
+
+  string DMS::Encode(double angle, component trailing, unsigned prec,
+		     flag ind) {
+    char dms[bufsize];
+    int n = Encode(angle, trailing, prec, ind, dms);
+    if (n >= 0)
+      return string(dms, n);
+    double pieces[3];
+    int sign = Split(angle, trailing, prec, ind, pieces);
+    return Format(sign, pieces, trailing, prec, ind);
+  }
+
 } // namespace GeographicLib
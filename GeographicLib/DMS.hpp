@@ -24,10 +24,6 @@ namespace GeographicLib {
    **********************************************************************/
   class DMS {
   private:
-    static int lookup(const std::string& s, char c) throw() {
-      std::string::size_type r = s.find(toupper(c));
-      return r == std::string::npos ? -1 : int(r);
-    }
     template<typename T> static std::string str(T x) {
       std::ostringstream s; s << x; return s.str();
     }
@@ -36,6 +32,25 @@ namespace GeographicLib {
     static const std::string digits;
     static const std::string dmsindicators;
     static const std::string components[3];
+    // Character classes for Decode.  Digits map to their values; the
+    // characters of hemispheres (either case), signs, and dmsindicators
+    // (either case) map to the class plus their index in the string.
+    enum {
+      hemisphereclass = 16,
+      signclass = 20,
+      dmsindicatorclass = 24,
+      pointclass = 28,
+      spaceclass = 30
+    };
+    static const signed char charclass[256];
+    static int lookup(int cls, int n, char c) throw() {
+      int k = charclass[(unsigned char)(c)] - cls;
+      return k >= 0 && k < n ? k : -1;
+    }
+    // Exact powers of ten
+    static const double pow10[16];
+    // Parse the n chars at s, a decimal point followed by digits.
+    static double Fraction(const char* s, int n);
 
   public:
 
@@ -51,6 +66,53 @@ namespace GeographicLib {
      **********************************************************************/
     enum component { DEGREE = 0, MINUTE = 1, SECOND = 2 };
 
+    /**
+     * Status codes returned by the non-throwing versions of Decode and
+     * DecodeLatLon.
+     **********************************************************************/
+    enum status {
+      OK = 0,			// Success
+      EMPTY = 1,		// Empty or incomplete string
+      BADHEMISPHERE = 2,	// Repeated or contradictory hemispheres
+      MULTIPLEPOINTS = 3,	// More than one decimal point
+      BADORDER = 4,		// Repeated or out of order components
+      MISSINGNUMBER = 5,	// Component without a number
+      INTERNALSIGN = 6,		// Sign not at the start
+      BADCHAR = 7,		// Illegal character
+      EXTRATEXT = 8,		// Text following the seconds
+      NONTERMINALPOINT = 9,	// Decimal point in non-terminal component
+      BADMINUTES = 10,		// Minutes not in [0, 60)
+      BADSECONDS = 11,		// Seconds not in [0, 60)
+      SAMEAXIS = 12,		// Two latitudes or two longitudes
+      BADLATITUDE = 13,		// Latitude not in [-90d, 90d]
+      BADLONGITUDE = 14		// Longitude not in [-180d, 360d]
+    };
+
+    /**
+     * Size of a char array which can hold the result of the char array
+     * versions of Encode for angles less than 10<sup>9</sup> degrees in
+     * magnitude (with any \e prec).
+     **********************************************************************/
+    enum { bufsize = 40 };
+
+  private:
+    // The parsing for Decode and DecodeLatLon.  On failure throw an error if
+    // throwp, otherwise return the status code.
+    static int Parse(const char* dms, int len, double& angle, flag& ind,
+		     bool throwp);
+    static int ParseLatLon(const char* dmsa, int lena,
+			   const char* dmsb, int lenb,
+			   double& lat, double& lon, bool throwp);
+    // Round angle and split it into degrees, minutes, and seconds; return
+    // the sign.
+    static int Split(double angle, component trailing, unsigned& prec,
+		     flag ind, double pieces[]) throw();
+    // Format the pieces with iostreams.
+    static std::string Format(int sign, const double pieces[],
+			      component trailing, unsigned prec, flag ind);
+
+  public:
+
     /**
      * Read a string \e dms in DMS format and return the resulting angle in
      * degrees.  Degrees, minutes, and seconds are indicated by the letters d,
@@ -110,6 +172,54 @@ namespace GeographicLib {
 		    prec < 2 ? prec : (prec < 4 ? prec - 2 : prec - 4),
 		    ind);
     }
+
+    /**
+     * Parse the \e len chars at \e dms (which need not be null terminated)
+     * setting \e angle to the resulting angle in degrees.  This is the same
+     * as the std::string version of Decode except that it returns a status
+     * code (DMS::OK on success) instead of throwing an error.  The
+     * characters are classified by table lookup and no heap allocation is
+     * done (except for fractions with more than 15 digits).
+     **********************************************************************/
+    static int Decode(const char* dms, int len, double& angle, flag& ind)
+      throw();
+
+    /**
+     * The same as the std::string version of DecodeLatLon except that the
+     * strings are given as char arrays with lengths and that a status code is
+     * returned instead of throwing an error.
+     **********************************************************************/
+    static int DecodeLatLon(const char* dmsa, int lena,
+			    const char* dmsb, int lenb,
+			    double& lat, double& lon) throw();
+
+    /**
+     * Convert \e degree into a DMS string written as a null terminated string
+     * into \e dms, which must hold at least DMS::bufsize chars, and return
+     * its length.  The result is the same as the std::string version of
+     * Encode.  Return -1 if the result does not fit into DMS::bufsize chars
+     * (only possible if |\e degree| >= 10<sup>9</sup> or is not finite).  No
+     * heap allocation is done unless \e degree is this large.
+     **********************************************************************/
+    static int Encode(double degree,
+		      component trailing,
+		      unsigned prec,
+		      flag ind,
+		      char dms[]);
+
+    /**
+     * Convert \e degree into a DMS string written into a char array
+     * selecting the trailing component based on \e prec.
+     **********************************************************************/
+    static int Encode(double degree,
+		      unsigned prec,
+		      flag ind,
+		      char dms[]) {
+      return Encode(degree,
+		    prec < 2 ? DEGREE : (prec < 4 ? MINUTE : SECOND),
+		    prec < 2 ? prec : (prec < 4 ? prec - 2 : prec - 4),
+		    ind, dms);
+    }
   };
 
 } // namespace GeographicLib
@@ -22,14 +22,6 @@ namespace GeographicLib {
 
   using namespace std;
 
-  const double EllipticFunction::tol =
-    numeric_limits<double>::epsilon() * 0.01;
-  const double EllipticFunction::tolRF = pow(3 * tol, 1/6.0);
-  const double EllipticFunction::tolRD = pow(0.25 * tol, 1/6.0);
-  const double EllipticFunction::tolRG0 = 2.7 * sqrt(tol);
-  const double EllipticFunction::tolJAC = sqrt(tol);
-  const double EllipticFunction::tolJAC1 = sqrt(6 * tol);
-
   /*
    * Implementation of methods given in
    *
@@ -43,7 +35,7 @@ namespace GeographicLib {
     double
       a0 = (x + y + z)/3,
       an = a0,
-      q = max(max(abs(a0-x), abs(a0-y)), abs(a0-z)) / tolRF,
+      q = max(max(abs(a0-x), abs(a0-y)), abs(a0-z)) / tolRF(),
       x0 = x,
       y0 = y,
       z0 = z,
@@ -72,7 +64,7 @@ namespace GeographicLib {
     double
       a0 = (x + y + 3 * z)/5,
       an = a0,
-      q = max(max(abs(a0-x), abs(a0-y)), abs(a0-z)) / tolRD,
+      q = max(max(abs(a0-x), abs(a0-y)), abs(a0-z)) / tolRD(),
       x0 = x,
       y0 = y,
       z0 = z,
@@ -112,7 +104,7 @@ namespace GeographicLib {
       yn = y0,
       s = 0,
       mul = 0.25;
-    while (abs(xn-yn) >= tolRG0 * abs(xn)) {
+    while (abs(xn-yn) >= tolRG0() * abs(xn)) {
       // Max 4 trips
       double t = (xn + yn) /2;
       yn = sqrt(xn * yn);
@@ -128,8 +120,8 @@ namespace GeographicLib {
   EllipticFunction::EllipticFunction(double m) throw()
     : _m(m)
     , _m1(1 - m)
-      // Don't initialize _kc, _ec, _kec since this constructor might be called
-      // before the static double constants tolRF, etc., are initialized.
+      // Don't compute _kc, _ec, _kec until they are needed, so that
+      // constructing TransverseMercatorExact::UTM at startup is cheap.
     , _init(false)
   {}
 
@@ -168,7 +160,7 @@ namespace GeographicLib {
 	m[l] = a;
 	n[l] = mc = sqrt(mc);
 	c = (a + mc) / 2;
-	if (abs(a - mc) <= tolJAC * a) {
+	if (abs(a - mc) <= tolJAC() * a) {
 	  ++l;
 	  break;
 	}
@@ -201,7 +193,7 @@ namespace GeographicLib {
 
   double EllipticFunction::E(double sn, double cn, double dn) const throw() {
     double ei;
-    if (abs(sn) > tolJAC1) {
+    if (abs(sn) > tolJAC1()) {
       double
 	s = 1 / sn,
 	c = cn * s,
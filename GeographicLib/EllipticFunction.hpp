@@ -9,6 +9,9 @@
 #if !defined(ELLIPTICFUNCTION_HPP)
 #define ELLIPTICFUNCTION_HPP "$Id: EllipticFunction.hpp 6535 2009-02-10 22:37:07Z ckarney $"
 
+#include <cmath>
+#include <limits>
+
 
 namespace GeographicLib {
 
@@ -39,7 +42,14 @@ namespace GeographicLib {
    **********************************************************************/
   class EllipticFunction {
   private:
-    static const double tol, tolRF, tolRD, tolRG0, tolJAC, tolJAC1;
+    static inline double tol() throw()
+    { return std::numeric_limits<double>::epsilon() * 0.01; }
+    static inline double tolRF() throw() { return std::pow(3 * tol(), 1/6.0); }
+    static inline double tolRD() throw()
+    { return std::pow(0.25 * tol(), 1/6.0); }
+    static inline double tolRG0() throw() { return 2.7 * std::sqrt(tol()); }
+    static inline double tolJAC() throw() { return std::sqrt(tol()); }
+    static inline double tolJAC1() throw() { return std::sqrt(6 * tol()); }
     enum { num = 10 }; // Max depth required for sncndn.  Probably 5 is enough.
     static double RF(double x, double y, double z) throw();
     static double RD(double x, double y, double z) throw();
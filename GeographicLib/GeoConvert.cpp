@@ -8,7 +8,7 @@
  *
  * Compile with
  *
- *   g++ -g -O3 -I.. -o GeoConvert GeoConvert.cpp GeoCoords.cpp MGRS.cpp UTMUPS.cpp DMS.cpp Constants.cpp TransverseMercator.cpp PolarStereographic.cpp
+ *   g++ -g -O3 -I.. -o GeoConvert GeoConvert.cpp GeoCoords.cpp MGRS.cpp UTMUPS.cpp DMS.cpp Constants.cpp TransverseMercator.cpp PolarStereographic.cpp PointFile.cpp Utility.cpp
  *
  * See \ref geoconvert for usage information.
  **********************************************************************/
@@ -18,11 +18,19 @@
 #include <string>
 #include <stdexcept>
 #include <iomanip>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <limits>
 #include "GeographicLib/GeoCoords.hpp"
+#include "GeographicLib/PointFile.hpp"
+#include "GeographicLib/Utility.hpp"
 
 int usage(int retval) {
   ( retval ? std::cerr : std::cout ) <<
-"Usage: GeoConvert [-g|-d|-u|-m|-c] [-p prec] [-z zone] [-s] [-h]\n\
+"Usage: GeoConvert [-g|-d|-u|-m|-c] [-p prec] [-z zone] [-s] [-j threads]\n\
+                  [-R file] [-W file] [-h]\n\
 $Id: GeoConvert.cpp 6559 2009-02-28 16:49:53Z ckarney $\n\
 \n\
 Convert geographic coordinates to\n\
@@ -85,6 +93,13 @@ the standard zone.\n\
 \n\
 -s uses the standard zone.\n\
 \n\
+-j threads selects a streaming mode for large inputs.  Standard input is\n\
+read in large blocks, the lines of each block are converted by the given\n\
+number of threads (0 means use all the processors), and the output is\n\
+written in the original order with buffered output (instead of being\n\
+flushed after each line).  There is still one line of output (possibly\n\
+an ERROR) for each line of input.\n\
+\n\
 For example, the point\n\
 \n\
     79.9S 6.1E\n\
@@ -101,15 +116,311 @@ then\n\
     echo 31CEM6066227959 | GeoConvert -p -3 -m -s    ==> 32CMS4328\n\
     echo 31CEM6066227959 | GeoConvert -p -3 -m -z 0  ==>   BBZ1917\n\
 \n\
+-R file reads the points from a point file instead of standard input.\n\
+This is a memory mapped binary file with named columns of doubles and an\n\
+optional column of zones (see the documentation of PointFile); its\n\
+points are converted without any parsing and are split between threads\n\
+as with -j.  The file must contain either lat and lon columns or easting\n\
+and northing columns and zones.\n\
+\n\
+-W file writes the results to a point file instead of standard output.\n\
+Its columns are lat and lon for -g and -d, easting and northing and the\n\
+zones for -u, and gamma and k for -c (MGRS output cannot be written to a\n\
+point file).  The values for points which cannot be converted are NaNs.\n\
+\n\
 -h prints this help.\n";
   return retval;
 }
 
+enum { GEOGRAPHIC, DMS, UTMUPS, MGRS, CONVERGENCE };
+
+// Append the representation of p to os.
+void Output(const GeographicLib::GeoCoords& p, int outputmode, int prec,
+	    std::string& os) {
+  switch (outputmode) {
+  case GEOGRAPHIC:
+    os += p.GeoRepresentation(prec);
+    break;
+  case DMS:
+    os += p.DMSRepresentation(prec);
+    break;
+  case UTMUPS:
+    os += p.AltUTMUPSRepresentation(prec);
+    break;
+  case MGRS:
+    os += p.AltMGRSRepresentation(prec);
+    break;
+  case CONVERGENCE:
+    {
+      double
+	gamma = p.AltConvergence(),
+	k = p.AltScale();
+      char buf[64];
+      int n = sprintf(buf, "%.*f %.*f",
+		      std::max(-5, std::min(8, prec)) + 5, gamma,
+		      std::max(-5, std::min(8, prec)) + 7, k);
+      os.append(buf, n);
+    }
+  }
+}
+
+// Convert the len chars at s, appending the result (or an error message) to
+// os.  Return false on error.
+bool Convert(GeographicLib::GeoCoords& p, const char* s, int len,
+	     int outputmode, int prec, int zone, std::string& os) {
+  try {
+    if (p.Parse(s, len) != GeographicLib::GeoCoords::OK)
+      // Repeat with Reset which throws an error with a diagnostic message.
+      p.Reset(std::string(s, len));
+    if (zone != -2)
+      p.SetAltZone(zone);
+    Output(p, outputmode, prec, os);
+  }
+  catch (std::out_of_range& e) {
+    // Write error message cout so output lines match input lines
+    os += "ERROR: ";
+    os += e.what();
+    return false;
+  }
+  return true;
+}
+
+// Convert standard input in blocks of lines using nthreads threads.  Return
+// 1 if there were any errors.
+int Stream(int nthreads, int outputmode, int prec, int zone) {
+  nthreads = GeographicLib::Utility::SetThreads(nthreads);
+  // Don't give a thread fewer lines than this
+  const int minlines = 1000;
+  GeographicLib::Utility::LineBlocks input(stdin);
+  std::vector<std::string> out(nthreads);
+  int retval = 0;
+  while (input.Next()) {
+    int
+      nlines = input.Lines(),
+      nt = std::max(1, std::min(nthreads, nlines / minlines)),
+      err = 0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static) reduction(|:err)
+#endif
+    for (int t = 0; t < nt; ++t) {
+      GeographicLib::GeoCoords p;
+      std::string& os = out[t];
+      os.clear();
+      int
+	i0 = int(double(nlines) * t / nt),
+	i1 = int(double(nlines) * (t + 1) / nt);
+      for (int i = i0; i < i1; ++i) {
+	if (!Convert(p, input.Line(i), input.Length(i),
+		     outputmode, prec, zone, os))
+	  err = 1;
+	os += '\n';
+      }
+    }
+    if (err)
+      retval = 1;
+    for (int t = 0; t < nt; ++t)
+      fwrite(out[t].data(), 1, out[t].size(), stdout);
+  }
+  fflush(stdout);
+  return retval;
+}
+
+// The names of the point file columns for outputmode (0 for MGRS which
+// can't be written to a point file).
+const char* ColumnNames(int outputmode) {
+  switch (outputmode) {
+  case GEOGRAPHIC:
+  case DMS:
+    return "lat lon";
+  case UTMUPS:
+    return "easting northing";
+  case CONVERGENCE:
+    return "gamma k";
+  default:
+    return 0;
+  }
+}
+
+// Set a and b to the quantities written to a point file for p and return
+// its zone byte.
+unsigned char Values(const GeographicLib::GeoCoords& p, int outputmode,
+		     double& a, double& b) {
+  switch (outputmode) {
+  case UTMUPS:
+    a = p.AltEasting();
+    b = p.AltNorthing();
+    return GeographicLib::PointFile::ZoneByte(p.AltZone(), p.Northp());
+  case CONVERGENCE:
+    a = p.AltConvergence();
+    b = p.AltScale();
+    break;
+  default:
+    a = p.Latitude();
+    b = p.Longitude();
+  }
+  return GeographicLib::PointFile::nozone;
+}
+
+// The input columns of a point file, either latitudes and longitudes or
+// eastings, northings, and zones.
+struct PointColumns {
+  const double *lat, *lon, *x, *y;
+  const unsigned char* zones;
+  explicit PointColumns(const GeographicLib::PointFile& in)
+    : lat(0), lon(0), x(0), y(0), zones(in.Zones()) {
+    if (in.Find("lat") >= 0 && in.Find("lon") >= 0) {
+      lat = in.Data("lat");
+      lon = in.Data("lon");
+    } else if (zones && in.Find("easting") >= 0 && in.Find("northing") >= 0) {
+      x = in.Data("easting");
+      y = in.Data("northing");
+    } else
+      throw std::runtime_error("Point file needs lat and lon columns or "
+			       "easting and northing columns and zones");
+  }
+  // Set p to point i.  Throw an error if it is illegal.
+  void Reset(GeographicLib::GeoCoords& p, size_t i) const {
+    if (lat)
+      p.Reset(lat[i], lon[i]);
+    else {
+      int zone;
+      bool northp;
+      if (!GeographicLib::PointFile::DecodeZone(zones[i], zone, northp))
+	throw std::out_of_range("Point has no zone");
+      p.Reset(zone, northp, x[i], y[i]);
+    }
+  }
+};
+
+// Convert the points in the point file infile (or standard input if infile
+// is empty) writing the results to the point file outfile (or standard
+// output if outfile is empty).  Return 1 if there were any errors.
+int Files(const std::string& infile, const std::string& outfile,
+	  int nthreads, int outputmode, int prec, int zone) {
+  if (!outfile.empty() && !ColumnNames(outputmode)) {
+    std::cerr << "ERROR: MGRS output cannot be written to a point file\n";
+    return 1;
+  }
+  nthreads = GeographicLib::Utility::SetThreads(nthreads);
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  int retval = 0;
+  try {
+    GeographicLib::PointFile in, out;
+    if (infile.empty()) {
+      // Collect the results for the lines of standard input, then write
+      // them all out.
+      std::vector<double> a, b;
+      std::vector<unsigned char> z;
+      GeographicLib::GeoCoords p;
+      std::string s;
+      while (std::getline(std::cin, s)) {
+	double x = nan, y = nan;
+	unsigned char zb = GeographicLib::PointFile::nozone;
+	try {
+	  if (p.Parse(s.data(), int(s.size())) != GeographicLib::GeoCoords::OK)
+	    p.Reset(s);
+	  if (zone != -2)
+	    p.SetAltZone(zone);
+	  zb = Values(p, outputmode, x, y);
+	}
+	catch (std::out_of_range&) {
+	  x = y = nan;
+	  zb = GeographicLib::PointFile::nozone;
+	  retval = 1;
+	}
+	a.push_back(x);
+	b.push_back(y);
+	z.push_back(zb);
+      }
+      size_t n = a.size();
+      out.Create(outfile, n, ColumnNames(outputmode), outputmode == UTMUPS);
+      if (n) {
+	std::copy(a.begin(), a.end(), out.Data(0));
+	std::copy(b.begin(), b.end(), out.Data(1));
+	if (out.HasZones())
+	  std::copy(z.begin(), z.end(), out.Zones());
+      }
+      out.Close();
+      return retval;
+    }
+    in.Open(infile);
+    const PointColumns cols(in);
+    size_t n = in.Size();
+    bool text = outfile.empty();
+    if (!text)
+      out.Create(outfile, n, ColumnNames(outputmode), outputmode == UTMUPS,
+		 &in);
+    double
+      *a = text ? 0 : out.Data(0),
+      *b = text ? 0 : out.Data(1);
+    unsigned char* z = text ? 0 : out.Zones();
+    // Don't give a thread fewer points than this; the text output is
+    // written after each block of points.
+    const int minpoints = 1000, blocksize = 1 << 16;
+    std::vector<std::string> os(nthreads);
+    for (size_t i0 = 0; i0 < n; i0 += blocksize) {
+      int
+	m = int(std::min(size_t(blocksize), n - i0)),
+	nt = std::max(1, std::min(nthreads, m / minpoints)),
+	err = 0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static) reduction(|:err)
+#endif
+      for (int t = 0; t < nt; ++t) {
+	GeographicLib::GeoCoords p;
+	std::string& s = os[t];
+	s.clear();
+	size_t
+	  j0 = i0 + size_t(double(m) * t / nt),
+	  j1 = i0 + size_t(double(m) * (t + 1) / nt);
+	for (size_t i = j0; i < j1; ++i) {
+	  try {
+	    cols.Reset(p, i);
+	    if (zone != -2)
+	      p.SetAltZone(zone);
+	    if (text)
+	      Output(p, outputmode, prec, s);
+	    else {
+	      unsigned char zb = Values(p, outputmode, a[i], b[i]);
+	      if (z)
+		z[i] = zb;
+	    }
+	  }
+	  catch (std::out_of_range& e) {
+	    if (text) {
+	      s += "ERROR: ";
+	      s += e.what();
+	    } else
+	      a[i] = b[i] = nan;
+	    err = 1;
+	  }
+	  if (text)
+	    s += '\n';
+	}
+      }
+      if (err)
+	retval = 1;
+      if (text)
+	for (int t = 0; t < nt; ++t)
+	  fwrite(os[t].data(), 1, os[t].size(), stdout);
+    }
+    if (text)
+      fflush(stdout);
+    out.Close();
+  }
+  catch (std::runtime_error& e) {
+    std::cerr << "ERROR: " << e.what() << "\n";
+    return 1;
+  }
+  return retval;
+}
+
 int main(int argc, char* argv[]) {
-  enum { GEOGRAPHIC, DMS, UTMUPS, MGRS, CONVERGENCE };
   int outputmode = GEOGRAPHIC;
   int prec = 0;
   int zone = -2;		// -2 = track input, -1 = standard
+  int nthreads = -1;		// -1 = line at a time
+  std::string infile, outfile;
 
   for (int m = 1; m < argc; ++m) {
     std::string arg = std::string(argv[m]);
@@ -135,7 +446,18 @@ int main(int argc, char* argv[]) {
       if (!(str >> zone)) return usage(1);
     } else if (arg == "-s")
       zone = -1;
-    else
+    else if (arg == "-j") {
+      if (++m == argc) return usage(1);
+      std::string a = std::string(argv[m]);
+      std::istringstream str(a);
+      if (!(str >> nthreads) || nthreads < 0) return usage(1);
+    } else if (arg == "-R") {
+      if (++m == argc) return usage(1);
+      infile = std::string(argv[m]);
+    } else if (arg == "-W") {
+      if (++m == argc) return usage(1);
+      outfile = std::string(argv[m]);
+    } else
       return usage(arg != "-h");
   }
 
@@ -147,43 +469,14 @@ int main(int argc, char* argv[]) {
     std::cerr << "Zone " << zone << "not in [0, 60]\n";
     return 1;
   }
+  if (!(infile.empty() && outfile.empty()))
+    return Files(infile, outfile, nthreads, outputmode, prec, zone);
+  if (nthreads >= 0)
+    return Stream(nthreads, outputmode, prec, zone);
   while (std::getline(std::cin, s)) {
-    try {
-      p.Reset(s);
-      if (zone != -2)
-	p.SetAltZone(zone);
-      switch (outputmode) {
-      case GEOGRAPHIC:
-	os = p.GeoRepresentation(prec);
-	break;
-      case DMS:
-	os = p.DMSRepresentation(prec);
-	break;
-      case UTMUPS:
-	os = p.AltUTMUPSRepresentation(prec);
-	break;
-      case MGRS:
-	os = p.AltMGRSRepresentation(prec);
-	break;
-      case CONVERGENCE:
-	{
-	  double
-	    gamma = p.AltConvergence(),
-	    k = p.AltScale();
-	  std::ostringstream ss;
-	  ss << std::fixed
-	     << std::setprecision(std::max(-5, std::min(8, prec)) + 5) << gamma
-	     << " "
-	     << std::setprecision(std::max(-5, std::min(8, prec)) + 7) << k;
-	  os = ss.str();
-	}
-      }
-    }
-    catch (std::out_of_range& e) {
-      // Write error message cout so output lines match input lines
-      os = std::string("ERROR: ") + e.what();
+    os.clear();
+    if (!Convert(p, s.data(), int(s.size()), outputmode, prec, zone, os))
       retval = 1;
-    }
     std::cout << os << std::endl;
   }
   return retval;
@@ -7,11 +7,11 @@
  * and licensed under the LGPL.
  **********************************************************************/
 
-#include <vector>
 #include <sstream>
 #include <stdexcept>
 #include <iomanip>
 #include <cerrno>
+#include <algorithm>
 #include "GeographicLib/GeoCoords.hpp"
 #include "GeographicLib/MGRS.hpp"
 #include "GeographicLib/DMS.hpp"
@@ -25,108 +25,266 @@ namespace GeographicLib {
 
   using namespace std;
 
-  void GeoCoords::Reset(const std::string& s) {
-    vector<string> sa;
-    bool in = false;
-    for (unsigned i = 0; i < s.size(); ++i) {
-      if (isspace(s[i]) || s[i] == ',') {
-	in = false;
+  int GeoCoords::Split(const char* s, int len,
+			const char* el[], int ellen[]) throw() {
+    int n = 0;
+    for (int i = 0; i < len;) {
+      if (isspace((unsigned char)s[i]) || s[i] == ',') {
+	++i;
 	continue;
       }
-      if (!in)
-	sa.push_back("");
-      in = true;
-      sa.back().push_back(s[i]);
+      int j = i;
+      while (j < len && !(isspace((unsigned char)s[j]) || s[j] == ','))
+	++j;
+      if (n < 3) {
+	el[n] = s + i;
+	ellen[n] = j - i;
+      }
+      ++n;
+      i = j;
+    }
+    return n;
+  }
+
+  int GeoCoords::ZoneDesignator(const char* s, int len,
+				int& zone, bool& northp, bool throwp) {
+    char hemi = char(toupper((unsigned char)s[len - 1]));
+    northp = hemi == 'N';
+    if (! (northp || hemi == 'S')) {
+      if (!throwp)
+	return BADZONE;
+      throw out_of_range(string("Illegal hemisphere letter ") + hemi
+			 + " in " + string(s, len));
+    }
+    // Parse the zone number as strtol does (but without needing a null
+    // terminated string).
+    int i = 0, sign = 1;
+    if (len > 1 && (s[0] == '+' || s[0] == '-')) {
+      sign = s[0] == '-' ? -1 : 1;
+      ++i;
+    }
+    int j = i;
+    zone = 0;
+    for (; j < len - 1 && isdigit((unsigned char)s[j]); ++j)
+      if (zone < 1000)		// No legal zone has this many digits
+	zone = 10 * zone + (s[j] - '0');
+    zone *= sign;
+    // Number of chars consumed by strtol
+    int q = j > i ? j : 0;
+    if (q != len - 1) {
+      if (!throwp)
+	return BADZONE;
+      throw out_of_range("Extra text in UTM/UPS zone " + string(s, len));
+    }
+    if (q > 0 && zone == 0) {
+      // Don't allow 0N as an alternative to N for UPS coordinates
+      if (!throwp)
+	return BADZONE;
+      throw out_of_range("Illegal zone 0 in " + string(s, len));
     }
-    if (sa.size() == 1) {
+    return OK;
+  }
+
+  int GeoCoords::Coordinate(const char* s, int len, int i, double& x,
+			    bool throwp) {
+    // strtod needs a null terminated string; copy into a buffer on the stack
+    // unless the number is absurdly long.
+    char buf[64];
+    string str;
+    const char* c;
+    if (len < int(sizeof(buf))) {
+      copy(s, s + len, buf);
+      buf[len] = '\0';
+      c = buf;
+    } else {
+      str = string(s, len);
+      c = str.c_str();
+    }
+    char* q;
+    errno = 0;
+    x = strtod(c, &q);
+    if (errno ==  ERANGE || !isfinite(x)) {
+      if (!throwp)
+	return BADNUMBER;
+      throw out_of_range("Number " + string(s, len) + " out of range");
+    }
+    if (q - c != len) {
+      if (!throwp)
+	return BADNUMBER;
+      throw out_of_range(string("Extra text in UTM/UPS ") +
+			 (i == 0 ? "easting " : "northing ") +
+			 string(s, len));
+    }
+    return OK;
+  }
+
+  int GeoCoords::Decode(const char* s, int len, bool throwp) {
+    const char* el[3];
+    int ellen[3];
+    int n = Split(s, len, el, ellen);
+    double lat, lon, easting, northing, gamma, k;
+    bool northp, utmvalid = true;
+    int zone;
+    if (n == 1) {
       int prec;
-      MGRS::Reverse(sa[0], _zone, _northp, _easting, _northing, prec);
-      UTMUPS::Reverse(_zone, _northp, _easting, _northing,
-		      _lat, _long, _gamma, _k);
-    } else if (sa.size() == 2) {
-      DMS::DecodeLatLon(sa[0], sa[1], _lat, _long);
-      UTMUPS::Forward( _lat, _long,
-		       _zone, _northp, _easting, _northing, _gamma, _k);
-    } else if (sa.size() == 3) {
-      unsigned zoneind, coordind;
-      if (sa[0].size() > 0 && isalpha(sa[0][sa[0].size() - 1])) {
+      if (MGRS::Reverse(el[0], ellen[0], zone, northp, easting, northing, prec)
+	  != MGRS::OK) {
+	if (throwp)
+	  // Repeat with the std::string version to get the error message
+	  MGRS::Reverse(string(el[0], ellen[0]),
+			zone, northp, easting, northing, prec);
+	return BADMGRS;
+      }
+      if (!UTMUPS::DoReverse(zone, northp, easting, northing,
+			     lat, lon, gamma, k, throwp))
+	return OUTOFRANGE;
+    } else if (n == 2) {
+      if (DMS::DecodeLatLon(el[0], ellen[0], el[1], ellen[1], lat, lon)
+	  != DMS::OK) {
+	if (throwp)
+	  DMS::DecodeLatLon(string(el[0], ellen[0]), string(el[1], ellen[1]),
+			    lat, lon);
+	return BADLATLON;
+      }
+      // DecodeLatLon checks the ranges of lat and lon and the projection to
+      // the standard zone can't fail, so defer it until it's needed.
+      zone = UTMUPS::StandardZone(lat, lon);
+      northp = lat >= 0;
+      utmvalid = false;
+    } else if (n == 3) {
+      int zoneind, coordind;
+      if (isalpha((unsigned char)el[0][ellen[0] - 1])) {
 	zoneind = 0;
 	coordind = 1;
-      } else if (sa[2].size() > 0 && isalpha(sa[2][sa[2].size() - 1])) {
+      } else if (isalpha((unsigned char)el[2][ellen[2] - 1])) {
 	zoneind = 2;
 	coordind = 0;
-      } else
-	throw out_of_range("Neither " + sa[0] + " nor " + sa[2] +
+      } else {
+	if (!throwp)
+	  return BADZONE;
+	throw out_of_range("Neither " + string(el[0], ellen[0]) + " nor "
+			   + string(el[2], ellen[2]) +
 			   " of the form UTM/UPS Zone + Hemisphere" +
 			   " (ex: 38N, 09S, N)");
-      char hemi = toupper(sa[zoneind][sa[zoneind].size() - 1]);
-      _northp = hemi == 'N';
-      if (! (_northp || hemi == 'S'))
-	throw out_of_range(string("Illegal hemisphere letter ") + hemi
-			   + " in " + sa[zoneind]);
-      const char* c = sa[zoneind].c_str();
-      char* q;
-      _zone = strtol(c, &q, 10);
-      if (q - c != int(sa[zoneind].size()) - 1)
-	throw out_of_range("Extra text in UTM/UPS zone " + sa[zoneind]);
-      if (q > c && _zone == 0)
-	// Don't allow 0N as an alternative to N for UPS coordinates
-	throw out_of_range("Illegal zone 0 in " + sa[zoneind]);
-      if (q == c)
-	_zone = 0;
-      for (unsigned i = 0; i < 2; ++i) {
-	const char* c = sa[coordind + i].c_str();
-	errno = 0;
-	double x = strtod(c, &q);
-	if (errno ==  ERANGE || !isfinite(x))
-	  throw out_of_range("Number " + sa[coordind + i] + " out of range");
-	if (q - c != int(sa[coordind + i].size()))
-	  throw out_of_range(string("Extra text in UTM/UPS ") +
-			     (i == 0 ? "easting " : "northing ") +
-			     sa[coordind + i]);
-	if (i == 0)
-	  _easting = x;
-	else
-	  _northing = x;
       }
-      UTMUPS::Reverse(_zone, _northp, _easting, _northing,
-		      _lat, _long, _gamma, _k);
-      FixHemisphere();
-    } else
+      int status;
+      if ((status = ZoneDesignator(el[zoneind], ellen[zoneind],
+				   zone, northp, throwp)) != OK ||
+	  (status = Coordinate(el[coordind], ellen[coordind], 0,
+			       easting, throwp)) != OK ||
+	  (status = Coordinate(el[coordind + 1], ellen[coordind + 1], 1,
+			       northing, throwp)) != OK)
+	return status;
+      if (!UTMUPS::DoReverse(zone, northp, easting, northing,
+			     lat, lon, gamma, k, throwp))
+	return OUTOFRANGE;
+      if (!FixHemisphere(lat, zone, northp, northing, throwp))
+	return BADHEMISPHERE;
+    } else {
+      if (!throwp)
+	return BADCOUNT;
       throw out_of_range("Coordinate requires 1, 2, or 3 elements");
-    CopyToAlt();
+    }
+    _lat = lat;
+    _long = lon;
+    _zone = zone;
+    _northp = northp;
+    if (utmvalid) {
+      _easting = easting;
+      _northing = northing;
+      _gamma = gamma;
+      _k = k;
+    }
+    Invalidate(utmvalid);
+    return OK;
   }
 
+  void GeoCoords::Reset(double latitude, double longitude, int zone) {
+    if (zone < 0 && longitude < 180) {
+      // Check the position now but defer the projection to the standard zone
+      // (which can't then fail) until it's needed.  (Longitudes in [180,
+      // 360] are projected now, because the UPS convergence depends on the
+      // longitude as given.)
+      UTMUPS::CheckLatLon(latitude, longitude);
+      _zone = UTMUPS::StandardZone(latitude, longitude);
+      _northp = latitude >= 0;
+      Invalidate(false);
+    } else {
+      UTMUPS::Forward(latitude, longitude,
+		      _zone, _northp, _easting, _northing, _gamma, _k,
+		      zone);
+      Invalidate(true);
+    }
+    _lat = latitude;
+    _long = longitude;
+    if (_long >= 180)
+      _long -= 360;
+  }
+
+  void GeoCoords::ComputeUTMUPS() const throw() {
+    int zone;
+    bool northp;
+    UTMUPS::DoForward(_lat, _long, zone, northp,
+		      _easting, _northing, _gamma, _k, _zone, false);
+    _utmvalid = true;
+  }
+
+  void GeoCoords::Reset(const std::string& s) {
+    Decode(s.data(), int(s.size()), true);
+  }
+
+  int GeoCoords::Parse(const char* s, int len) throw() {
+    return Decode(s, len, false);
+  }
 
   string GeoCoords::GeoRepresentation(int prec) const {
-    prec = max(0, min(9, prec) + 5);
+    if (Cached(GEOREP, prec))
+      return _rep[GEOREP];
+    int p = max(0, min(9, prec) + 5);
     ostringstream os;
-    os << fixed << setprecision(prec)
+    os << fixed << setprecision(p)
        << _lat << " " << _long;
-    return os.str();
+    return Cache(GEOREP, prec, os.str());
   }
 
   string GeoCoords::DMSRepresentation(int prec) const {
-    prec = max(0, min(10, prec) + 5);
-    return DMS::Encode(_lat, unsigned(prec), DMS::LATITUDE) +
-      " " + DMS::Encode(_long, unsigned(prec), DMS::LONGITUDE);
+    if (Cached(DMSREP, prec))
+      return _rep[DMSREP];
+    int p = max(0, min(10, prec) + 5);
+    char dms[2 * DMS::bufsize + 1];
+    int n = DMS::Encode(_lat, unsigned(p), DMS::LATITUDE, dms);
+    if (n >= 0) {
+      dms[n] = ' ';
+      int m = DMS::Encode(_long, unsigned(p), DMS::LONGITUDE, dms + n + 1);
+      if (m >= 0)
+	return Cache(DMSREP, prec, string(dms, n + 1 + m));
+    }
+    return Cache(DMSREP, prec,
+		 DMS::Encode(_lat, unsigned(p), DMS::LATITUDE) +
+		 " " + DMS::Encode(_long, unsigned(p), DMS::LONGITUDE));
   }
 
   string GeoCoords::MGRSRepresentation(int prec) const {
+    if (Cached(MGRSREP, prec))
+      return _rep[MGRSREP];
+    UpdateUTMUPS();
     // Max precision is um
-    prec = max(0, min(6, prec) + 5);
+    int p = max(0, min(6, prec) + 5);
     string mgrs;
-    MGRS::Forward(_zone, _northp, _easting, _northing, _lat, prec, mgrs);
-    return mgrs;
+    MGRS::Forward(_zone, _northp, _easting, _northing, _lat, p, mgrs);
+    return Cache(MGRSREP, prec, mgrs);
   }
 
   string GeoCoords::AltMGRSRepresentation(int prec) const {
+    if (Cached(ALTMGRSREP, prec))
+      return _rep[ALTMGRSREP];
+    UpdateAlt();
     // Max precision is um
-    prec = max(0, min(6, prec) + 5);
+    int p = max(0, min(6, prec) + 5);
     string mgrs;
-    MGRS::Forward(_alt_zone, _northp, _alt_easting, _alt_northing, _lat, prec,
+    MGRS::Forward(_alt_zone, _northp, _alt_easting, _alt_northing, _lat, p,
 		  mgrs);
-    return mgrs;
+    return Cache(ALTMGRSREP, prec, mgrs);
   }
 
   void GeoCoords::UTMUPSString(int zone, double easting, double northing,
@@ -151,26 +309,37 @@ namespace GeographicLib {
   }
 
   string GeoCoords::UTMUPSRepresentation(int prec) const {
+    if (Cached(UTMUPSREP, prec))
+      return _rep[UTMUPSREP];
+    UpdateUTMUPS();
     string utm;
     UTMUPSString(_zone, _easting, _northing, prec, utm);
-    return utm;
+    return Cache(UTMUPSREP, prec, utm);
   }
 
   string GeoCoords::AltUTMUPSRepresentation(int prec) const {
+    if (Cached(ALTUTMUPSREP, prec))
+      return _rep[ALTUTMUPSREP];
+    UpdateAlt();
     string utm;
     UTMUPSString(_alt_zone, _alt_easting, _alt_northing, prec, utm);
-    return utm;
+    return Cache(ALTUTMUPSREP, prec, utm);
   }
 
-  void GeoCoords::FixHemisphere() {
-    if (_lat == 0 || (_northp && _lat > 0) || (!_northp && _lat < 0))
+  bool GeoCoords::FixHemisphere(double lat, int zone,
+				bool& northp, double& northing, bool throwp) {
+    if (lat == 0 || (northp && lat > 0) || (!northp && lat < 0))
       // Allow either hemisphere for equator
-      return;
-    if (_zone > 0) {
-      _northing += (_northp ? 1 : -1) * MGRS::utmNshift;
-      _northp = !_northp;
-    } else
+      return true;
+    if (zone > 0) {
+      northing += (northp ? 1 : -1) * MGRS::utmNshift;
+      northp = !northp;
+    } else {
+      if (!throwp)
+	return false;
       throw out_of_range("Hemisphere mixup");
+    }
+    return true;
   }
 
 } // namespace GeographicLib
@@ -14,6 +14,7 @@
 #include <string>
 #include <cstdlib>
 #include "GeographicLib/UTMUPS.hpp"
+#include "GeographicLib/Constants.hpp"
 #if defined(_MSC_VER)
 #include <float.h>		// For _finite
 #endif
@@ -37,6 +38,20 @@ namespace GeographicLib {
    * The mutable state consists of the UTM or UPS coordinates for a alternate
    * zone.  A method SetAltZone is provided to set the alternate UPS/UTM zone.
    *
+   * If latitude and longitude are given (with the standard zone), the UTM/UPS
+   * coordinates are only computed when first needed; similarly the alternate
+   * coordinates are copied from the input ones on first access.  The string
+   * representations are cached (for the last precision requested) until the
+   * position or the alternate zone is changed.  Thus a position which is only
+   * printed as latitude and longitude is never projected.
+   *
+   * As a consequence, the const accessors (Easting, Northing, Convergence,
+   * Scale, AltZone and the other Alt versions of these, and the
+   * Representation functions) update this cached state and so are \e not
+   * thread safe.  A GeoCoords object must not be used by several threads at
+   * once, even if they only call const member functions; give each thread
+   * its own copy instead.
+   *
    * Methods are provided to return the geographic coordinates, the input UTM
    * or UPS coordinates (and associated meridian convergence and scale), or
    * alternate UTM or UPS coordinates (and their associated meridian
@@ -47,11 +62,31 @@ namespace GeographicLib {
    **********************************************************************/
   class GeoCoords {
   private:
-    double _lat, _long, _easting, _northing, _gamma, _k;
+    double _lat, _long;
+    mutable double _easting, _northing, _gamma, _k;
     bool _northp;
     int _zone;			// 0 = poles, -1 = undefined
     mutable double _alt_easting, _alt_northing, _alt_gamma, _alt_k;
     mutable int _alt_zone;
+    // Dirty flags: _utmvalid is false if _easting, _northing, _gamma, _k
+    // still need to be computed from _lat, _long (in the standard zone,
+    // _zone); _altvalid is false if the alternate coordinates need to be
+    // copied from the input ones.
+    mutable bool _utmvalid, _altvalid;
+    // The cached string representations, the precisions for which they were
+    // computed, and a bit mask of the valid ones.
+    enum representation {
+      GEOREP = 0,
+      DMSREP = 1,
+      MGRSREP = 2,
+      UTMUPSREP = 3,
+      ALTMGRSREP = 4,
+      ALTUTMUPSREP = 5,
+      NREP = 6
+    };
+    mutable std::string _rep[NREP];
+    mutable int _repprec[NREP];
+    mutable unsigned _repvalid;
 
     void CopyToAlt() const throw() {
       _alt_easting = _easting;
@@ -59,10 +94,54 @@ namespace GeographicLib {
       _alt_gamma = _gamma;
       _alt_k = _k;
       _alt_zone = _zone;
+      _altvalid = true;
+    }
+    void ComputeUTMUPS() const throw();
+    void UpdateUTMUPS() const throw() {
+      if (!_utmvalid) ComputeUTMUPS();
+    }
+    void UpdateAlt() const throw() {
+      if (!_altvalid) {
+	UpdateUTMUPS();
+	CopyToAlt();
+      }
+    }
+    // Mark the position as changed.
+    void Invalidate(bool utmvalid) throw() {
+      _utmvalid = utmvalid;
+      _altvalid = false;
+      _repvalid = 0;
+    }
+    bool Cached(representation r, int prec) const throw() {
+      return (_repvalid & 1U << r) && _repprec[r] == prec;
+    }
+    const std::string& Cache(representation r, int prec,
+			     const std::string& s) const {
+      _rep[r] = s;
+      _repprec[r] = prec;
+      _repvalid |= 1U << r;
+      return _rep[r];
     }
     void UTMUPSString(int zone, double easting, double northing,
 		   int prec, std::string& utm) const;
-    void FixHemisphere();
+    friend class GeoCoordsArray; // GeoCoordsArray uses FixHemisphere
+    // Switch the hemisphere of UTM coordinates to match lat.  On failure,
+    // throw an error if throwp, otherwise return false.
+    static bool FixHemisphere(double lat, int zone,
+			      bool& northp, double& northing, bool throwp);
+    // Split s into space or comma separated elements storing at most 3 of
+    // them in el and ellen.  Return the number of elements.
+    static int Split(const char* s, int len,
+		     const char* el[], int ellen[]) throw();
+    // Parse the zone designator in s.
+    static int ZoneDesignator(const char* s, int len, int& zone, bool& northp,
+			      bool throwp);
+    // Parse an easting (i = 0) or northing (i = 1) in s.
+    static int Coordinate(const char* s, int len, int i, double& x,
+			  bool throwp);
+    // The implementation of Reset and Parse.  On failure, throw an error if
+    // throwp, otherwise return the status.
+    int Decode(const char* s, int len, bool throwp);
 #if defined(_MSC_VER)
     static inline int isfinite(double x) throw() { return _finite(x); }
 #else
@@ -82,8 +161,12 @@ namespace GeographicLib {
       , _long(0.0)
       , _easting(2000000.0)
       , _northing(2000000.0)
+      , _gamma(0.0)
+      , _k(Constants::UPS_k0())
       , _northp(true)
       , _zone(0)
+      , _utmvalid(true)
+      , _repvalid(0)
     { CopyToAlt();}
 
     /**
@@ -166,26 +249,40 @@ namespace GeographicLib {
       Reset(zone, northp, easting, northing);
     }
 
+    /**
+     * Status codes returned by Parse.
+     **********************************************************************/
+    enum status {
+      OK = 0,			// Success
+      BADCOUNT = 1,		// Not 1, 2, or 3 elements
+      BADMGRS = 2,		// Illegal MGRS string
+      BADLATLON = 3,		// Illegal latitude and longitude
+      BADZONE = 4,		// Illegal UTM/UPS zone designator
+      BADNUMBER = 5,		// Illegal easting or northing
+      OUTOFRANGE = 6,		// Position out of range for UTM/UPS
+      BADHEMISPHERE = 7		// Hemisphere inconsistent with latitude
+    };
+
     /**
      * Reset the location as a 1-element, 2-element, or 3-element string.  See
      * GeoCoords(const string& s).
      **********************************************************************/
     void Reset(const std::string& s);
 
+    /**
+     * Parse the \e len chars at \e s (which need not be null terminated) as
+     * with Reset(const std::string& s) except that a status code (GeoCoords::OK
+     * on success) is returned instead of throwing an error.  On failure, the
+     * position is unchanged.  The string is split in place and no heap
+     * allocation is done.
+     **********************************************************************/
+    int Parse(const char* s, int len) throw();
+
     /**
      * Reset the location in terms of \e latitude and \e longitude.  See
      * GeoCoords(double latitude, double longitude, int zone).
      **********************************************************************/
-    void Reset(double latitude, double longitude, int zone = -1) {
-      _lat = latitude;
-      _long = longitude;
-      UTMUPS::Forward(_lat, _long,
-		      _zone, _northp, _easting, _northing, _gamma, _k,
-		      zone);
-      if (_long >= 180)
-	_long -= 360;
-      CopyToAlt();
-    }
+    void Reset(double latitude, double longitude, int zone = -1);
 
     /**
      * Reset the location in terms of UPS/UPS \e zone, hemisphere \e northp, \e
@@ -199,8 +296,8 @@ namespace GeographicLib {
       _northing = northing;
       UTMUPS::Reverse(_zone, _northp, _easting, _northing,
 		      _lat, _long, _gamma, _k);
-      FixHemisphere();
-      CopyToAlt();
+      FixHemisphere(_lat, _zone, _northp, _northing, true);
+      Invalidate(true);
     }
 
     /**
@@ -216,22 +313,22 @@ namespace GeographicLib {
     /**
      * Return easting (meters)
      **********************************************************************/
-    double Easting() const throw() { return _easting; }
+    double Easting() const throw() { UpdateUTMUPS(); return _easting; }
 
     /**
      * Return northing (meters)
      **********************************************************************/
-    double Northing() const throw() { return _northing; }
+    double Northing() const throw() { UpdateUTMUPS(); return _northing; }
 
     /**
      * Return meridian convergence (degrees) for the UTM/UPS projection.
      **********************************************************************/
-    double Convergence() const throw() { return _gamma; }
+    double Convergence() const throw() { UpdateUTMUPS(); return _gamma; }
 
     /**
      * Return scale for the UTM/UPS projection.
      **********************************************************************/
-    double Scale() const throw() { return _k; }
+    double Scale() const throw() { UpdateUTMUPS(); return _k; }
 
     /**
      * Return hemisphere (false means south, true means north).
@@ -256,40 +353,42 @@ namespace GeographicLib {
     void SetAltZone(int zone = -1) const {
       if (zone == _zone ||
 	  (zone < 0 && _zone == UTMUPS::StandardZone(_lat, _long)))
-	CopyToAlt();
+	_altvalid = false;
       else {
 	bool northp;
 	UTMUPS::Forward(_lat, _long,
 			_alt_zone, northp,
 			_alt_easting, _alt_northing, _alt_gamma, _alt_k,
 			zone);
+	_altvalid = true;
       }
+      _repvalid &= ~(1U << ALTMGRSREP | 1U << ALTUTMUPSREP);
     }
 
     /**
      * Returns the current alternate zone (return 0 for UPS).
      **********************************************************************/
-    int AltZone() const throw() { return _alt_zone; }
+    int AltZone() const throw() { UpdateAlt(); return _alt_zone; }
 
     /**
      * Return easting (meters) for alternate zone.
      **********************************************************************/
-    double AltEasting() const throw() { return _alt_easting; }
+    double AltEasting() const throw() { UpdateAlt(); return _alt_easting; }
 
     /**
      * Return northing (meters) for alternate zone.
      **********************************************************************/
-    double AltNorthing() const throw() { return _alt_northing; }
+    double AltNorthing() const throw() { UpdateAlt(); return _alt_northing; }
 
     /**
      * Return meridian convergence (degrees) for altermate zone.
      **********************************************************************/
-    double AltConvergence() const throw() { return _alt_gamma; }
+    double AltConvergence() const throw() { UpdateAlt(); return _alt_gamma; }
 
     /**
      * Return scale for altermate zone.
      **********************************************************************/
-    double AltScale() const throw() { return _alt_k; }
+    double AltScale() const throw() { UpdateAlt(); return _alt_k; }
 
     /**
      * Return string with latitude and longitude as signed decimal degrees.
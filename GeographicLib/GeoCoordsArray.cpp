@@ -0,0 +1,277 @@
+/**
+ * \file GeoCoordsArray.cpp
+ * \brief Implementation for GeographicLib::GeoCoordsArray class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/GeoCoordsArray.hpp"
+#include "GeographicLib/UTMUPS.hpp"
+#include "GeographicLib/MGRS.hpp"
+#include "GeographicLib/DMS.hpp"
+#include "GeographicLib/Parallel.hpp"
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = GEOCOORDSARRAY_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  void GeoCoordsArray::Resize(int n) {
+    _lat.resize(n);
+    _long.resize(n);
+    _easting.resize(n);
+    _northing.resize(n);
+    _gamma.resize(n);
+    _k.resize(n);
+    _zone.resize(n);
+    _status.resize(n);
+    _northp.resize(n);
+  }
+
+  void GeoCoordsArray::Invalidate(int i) throw() {
+    double nan = numeric_limits<double>::quiet_NaN();
+    _lat[i] = _long[i] = nan;
+    _easting[i] = _northing[i] = _gamma[i] = _k[i] = nan;
+    _zone[i] = -1;
+    _northp[i] = 0;
+  }
+
+  int GeoCoordsArray::Reset(int n, const double lat[], const double lon[]) {
+    Resize(n);
+    int nerr = 0;
+    bool wrapped = false;
+    for (int i = 0; i < n; ++i) {
+      if (! (lat[i] >= -90 && lat[i] <= 90 &&
+	     lon[i] >= -180 && lon[i] <= 360) ) {
+	Invalidate(i);
+	_status[i] = GeoCoords::BADLATLON;
+	++nerr;
+	continue;
+      }
+      _lat[i] = lat[i];
+      _long[i] = lon[i];
+      if (_long[i] >= 180) {
+	_long[i] -= 360;
+	wrapped = true;
+      }
+      _zone[i] = UTMUPS::StandardZone(_lat[i], _long[i]);
+      _northp[i] = _lat[i] >= 0;
+      _status[i] = GeoCoords::OK;
+    }
+    // The projection to the standard zone can't fail; defer it until it's
+    // needed.  (As in GeoCoords::Reset, longitudes in [180, 360] are
+    // projected now, because the UPS convergence depends on the longitude as
+    // given.)
+    _utmvalid = false;
+    if (wrapped)
+      ComputeUTMUPS(lon);
+    return nerr;
+  }
+
+  void GeoCoordsArray::Reverse(int i) throw() {
+    int zone = _zone[i];
+    bool northp = _northp[i] != 0;
+    double
+      x = _easting[i], y = _northing[i],
+      lat, lon, gamma, k;
+    int status = GeoCoords::OK;
+    if (!UTMUPS::DoReverse(zone, northp, x, y, lat, lon, gamma, k, false))
+      status = GeoCoords::OUTOFRANGE;
+    else if (!GeoCoords::FixHemisphere(lat, zone, northp, y, false))
+      status = GeoCoords::BADHEMISPHERE;
+    if (status != GeoCoords::OK) {
+      Invalidate(i);
+      _status[i] = status;
+      return;
+    }
+    _lat[i] = lat;
+    _long[i] = lon;
+    _northp[i] = northp;
+    _northing[i] = y;
+    _gamma[i] = gamma;
+    _k[i] = k;
+    _status[i] = GeoCoords::OK;
+  }
+
+  int GeoCoordsArray::Reset(int n, const int zone[], const bool northp[],
+			    const double easting[], const double northing[]) {
+    Resize(n);
+    for (int i = 0; i < n; ++i) {
+      _zone[i] = zone[i];
+      _northp[i] = northp[i];
+      _easting[i] = easting[i];
+      _northing[i] = northing[i];
+    }
+    int nerr = 0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static) \
+  reduction(+:nerr)
+#endif
+    for (int i = 0; i < n; ++i) {
+      Reverse(i);
+      if (_status[i] != GeoCoords::OK)
+	++nerr;
+    }
+    _utmvalid = true;
+    return nerr;
+  }
+
+  int GeoCoordsArray::Reset(const char* text, size_t len) {
+    Resize(0);
+    int zone[mgrschunk], prec[mgrschunk], status[mgrschunk];
+    bool northp[mgrschunk];
+    double x[mgrschunk], y[mgrschunk];
+    for (size_t pos = 0; pos < len;) {
+      size_t used;
+      int m = MGRS::Reverse(text + pos, len - pos, mgrschunk,
+			    zone, northp, x, y, prec, status, used);
+      if (m == 0)
+	break;
+      pos += used;
+      int n0 = Size();
+      Resize(n0 + m);
+      for (int j = 0; j < m; ++j) {
+	_zone[n0 + j] = zone[j];
+	_northp[n0 + j] = northp[j];
+	_easting[n0 + j] = x[j];
+	_northing[n0 + j] = y[j];
+	_status[n0 + j] =
+	  status[j] == MGRS::OK ? int(GeoCoords::OK) : int(GeoCoords::BADMGRS);
+      }
+    }
+    int n = Size(), nerr = 0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static) \
+  reduction(+:nerr)
+#endif
+    for (int i = 0; i < n; ++i) {
+      if (_status[i] == GeoCoords::OK)
+	Reverse(i);
+      else
+	Invalidate(i);
+      if (_status[i] != GeoCoords::OK)
+	++nerr;
+    }
+    _utmvalid = true;
+    return nerr;
+  }
+
+  void GeoCoordsArray::ComputeUTMUPS(const double lon[]) const throw() {
+    int n = Size();
+    if (!lon)
+      lon = n ? &_long[0] : 0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i) {
+      if (_status[i] != GeoCoords::OK)
+	continue;
+      int zone;
+      bool northp;
+      UTMUPS::DoForward(_lat[i], lon[i], zone, northp,
+			_easting[i], _northing[i], _gamma[i], _k[i],
+			_zone[i], false);
+    }
+    _utmvalid = true;
+  }
+
+  int GeoCoordsArray::Format(representation r, int prec, int i, char buf[])
+    const throw() {
+    if (_status[i] != GeoCoords::OK)
+      return -1;
+    switch (r) {
+    case GEOREP:
+      {
+	int p = max(0, min(9, prec) + 5);
+	return sprintf(buf, "%.*f %.*f", p, _lat[i], p, _long[i]);
+      }
+    case DMSREP:
+      {
+	int p = max(0, min(10, prec) + 5);
+	int n = DMS::Encode(_lat[i], unsigned(p), DMS::LATITUDE, buf);
+	if (n < 0)
+	  return -1;
+	buf[n++] = ' ';
+	int m = DMS::Encode(_long[i], unsigned(p), DMS::LONGITUDE, buf + n);
+	return m < 0 ? -1 : n + m;
+      }
+    case MGRSREP:
+      {
+	// Max precision is um
+	int p = max(0, min(6, prec) + 5);
+	try {
+	  return MGRS::Forward(_zone[i], _northp[i] != 0,
+			       _easting[i], _northing[i], _lat[i], p, buf);
+	}
+	catch (const out_of_range&) {
+	  return -1;
+	}
+      }
+    case UTMUPSREP:
+      {
+	// The same format as GeoCoords::UTMUPSString
+	int p = max(-5, min(9, prec));
+	double scale = p < 0 ? pow(10.0, -p) : 1.0;
+	char* q = buf;
+	if (_zone[i])
+	  q += sprintf(q, "%02d", _zone[i]);
+	*q++ = _northp[i] ? 'N' : 'S';
+	for (int j = 0; j < 2; ++j) {
+	  double x = (j ? _northing[i] : _easting[i]) / scale;
+	  q += sprintf(q, " %.*f", max(0, p), x);
+	  if (p < 0 && abs(x) > 0.5)
+	    q += sprintf(q, "%0*d", -p, 0);
+	}
+	return int(q - buf);
+      }
+    }
+    return -1;
+  }
+
+  void GeoCoordsArray::Representation(representation r, int prec,
+				      string& text) const {
+    if (r == MGRSREP || r == UTMUPSREP)
+      UpdateUTMUPS();
+    int n = Size(), nthreads = Parallel::Threads(n);
+    // Each thread formats a contiguous range of the positions into its own
+    // string; these are then concatenated in order.
+    vector<string> parts(nthreads);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nthreads) schedule(static)
+#endif
+    for (int t = 0; t < nthreads; ++t) {
+      int
+	i0 = int(double(n) * t / nthreads),
+	i1 = int(double(n) * (t + 1) / nthreads);
+      string& s = parts[t];
+      s.reserve(32 * (i1 - i0));
+      char buf[bufsize];
+      for (int i = i0; i < i1; ++i) {
+	int m = Format(r, prec, i, buf);
+	if (m >= 0)
+	  s.append(buf, m);
+	else
+	  s.append("ERROR");
+	s.push_back('\n');
+      }
+    }
+    size_t len = 0;
+    for (int t = 0; t < nthreads; ++t)
+      len += parts[t].size();
+    text.clear();
+    text.reserve(len);
+    for (int t = 0; t < nthreads; ++t)
+      text.append(parts[t]);
+  }
+
+} // namespace GeographicLib
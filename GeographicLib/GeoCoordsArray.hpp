@@ -0,0 +1,231 @@
+/**
+ * \file GeoCoordsArray.hpp
+ * \brief Header for GeographicLib::GeoCoordsArray class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(GEOCOORDSARRAY_HPP)
+#define GEOCOORDSARRAY_HPP "$Id$"
+
+#include "GeographicLib/GeoCoords.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GeographicLib {
+
+  /**
+   * \brief Hold many geographic positions in columns
+   *
+   * GeoCoordsArray is a structure-of-arrays counterpart of GeoCoords.  The
+   * latitudes, longitudes, zones, hemispheres, eastings, northings,
+   * convergences, and scales of the positions are each held in a separate
+   * contiguous column so that scanning one quantity for all the positions
+   * touches only the memory for that quantity.  The positions are set in
+   * bulk from columns of latitudes and longitudes, of UTM/UPS coordinates, or
+   * from a block of MGRS strings.  Positions which cannot be converted are
+   * marked with a non-zero status (one of the GeoCoords::status codes); their
+   * latitudes and longitudes and other quantities are NaNs and their zone is
+   * -1.
+   *
+   * As with GeoCoords, positions set by latitude and longitude are placed in
+   * their standard UTM/UPS zones; the eastings, northings, convergences, and
+   * scales are only computed when one of them is first requested.  The
+   * conversions and the formatting of the representations are split between
+   * threads as described for Parallel.  A GeoCoordsArray must not be
+   * accessed by several threads at once, because the first request for the
+   * derived columns modifies the object.
+   *
+   * The representations of all the positions are written as lines (in the
+   * formats given by the corresponding GeoCoords functions) to a single
+   * string.  The line for a position which cannot be represented is
+   * "ERROR".
+   *
+   * Example of use:
+   \verbatim
+   GeoCoordsArray a;
+   a.Reset(n, lat, lon);
+   const double* x = a.Eastings();   // projects all the points
+   std::string text;
+   a.MGRSRepresentation(-2, text);   // n lines of 100m MGRS squares
+   \endverbatim
+   **********************************************************************/
+  class GeoCoordsArray {
+  private:
+    // The number of MGRS strings parsed at a time.
+    enum { mgrschunk = 1024 };
+    // Big enough for any representation of a single position.
+    enum { bufsize = 128 };
+    enum representation {
+      GEOREP = 0,
+      DMSREP = 1,
+      MGRSREP = 2,
+      UTMUPSREP = 3
+    };
+    std::vector<double> _lat, _long;
+    mutable std::vector<double> _easting, _northing, _gamma, _k;
+    std::vector<int> _zone, _status;
+    // char instead of bool so that threads can set separate elements
+    std::vector<char> _northp;
+    mutable bool _utmvalid;
+    void Resize(int n);
+    void Invalidate(int i) throw();
+    // Compute latitude and longitude of element i from its UTM/UPS
+    // coordinates.
+    void Reverse(int i) throw();
+    // Project the positions to their standard zones using longitudes lon
+    // (_long if lon is 0).
+    void ComputeUTMUPS(const double lon[] = 0) const throw();
+    void UpdateUTMUPS() const throw() {
+      if (!_utmvalid) ComputeUTMUPS();
+    }
+    // Write the representation of element i into buf and return its length
+    // or -1 on failure.
+    int Format(representation r, int prec, int i, char buf[]) const throw();
+    void Representation(representation r, int prec, std::string& text) const;
+  public:
+
+    /**
+     * Construct an empty GeoCoordsArray.
+     **********************************************************************/
+    GeoCoordsArray() throw() : _utmvalid(true) {}
+
+    /**
+     * Reset to \e n positions given by latitudes \e lat[i] and longitudes \e
+     * lon[i] (degrees).  The latitudes must be in [-90, 90] and the
+     * longitudes in [-180, 360].  As with GeoCoords, the positions are
+     * projected to their standard zones using the longitudes as given (the
+     * UPS convergence depends on this), while Longitude returns them reduced
+     * to [-180, 180).  Return the number of positions which are out of
+     * range.
+     **********************************************************************/
+    int Reset(int n, const double lat[], const double lon[]);
+
+    /**
+     * Reset to \e n positions given by UTM/UPS zones \e zone[i] (zero means
+     * UPS), hemispheres \e northp[i], eastings \e easting[i], and northings
+     * \e northing[i] (meters).  As with GeoCoords, the hemisphere of UTM
+     * coordinates is switched if necessary to match the latitude.  Return the
+     * number of positions which are out of range.
+     **********************************************************************/
+    int Reset(int n, const int zone[], const bool northp[],
+	      const double easting[], const double northing[]);
+
+    /**
+     * Reset to the positions given by the newline separated MGRS strings in
+     * the \e len chars at \e text (see the batch MGRS::Reverse).  The center of
+     * the MGRS square is used for each position.  Return the number of lines
+     * which could not be converted.
+     **********************************************************************/
+    int Reset(const char* text, std::size_t len);
+
+    /**
+     * The number of positions.
+     **********************************************************************/
+    int Size() const throw() { return int(_lat.size()); }
+
+    /**
+     * The status of position \e i (GeoCoords::OK if it is legal).
+     **********************************************************************/
+    int Status(int i) const throw() { return _status[i]; }
+
+    /**
+     * The latitude of position \e i (degrees).
+     **********************************************************************/
+    double Latitude(int i) const throw() { return _lat[i]; }
+
+    /**
+     * The longitude of position \e i (degrees), in [-180, 180).
+     **********************************************************************/
+    double Longitude(int i) const throw() { return _long[i]; }
+
+    /**
+     * The zone of position \e i (0 means UPS).
+     **********************************************************************/
+    int Zone(int i) const throw() { return _zone[i]; }
+
+    /**
+     * The hemisphere of position \e i.
+     **********************************************************************/
+    bool Northp(int i) const throw() { return _northp[i] != 0; }
+
+    /**
+     * The easting of position \e i (meters).
+     **********************************************************************/
+    double Easting(int i) const throw() { UpdateUTMUPS(); return _easting[i]; }
+
+    /**
+     * The northing of position \e i (meters).
+     **********************************************************************/
+    double Northing(int i) const throw()
+    { UpdateUTMUPS(); return _northing[i]; }
+
+    /**
+     * The meridian convergence of position \e i (degrees).
+     **********************************************************************/
+    double Convergence(int i) const throw()
+    { UpdateUTMUPS(); return _gamma[i]; }
+
+    /**
+     * The scale of position \e i.
+     **********************************************************************/
+    double Scale(int i) const throw() { UpdateUTMUPS(); return _k[i]; }
+
+    /**
+     * The columns of latitudes, longitudes, eastings, northings, convergences,
+     * scales, and zones.  The pointers are valid until the next Reset.
+     **********************************************************************/
+    const double* Latitudes() const throw()
+    { return _lat.empty() ? 0 : &_lat[0]; }
+    const double* Longitudes() const throw()
+    { return _long.empty() ? 0 : &_long[0]; }
+    const double* Eastings() const throw()
+    { UpdateUTMUPS(); return _easting.empty() ? 0 : &_easting[0]; }
+    const double* Northings() const throw()
+    { UpdateUTMUPS(); return _northing.empty() ? 0 : &_northing[0]; }
+    const double* Convergences() const throw()
+    { UpdateUTMUPS(); return _gamma.empty() ? 0 : &_gamma[0]; }
+    const double* Scales() const throw()
+    { UpdateUTMUPS(); return _k.empty() ? 0 : &_k[0]; }
+    const int* Zones() const throw()
+    { return _zone.empty() ? 0 : &_zone[0]; }
+
+    /**
+     * Write the latitudes and longitudes of all the positions as lines of
+     * decimal degrees to \e text.  See GeoCoords::GeoRepresentation for the
+     * meaning of \e prec.
+     **********************************************************************/
+    void GeoRepresentation(int prec, std::string& text) const {
+      Representation(GEOREP, prec, text);
+    }
+
+    /**
+     * Write the latitudes and longitudes of all the positions as lines of
+     * degrees, minutes, and seconds to \e text.  See
+     * GeoCoords::DMSRepresentation for the meaning of \e prec.
+     **********************************************************************/
+    void DMSRepresentation(int prec, std::string& text) const {
+      Representation(DMSREP, prec, text);
+    }
+
+    /**
+     * Write the MGRS strings of all the positions as lines to \e text.  See
+     * GeoCoords::MGRSRepresentation for the meaning of \e prec.
+     **********************************************************************/
+    void MGRSRepresentation(int prec, std::string& text) const {
+      Representation(MGRSREP, prec, text);
+    }
+
+    /**
+     * Write the UTM/UPS coordinates of all the positions as lines to \e text.
+     * See GeoCoords::UTMUPSRepresentation for the meaning of \e prec.
+     **********************************************************************/
+    void UTMUPSRepresentation(int prec, std::string& text) const {
+      Representation(UTMUPSREP, prec, text);
+    }
+  };
+
+} // namespace GeographicLib
+#endif
@@ -8,6 +8,8 @@
 
 #include "GeographicLib/Geocentric.hpp"
 #include "GeographicLib/Constants.hpp"
+#include "GeographicLib/Parallel.hpp"
+#include <new>
 #include <algorithm>
 #include <limits>
 
@@ -30,8 +32,24 @@ namespace GeographicLib {
     , _maxrad(2 * _a / numeric_limits<double>::epsilon())
   {}
 
-  const Geocentric Geocentric::WGS84(Constants::WGS84_a(),
-				     Constants::WGS84_invf());
+  namespace {
+    // Storage for WGS84 (zero until Init constructs it).
+    union {
+      double align;
+      char data[sizeof(Geocentric)];
+    } wgs84store;
+  }
+
+  const Geocentric& Geocentric::WGS84 =
+    *reinterpret_cast<const Geocentric*>(wgs84store.data);
+
+  int Geocentric::Init::_count = 0;
+
+  Geocentric::Init::Init() throw() {
+    if (_count++ == 0)
+      new (wgs84store.data) Geocentric(Constants::WGS84_a(),
+				       Constants::WGS84_invf());
+  }
 
   void Geocentric::Forward(double lat, double lon, double h,
 			   double& x, double& y, double& z) const throw() {
@@ -39,7 +57,7 @@ namespace GeographicLib {
       phi = lat * Constants::degree(),
       lam = lon * Constants::degree(),
       sphi = sin(phi),
-      n = _a/sqrt(1 - _e2 * sq(sphi));
+      n = _e2 != 0 ? _a/sqrt(1 - _e2 * sq(sphi)) : _a;
     z = ( sq(1 - _f) * n + h) * sphi;
     x = (n + h) * cos(phi);
     y = x * sin(lam);
@@ -132,5 +150,26 @@ namespace GeographicLib {
     lon = -atan2(-y, x) / Constants::degree();
   }
 
+  void Geocentric::Forward(int n, const double lat[], const double lon[],
+			   const double h[], double x[], double y[], double z[])
+    const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Forward(lat[i], lon[i], h[i], x[i], y[i], z[i]);
+  }
+
+  void Geocentric::Reverse(int n, const double x[], const double y[],
+			   const double z[],
+			   double lat[], double lon[], double h[])
+    const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Reverse(x[i], y[i], z[i], lat[i], lon[i], h[i]);
+  }
+
 } // namespace GeographicLib
 
@@ -90,12 +90,56 @@ namespace GeographicLib {
     void Reverse(double x, double y, double z,
 		 double& lat, double& lon, double& h) const throw();
 
+    /**
+     * Perform \e n forward conversions.  This is equivalent to calling
+     * Forward(\e lat[i], \e lon[i], \e h[i], \e x[i], \e y[i], \e z[i])
+     * for each \e i in [0, \e n).
+     **********************************************************************/
+    void Forward(int n, const double lat[], const double lon[],
+		 const double h[], double x[], double y[], double z[])
+      const throw();
+
+    /**
+     * Perform \e n reverse conversions.  This is equivalent to calling
+     * Reverse(\e x[i], \e y[i], \e z[i], \e lat[i], \e lon[i], \e h[i])
+     * for each \e i in [0, \e n).
+     **********************************************************************/
+    void Reverse(int n, const double x[], const double y[], const double z[],
+		 double lat[], double lon[], double h[]) const throw();
+
+    /**
+     * Return the major radius of the ellipsoid (meters).
+     **********************************************************************/
+    double MajorRadius() const throw() { return _a; }
+
+    /**
+     * Return the flattening of the ellipsoid (0 for a sphere).
+     **********************************************************************/
+    double Flattening() const throw() { return _f; }
+
     /**
      * A global instantiation of Geocentric with the parameters for the WGS84
      * ellipsoid.
+     *
+     * WGS84 is constructed before the static objects in any file which
+     * includes this header, so it may be used in their initialization.
      **********************************************************************/
-    const static Geocentric WGS84;
+    const static Geocentric& WGS84;
+
+    /// \cond SKIP
+    // Each file including this header has an Init; the first constructs WGS84.
+    class Init {
+    public:
+      Init() throw();
+    private:
+      static int _count;
+    };
+    /// \endcond
   };
 
+  namespace {
+    Geocentric::Init Geocentric_init;
+  }
+
 } //namespace GeographicLib
 #endif
@@ -8,7 +8,7 @@
  *
  * Compile with
  *
- *   g++ -g -O3 -I.. -o Geod Geod.cpp Geodesic.cpp DMS.cpp Constants.cpp
+ *   g++ -g -O3 -I.. -o Geod Geod.cpp Geodesic.cpp DMS.cpp Constants.cpp PointFile.cpp Utility.cpp
  *
  * See \ref geod for usage information.
  **********************************************************************/
@@ -18,12 +18,23 @@
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
 #include "GeographicLib/Geodesic.hpp"
 #include "GeographicLib/DMS.hpp"
+#include "GeographicLib/PointFile.hpp"
+#include "GeographicLib/Utility.hpp"
 
 int usage(int retval) {
   ( retval ? std::cerr : std::cout ) <<
-"Usage: Geod [-l lat1 lon1 azi1 | -i] [-n] [-d] [-f] [-p prec] [-h]\n\
+"Usage: Geod [-l lat1 lon1 azi1 | -i] [-n] [-d] [-f] [-p prec] [-b]\n\
+            [-j threads] [-R file] [-W file] [-h]\n\
 $Id: Geod.cpp 6572 2009-03-01 22:41:48Z ckarney $\n\
 \n\
 Perform geodesic calculations.\n\
@@ -70,34 +81,142 @@ is a complete geodesic specification consisting of seven quantities\n\
 The minimum value of prec is 0 (1 m accuracy) and the maximum value is\n\
 10 (0.1 nm accuracy, but then the last digits are unreliable).\n\
 \n\
+-j threads reads the standard input in large blocks and splits the\n\
+lines of each block between threads (0 means use all the processors).\n\
+The output is the same as without -j, except that it is only written\n\
+at the end of each block.\n\
+\n\
+-b reads and writes binary records instead of lines of text.  Each\n\
+input record consists of four little-endian doubles, the same\n\
+quantities as for text input (\"lat1 lon1 azi1 s12\" for the direct\n\
+calculation and \"lat1 lon1 lat2 lon2\" for the inverse calculation),\n\
+or of a single double, s12, with -l.  Angles are in degrees.  Each\n\
+output record consists of three doubles, \"lat2 lon2 azi2\" for the\n\
+direct calculation and \"s12 azi1 azi2\" for the inverse calculation.\n\
+With -f, each output record consists of seven doubles in the order\n\
+given above.  The computed quantities are NaNs for records with illegal\n\
+latitudes, longitudes, or azimuths.  The records are processed in\n\
+blocks as with -j (by default using all the processors).  -d and -p are\n\
+ignored.\n\
+\n\
+-R file reads the input from a point file (a memory mapped binary file\n\
+of named columns, see the documentation of PointFile) instead of\n\
+standard input.  -W file writes the output to a point file.  The\n\
+columns are named lat1, lon1, azi1, lat2, lon2, azi2, and s12 and the\n\
+input and output columns are the quantities of the binary records.\n\
+Illegal points are treated as with -b (which is ignored with -R and\n\
+-W).\n\
+\n\
 -h prints this help.\n";
   return retval;
 }
 
+enum { DIRECT, LINE, INVERSE };
 
-std::string LatLonString(double lat, double lon, int prec, bool dms) {
-  using namespace GeographicLib;
-  if (dms)
-    return
-      DMS::Encode(lat, prec + 5, DMS::LATITUDE) + " " +
-      DMS::Encode(lon, prec + 5, DMS::LONGITUDE);
-  else {
-    std::ostringstream os;
-    os << std::fixed << std::setprecision(prec + 5)
-       << lat << " " << lon;
-    return os.str();
+// The seven quantities specifying a geodesic in the order of the -f output.
+// The calculations work on columns of these.
+enum { LAT1, LON1, AZI1, LAT2, LON2, AZI2, S12, NCOL };
+
+// The names of the quantities in point files
+const char* const colnames[NCOL] =
+  {"lat1", "lon1", "azi1", "lat2", "lon2", "azi2", "s12"};
+
+// The input quantities for mode in the order of a binary record; set n to
+// their number.
+const int* Inputs(int mode, int& n) {
+  static const int
+    direct[] = {LAT1, LON1, AZI1, S12},
+    line[] = {S12},
+    inverse[] = {LAT1, LON1, LAT2, LON2};
+  n = mode == LINE ? 1 : 4;
+  return mode == DIRECT ? direct : mode == LINE ? line : inverse;
+}
+
+// The output quantities for mode in the order of a binary record; set n to
+// their number.
+const int* Outputs(int mode, bool full, int& n) {
+  static const int
+    direct[] = {LAT2, LON2, AZI2},
+    inverse[] = {S12, AZI1, AZI2},
+    all[] = {LAT1, LON1, AZI1, LAT2, LON2, AZI2, S12};
+  n = full ? int(NCOL) : 3;
+  return full ? all : mode == INVERSE ? inverse : direct;
+}
+
+// The blank separated names of the n quantities cols.
+std::string ColumnNames(const int cols[], int n) {
+  std::string names;
+  for (int k = 0; k < n; ++k) {
+    if (k) names += ' ';
+    names += colnames[cols[k]];
+  }
+  return names;
+}
+
+void AppendNumber(double x, int prec, std::string& os) {
+  if (std::abs(x) < 1e20) {
+    char buf[64];
+    os.append(buf, sprintf(buf, "%.*f", prec, x));
+  } else {
+    std::ostringstream str;
+    str << std::fixed << std::setprecision(prec) << x;
+    os += str.str();
   }
 }
 
-std::string AzimuthString(double azi, int prec, bool dms) {
+void AppendAngle(double ang, int prec, GeographicLib::DMS::flag ind,
+		 bool dms, std::string& os) {
   using namespace GeographicLib;
-  if (dms)
-    return DMS::Encode(azi, prec + 5, DMS::AZIMUTH);
-  else {
-    std::ostringstream os;
-    os << std::fixed << std::setprecision(prec + 5)
-       << azi;
-    return os.str();
+  if (dms) {
+    char buf[DMS::bufsize];
+    int n = DMS::Encode(ang, unsigned(prec + 5), ind, buf);
+    if (n >= 0)
+      os.append(buf, n);
+    else
+      os += DMS::Encode(ang, unsigned(prec + 5), ind);
+  } else
+    AppendNumber(ang, prec + 5, os);
+}
+
+void AppendLatLon(double lat, double lon, int prec, bool dms,
+		  std::string& os) {
+  AppendAngle(lat, prec, GeographicLib::DMS::LATITUDE, dms, os);
+  os += ' ';
+  AppendAngle(lon, prec, GeographicLib::DMS::LONGITUDE, dms, os);
+}
+
+// Append the output line (without the newline) for row i of col to os.
+void Format(int mode, bool full, bool dms, int prec,
+	    const std::vector<double> col[], int i, std::string& os) {
+  using namespace GeographicLib;
+  if (mode == INVERSE) {
+    if (full) {
+      AppendLatLon(col[LAT1][i], col[LON1][i], prec, dms, os);
+      os += ' ';
+    }
+    AppendAngle(col[AZI1][i], prec, DMS::AZIMUTH, dms, os);
+    os += ' ';
+    if (full) {
+      AppendLatLon(col[LAT2][i], col[LON2][i], prec, dms, os);
+      os += ' ';
+    }
+    AppendAngle(col[AZI2][i], prec, DMS::AZIMUTH, dms, os);
+    os += ' ';
+    AppendNumber(col[S12][i], prec, os);
+  } else {
+    if (full) {
+      AppendLatLon(col[LAT1][i], col[LON1][i], prec, dms, os);
+      os += ' ';
+      AppendAngle(col[AZI1][i], prec, DMS::AZIMUTH, dms, os);
+      os += ' ';
+    }
+    AppendLatLon(col[LAT2][i], col[LON2][i], prec, dms, os);
+    os += ' ';
+    AppendAngle(col[AZI2][i], prec, DMS::AZIMUTH, dms, os);
+    if (full) {
+      os += ' ';
+      AppendNumber(col[S12][i], prec, os);
+    }
   }
 }
 
@@ -114,11 +233,410 @@ double ReadAzimuth(const std::string& s) {
   return azi;
 }
 
+// Read the input quantities from s into row i of col.  Throw an error if s
+// is illegal.
+void ReadLine(const std::string& s, int mode, std::vector<double> col[],
+	      int i) {
+  using namespace GeographicLib;
+  std::istringstream str(s);
+  double lat1, lon1, azi1, lat2, lon2, s12;
+  if (mode == LINE) {
+    if (!(str >> s12))
+      throw std::out_of_range("Incomplete input: " + s);
+  } else if (mode == INVERSE) {
+    std::string slat1, slon1, slat2, slon2;
+    if (!(str >> slat1 >> slon1 >> slat2 >> slon2))
+      throw std::out_of_range("Incomplete input: " + s);
+    DMS::DecodeLatLon(slat1, slon1, lat1, lon1);
+    DMS::DecodeLatLon(slat2, slon2, lat2, lon2);
+    col[LAT1][i] = lat1; col[LON1][i] = lon1;
+    col[LAT2][i] = lat2; col[LON2][i] = lon2;
+    return;
+  } else {
+    std::string slat1, slon1, sazi1;
+    if (!(str >> slat1 >> slon1 >> sazi1 >> s12))
+      throw std::out_of_range("Incomplete input: " + s);
+    DMS::DecodeLatLon(slat1, slon1, lat1, lon1);
+    azi1 = ReadAzimuth(sazi1);
+    col[LAT1][i] = lat1; col[LON1][i] = lon1; col[AZI1][i] = azi1;
+  }
+  col[S12][i] = s12;
+}
+
+// Find the next whitespace delimited word in the len chars at s starting at
+// pos, setting beg and end to its limits.  Return false if there isn't one.
+bool Word(const char* s, int len, int& pos, int& beg, int& end) {
+  while (pos < len && isspace((unsigned char)(s[pos])))
+    ++pos;
+  if (pos == len)
+    return false;
+  beg = pos;
+  while (pos < len && !isspace((unsigned char)(s[pos])))
+    ++pos;
+  end = pos;
+  return true;
+}
+
+// The same as ReadLine for the len chars at s but without allocating memory
+// or throwing an error.  Return false if the line is illegal or has an
+// unusual form.
+bool ReadFast(const char* s, int len, int mode, std::vector<double> col[],
+	      int i) {
+  using namespace GeographicLib;
+  int pos = 0, b[4], e[4];
+  int nwords = mode == LINE ? 1 : 4;
+  for (int k = 0; k < nwords; ++k)
+    if (!Word(s, len, pos, b[k], e[k]))
+      return false;
+  double lat1, lon1, azi1, lat2, lon2, s12;
+  if (mode == INVERSE) {
+    if (DMS::DecodeLatLon(s + b[0], e[0] - b[0], s + b[1], e[1] - b[1],
+			  lat1, lon1) != DMS::OK ||
+	DMS::DecodeLatLon(s + b[2], e[2] - b[2], s + b[3], e[3] - b[3],
+			  lat2, lon2) != DMS::OK)
+      return false;
+    col[LAT1][i] = lat1; col[LON1][i] = lon1;
+    col[LAT2][i] = lat2; col[LON2][i] = lon2;
+    return true;
+  }
+  if (!Utility::ReadNumber(s + b[nwords - 1], e[nwords - 1] - b[nwords - 1],
+			   s12))
+    return false;
+  if (mode == DIRECT) {
+    DMS::flag ind;
+    if (DMS::DecodeLatLon(s + b[0], e[0] - b[0], s + b[1], e[1] - b[1],
+			  lat1, lon1) != DMS::OK ||
+	DMS::Decode(s + b[2], e[2] - b[2], azi1, ind) != DMS::OK ||
+	!(azi1 >= -180 && azi1 <= 360) || ind == DMS::LATITUDE)
+      return false;
+    if (azi1 >= 180) azi1 -= 360;
+    col[LAT1][i] = lat1; col[LON1][i] = lon1; col[AZI1][i] = azi1;
+  }
+  col[S12][i] = s12;
+  return true;
+}
+
+// Read the len chars at s into row i of col.  On error set msg to the
+// diagnostic and return false.
+bool Read(const char* s, int len, int mode, std::vector<double> col[], int i,
+	  std::string& msg) {
+  if (ReadFast(s, len, mode, col, i))
+    return true;
+  try {
+    ReadLine(std::string(s, len), mode, col, i);
+  }
+  catch (std::out_of_range& e) {
+    msg = e.what();
+    return false;
+  }
+  return true;
+}
+
+// Compute the missing quantities for the first n rows of col.
+void Solve(int mode, const GeographicLib::Geodesic& geod,
+	   const GeographicLib::GeodesicLine& l, int n,
+	   std::vector<double> col[]) {
+  if (n == 0)
+    return;
+  switch (mode) {
+  case DIRECT:
+    geod.Direct(n, &col[LAT1][0], &col[LON1][0], &col[AZI1][0], &col[S12][0],
+		&col[LAT2][0], &col[LON2][0], &col[AZI2][0]);
+    break;
+  case LINE:
+    l.Position(n, &col[S12][0], &col[LAT2][0], &col[LON2][0], &col[AZI2][0]);
+    break;
+  case INVERSE:
+    geod.Inverse(n, &col[LAT1][0], &col[LON1][0], &col[LAT2][0], &col[LON2][0],
+		 &col[S12][0], &col[AZI1][0], &col[AZI2][0]);
+    break;
+  }
+}
+
+// Set the number of rows of col to n with the quantities initialized from
+// g0 (which holds the start of the line with -l).
+void Resize(int n, const double g0[], std::vector<double> col[]) {
+  for (int k = 0; k < NCOL; ++k)
+    col[k].assign(n, g0[k]);
+}
+
+// Process the lines of standard input in blocks using nthreads threads.  If
+// res is given, append the results to its columns (NaNs for illegal lines)
+// instead of writing them to standard output.  Return 1 if there were any
+// errors.
+int Stream(int nthreads, int mode, bool full, bool dms, int prec,
+	   const GeographicLib::Geodesic& geod,
+	   const GeographicLib::GeodesicLine& l, const double g0[],
+	   std::vector<double> res[] = 0) {
+  nthreads = GeographicLib::Utility::SetThreads(nthreads);
+  // Don't give a thread fewer lines than this
+  const int minlines = 1000;
+  GeographicLib::Utility::LineBlocks input(stdin);
+  std::vector<double> col[NCOL];
+  std::vector<char> ok;
+  std::vector<std::string> msg, out(nthreads);
+  int retval = 0;
+  while (input.Next()) {
+    int
+      nlines = input.Lines(),
+      nt = std::max(1, std::min(nthreads, nlines / minlines)),
+      err = 0;
+    Resize(nlines, g0, col);
+    ok.assign(nlines, 0);
+    msg.resize(nlines);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static) reduction(|:err)
+#endif
+    for (int t = 0; t < nt; ++t) {
+      int
+	i0 = int(double(nlines) * t / nt),
+	i1 = int(double(nlines) * (t + 1) / nt);
+      for (int i = i0; i < i1; ++i) {
+	ok[i] = Read(input.Line(i), input.Length(i), mode, col, i, msg[i]);
+	if (!ok[i]) {
+	  // Leave the illegal rows with harmless values
+	  for (int k = 0; k < NCOL; ++k)
+	    col[k][i] = g0[k];
+	  err = 1;
+	}
+      }
+    }
+    Solve(mode, geod, l, nlines, col);
+    if (err)
+      retval = 1;
+    if (res) {
+      const double nan = std::numeric_limits<double>::quiet_NaN();
+      for (int k = 0; k < NCOL; ++k)
+	for (int i = 0; i < nlines; ++i)
+	  res[k].push_back(ok[i] ? col[k][i] : nan);
+      continue;
+    }
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+    for (int t = 0; t < nt; ++t) {
+      std::string& os = out[t];
+      os.clear();
+      int
+	i0 = int(double(nlines) * t / nt),
+	i1 = int(double(nlines) * (t + 1) / nt);
+      for (int i = i0; i < i1; ++i) {
+	if (ok[i])
+	  Format(mode, full, dms, prec, col, i, os);
+	else {
+	  // Write error message to the output so output lines match input
+	  // lines
+	  os += "ERROR: ";
+	  os += msg[i];
+	  msg[i].clear();
+	}
+	os += '\n';
+      }
+    }
+    for (int t = 0; t < nt; ++t)
+      fwrite(out[t].data(), 1, out[t].size(), stdout);
+  }
+  fflush(stdout);
+  return retval;
+}
+
+// Are the input quantities in row i of col (from a binary record) legal?
+bool Legal(int mode, const std::vector<double> col[], int i) {
+  return mode == LINE ||
+    (std::abs(col[LAT1][i]) <= 90 &&
+     col[LON1][i] >= -180 && col[LON1][i] <= 360 &&
+     (mode == INVERSE ?
+      std::abs(col[LAT2][i]) <= 90 &&
+      col[LON2][i] >= -180 && col[LON2][i] <= 360 :
+      col[AZI1][i] >= -180 && col[AZI1][i] <= 360));
+}
+
+// Reduce the longitudes and azimuth in the legal row i of col from [180, 360]
+// to [-180, 180) as DMS::DecodeLatLon and ReadAzimuth do for text input.
+void Reduce(int mode, std::vector<double> col[], int i) {
+  if (mode == LINE)
+    return;
+  if (col[LON1][i] >= 180)
+    col[LON1][i] -= 360;
+  if (mode == INVERSE) {
+    if (col[LON2][i] >= 180)
+      col[LON2][i] -= 360;
+  } else if (col[AZI1][i] >= 180)
+    col[AZI1][i] -= 360;
+}
+
+// Process binary records from standard input in blocks using nthreads
+// threads.  Return 1 if there were any errors.
+int BinaryStream(int nthreads, int mode, bool full,
+		 const GeographicLib::Geodesic& geod,
+		 const GeographicLib::GeodesicLine& l, const double g0[]) {
+  GeographicLib::Utility::SetThreads(nthreads);
+  int nin, nout;
+  const int
+    *in = Inputs(mode, nin),
+    *out = Outputs(mode, full, nout);
+  const int blockrecs = 1 << 16;
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<double> inbuf(blockrecs * nin), outbuf(blockrecs * nout);
+  std::vector<double> col[NCOL];
+  std::vector<char> ok;
+  int retval = 0;
+  for (bool eof = false; !eof;) {
+    size_t
+      size = blockrecs * nin * sizeof(double),
+      nread = fread(&inbuf[0], 1, size, stdin);
+    eof = nread < size;
+    if (nread % (nin * sizeof(double))) {
+      std::cerr << "ERROR: Incomplete record at end of input\n";
+      retval = 1;
+    }
+    int n = int(nread / (nin * sizeof(double)));
+    GeographicLib::Utility::LittleEndian(&inbuf[0], n * nin);
+    Resize(n, g0, col);
+    ok.assign(n, 1);
+    for (int i = 0; i < n; ++i) {
+      const double* r = &inbuf[i * nin];
+      for (int k = 0; k < nin; ++k)
+	col[in[k]][i] = r[k];
+      if (!Legal(mode, col, i)) {
+	// Solve with harmless values in the illegal rows
+	ok[i] = 0;
+	for (int k = 0; k < NCOL; ++k)
+	  col[k][i] = g0[k];
+	retval = 1;
+      } else
+	Reduce(mode, col, i);
+    }
+    Solve(mode, geod, l, n, col);
+    for (int i = 0; i < n; ++i) {
+      if (!ok[i]) {
+	for (int k = 0; k < NCOL; ++k)
+	  col[k][i] = nan;
+	for (int k = 0; k < nin; ++k)
+	  col[in[k]][i] = inbuf[i * nin + k];
+      }
+      double* r = &outbuf[i * nout];
+      for (int k = 0; k < nout; ++k)
+	r[k] = col[out[k]][i];
+    }
+    GeographicLib::Utility::LittleEndian(&outbuf[0], n * nout);
+    fwrite(&outbuf[0], sizeof(double), n * nout, stdout);
+  }
+  fflush(stdout);
+  return retval;
+}
+
+// Solve the geodesics in the point file infile (or on the lines of standard
+// input if infile is empty) using nthreads threads, writing the results to
+// the point file outfile (or as lines to standard output if outfile is
+// empty).  Return 1 if there were any errors.
+int Files(const std::string& infile, const std::string& outfile,
+	  int nthreads, int mode, bool full, bool dms, int prec,
+	  const GeographicLib::Geodesic& geod,
+	  const GeographicLib::GeodesicLine& l, const double g0[]) {
+  int nin, nout;
+  const int
+    *in = Inputs(mode, nin),
+    *out = Outputs(mode, full, nout);
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  int retval = 0;
+  try {
+    GeographicLib::PointFile ifile, ofile;
+    if (infile.empty()) {
+      std::vector<double> res[NCOL];
+      retval = Stream(nthreads, mode, full, dms, prec, geod, l, g0, res);
+      size_t n = res[0].size();
+      ofile.Create(outfile, n, ColumnNames(out, nout), false);
+      for (int k = 0; n && k < nout; ++k)
+	std::copy(res[out[k]].begin(), res[out[k]].end(), ofile.Data(k));
+      ofile.Close();
+      return retval;
+    }
+    nthreads = GeographicLib::Utility::SetThreads(nthreads);
+    ifile.Open(infile);
+    const double* src[4];
+    for (int k = 0; k < nin; ++k)
+      src[k] = ifile.Data(colnames[in[k]]);
+    size_t n = ifile.Size();
+    bool text = outfile.empty();
+    if (!text)
+      ofile.Create(outfile, n, ColumnNames(out, nout), false, &ifile);
+    // Don't give a thread fewer lines than this; the text output is written
+    // after each block of points.
+    const int minlines = 1000, blocksize = 1 << 16;
+    std::vector<double> col[NCOL];
+    std::vector<char> ok;
+    std::vector<std::string> os(nthreads);
+    for (size_t i0 = 0; i0 < n; i0 += blocksize) {
+      int
+	m = int(std::min(size_t(blocksize), n - i0)),
+	nt = std::max(1, std::min(nthreads, m / minlines));
+      Resize(m, g0, col);
+      ok.assign(m, 1);
+      for (int i = 0; i < m; ++i) {
+	for (int k = 0; k < nin; ++k)
+	  col[in[k]][i] = src[k][i0 + i];
+	if (!Legal(mode, col, i)) {
+	  // Solve with harmless values in the illegal rows
+	  ok[i] = 0;
+	  for (int k = 0; k < NCOL; ++k)
+	    col[k][i] = g0[k];
+	  retval = 1;
+	} else
+	  Reduce(mode, col, i);
+      }
+      Solve(mode, geod, l, m, col);
+      if (!text) {
+	for (int i = 0; i < m; ++i)
+	  if (!ok[i]) {
+	    for (int k = 0; k < NCOL; ++k)
+	      col[k][i] = nan;
+	    for (int k = 0; k < nin; ++k)
+	      col[in[k]][i] = src[k][i0 + i];
+	  }
+	for (int k = 0; k < nout; ++k)
+	  std::copy(col[out[k]].begin(), col[out[k]].end(),
+		    ofile.Data(k) + i0);
+	continue;
+      }
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+      for (int t = 0; t < nt; ++t) {
+	std::string& s = os[t];
+	s.clear();
+	int
+	  j0 = int(double(m) * t / nt),
+	  j1 = int(double(m) * (t + 1) / nt);
+	for (int i = j0; i < j1; ++i) {
+	  if (ok[i])
+	    Format(mode, full, dms, prec, col, i, s);
+	  else
+	    s += "ERROR: Illegal latitude, longitude, or azimuth";
+	  s += '\n';
+	}
+      }
+      for (int t = 0; t < nt; ++t)
+	fwrite(os[t].data(), 1, os[t].size(), stdout);
+    }
+    if (text)
+      fflush(stdout);
+    ofile.Close();
+  }
+  catch (std::runtime_error& e) {
+    std::cerr << "ERROR: " << e.what() << "\n";
+    return 1;
+  }
+  return retval;
+}
+
 int main(int argc, char* argv[]) {
   bool linecalc = false, inverse = false, international = false,
-    dms = false, full = false;
-  double lat1, lon1, azi1, lat2, lon2, azi2, s12;
+    dms = false, full = false, binary = false;
+  double lat1, lon1, azi1;
   int prec = 3;
+  int nthreads = -1;		// -1 = line at a time
+  std::string infile, outfile;
 
   for (int m = 1; m < argc; ++m) {
     std::string arg = std::string(argv[m]);
@@ -151,6 +669,19 @@ int main(int argc, char* argv[]) {
       std::string a = std::string(argv[m]);
       std::istringstream str(a);
       if (!(str >> prec)) return usage(1);
+    } else if (arg == "-b")
+      binary = true;
+    else if (arg == "-j") {
+      if (++m == argc) return usage(1);
+      std::string a = std::string(argv[m]);
+      std::istringstream str(a);
+      if (!(str >> nthreads) || nthreads < 0) return usage(1);
+    } else if (arg == "-R") {
+      if (++m == argc) return usage(1);
+      infile = std::string(argv[m]);
+    } else if (arg == "-W") {
+      if (++m == argc) return usage(1);
+      outfile = std::string(argv[m]);
     } else
       return usage(arg != "-h");
   }
@@ -159,63 +690,39 @@ int main(int argc, char* argv[]) {
   const GeographicLib::Geodesic& geod = international ? internat :
     GeographicLib::Geodesic::WGS84;
   GeographicLib::GeodesicLine l;
-  if (linecalc)
+  int mode = inverse ? INVERSE : DIRECT;
+  double g0[NCOL] = {0, 0, 0, 0, 0, 0, 0};
+  if (linecalc) {
     l = geod.Line(lat1, lon1, azi1);
+    mode = LINE;
+    g0[LAT1] = lat1;
+    g0[LON1] = lon1;
+    g0[AZI1] = azi1;
+  }
 
   // Max precision = 9: 1 nm in distance, 10^-14 deg (= 1.1 nm),
   // 10^-10 sec (= 3 nm).
   prec = std::min(10, std::max(0, prec));
-  std::cout << std::fixed << std::setprecision(prec);
-  std::string s;
+  if (!(infile.empty() && outfile.empty()))
+    return Files(infile, outfile, nthreads, mode, full, dms, prec,
+		 geod, l, g0);
+  if (binary)
+    return BinaryStream(nthreads, mode, full, geod, l, g0);
+  if (nthreads >= 0)
+    return Stream(nthreads, mode, full, dms, prec, geod, l, g0);
+  std::vector<double> col[NCOL];
+  std::string s, os, msg;
   int retval = 0;
   while (std::getline(std::cin, s)) {
-    try {
-      std::istringstream str(s);
-      if (linecalc) {
-	if (!(str >> s12))
-	  throw std::out_of_range("Incomplete input: " + s);
-	l.Position(s12, lat2, lon2, azi2);
-	if (full)
-	  std::cout << LatLonString(lat1, lon1, prec, dms) << " " <<
-	    AzimuthString(azi1, prec, dms) << " ";
-	std::cout << LatLonString(lat2, lon2, prec, dms) << " " <<
-	  AzimuthString(azi2, prec, dms);
-	if (full)
-	  std::cout << " " << s12;
-	std::cout << "\n";
-      } else if (inverse) {
-	std::string slat1, slon1, slat2, slon2;
-	if (!(str >> slat1 >> slon1 >> slat2 >> slon2))
-	  throw std::out_of_range("Incomplete input: " + s);
-	GeographicLib::DMS::DecodeLatLon(slat1, slon1, lat1, lon1);
-	GeographicLib::DMS::DecodeLatLon(slat2, slon2, lat2, lon2);
-	geod.Inverse(lat1, lon1, lat2, lon2, s12, azi1, azi2);
-	if (full)
-	  std::cout << LatLonString(lat1, lon1, prec, dms) << " ";
-	std::cout << AzimuthString(azi1, prec, dms) << " ";
-	if (full)
-	  std::cout << LatLonString(lat2, lon2, prec, dms) << " ";
-	std::cout << AzimuthString(azi2, prec, dms) << " " << s12 << "\n";
-      } else {
-	std::string slat1, slon1, sazi1;
-	if (!(str >> slat1 >> slon1 >> sazi1 >> s12))
-	  throw std::out_of_range("Incomplete input: " + s);
-	GeographicLib::DMS::DecodeLatLon(slat1, slon1, lat1, lon1);
-	azi1 = ReadAzimuth(sazi1);
-	geod.Direct(lat1, lon1, azi1, s12, lat2, lon2, azi2);
-	if (full)
-	  std::cout << LatLonString(lat1, lon1, prec, dms) << " " <<
-	    AzimuthString(azi1, prec, dms) << " ";
-	std::cout << LatLonString(lat2, lon2, prec, dms) << " " <<
-	  AzimuthString(azi2, prec, dms);
-	if (full)
-	  std::cout << " " << s12;
-	std::cout << "\n";
-      }
-    }
-    catch (std::out_of_range& e) {
+    Resize(1, g0, col);
+    if (Read(s.data(), int(s.size()), mode, col, 0, msg)) {
+      Solve(mode, geod, l, 1, col);
+      os.clear();
+      Format(mode, full, dms, prec, col, 0, os);
+      std::cout << os << std::endl;
+    } else {
       // Write error message cout so output lines match input lines
-      std::cout << "ERROR: " << e.what() << "\n";
+      std::cout << "ERROR: " << msg << std::endl;
       retval = 1;
     }
   }
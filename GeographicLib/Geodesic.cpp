@@ -26,7 +26,10 @@
  **********************************************************************/
 
 #include "GeographicLib/Geodesic.hpp"
+#include "GeographicLib/Stats.hpp"
 #include "GeographicLib/Constants.hpp"
+#include "GeographicLib/Parallel.hpp"
+#include <new>
 #include <algorithm>
 #include <limits>
 
@@ -39,12 +42,6 @@ namespace GeographicLib {
 
   using namespace std;
 
-  // Underflow guard.  We require
-  //   eps2 * epsilon() > 0
-  //   eps2 + epsilon() == epsilon()
-  const double Geodesic::eps2 = sqrt(numeric_limits<double>::min());
-  const double Geodesic::tol = 100 * numeric_limits<double>::epsilon();
-
   Geodesic::Geodesic(double a, double invf) throw()
     : _a(a)
     , _f(invf > 0 ? 1 / invf : 0)
@@ -54,8 +51,24 @@ namespace GeographicLib {
     , _b(_a * _f1)
   {}
 
-  const Geodesic Geodesic::WGS84(Constants::WGS84_a(),
-				 Constants::WGS84_invf());
+  namespace {
+    // Storage for WGS84 (zero until Init constructs it).
+    union {
+      double align;
+      char data[sizeof(Geodesic)];
+    } wgs84store;
+  }
+
+  const Geodesic& Geodesic::WGS84 =
+    *reinterpret_cast<const Geodesic*>(wgs84store.data);
+
+  int Geodesic::Init::_count = 0;
+
+  Geodesic::Init::Init() throw() {
+    if (_count++ == 0)
+      new (wgs84store.data) Geodesic(Constants::WGS84_a(),
+				     Constants::WGS84_invf());
+  }
 
   double Geodesic::SinSeries(double sinx, double cosx,
 			     const double c[], int n) throw() {
@@ -129,6 +142,70 @@ namespace GeographicLib {
     d[7] = 109167851 * t / 5411658792960.0;
   }
 
+  // The scale factor for I2(sigma) = int(1/sqrt(1 + u2 * sin(sigma)^2)), which
+  // is needed for the reduced length.  This and i2Coeff are the counterparts
+  // of tauScale and tauCoeff for I1(sigma) = tau(sigma) * tauScale = s / b.
+  double Geodesic::i2Scale(double u2) throw() {
+    return (u2 * (u2 * (u2 * (u2 * (u2 * (u2 * (u2 * (41409225 * u2 -
+	   47114496) + 54641664) - 65028096) + 80281600) - 104857600) +
+	   150994944) - 268435456) + 1073741824.0) / 1073741824.0;
+  }
+
+  // Coefficients of sine series for I2(sigma) / i2Scale - sigma.
+  void Geodesic::i2Coeff(double u2, double c[]) throw() {
+    double t = u2;
+    c[0] = t * (u2 * (u2 * (u2 * (u2 * (u2 * ((996818 - 848479 * u2) * u2 -
+	   1199104) + 1488896) - 1933312) + 2686976) - 4194304) + 8388608) /
+	   67108864;
+    t  *= u2;
+    c[1] = t * (u2 * (u2 * (u2 * (u2 * (u2 * (1660363 * u2 - 1867040) +
+	   2118752) - 2424832) + 2785280) - 3145728) + 3145728) / 268435456;
+    t  *= u2;
+    c[2] = t * (u2 * (u2 * (u2 * ((564858 - 545643 * u2) * u2 - 572800) +
+	   556800) - 491520) + 327680) / 201326592;
+    t  *= u2;
+    c[3] = t * (u2 * (u2 * (u2 * (1039493 * u2 - 942592) + 792064) -
+	   573440) + 286720) / 1073741824.0;
+    t  *= u2;
+    c[4] = t * (((65730 - 88935 * u2) * u2 - 40320) * u2 + 16128) / 335544320;
+    t  *= u2;
+    c[5] = t * (u2 * (13893 * u2 - 7392) + 2464) / 268435456;
+    t  *= u2;
+    c[6] = t * (858 - 3003 * u2) / 469762048;
+    t  *= u2;
+    c[7] = 6435 * t / 17179869184.0;
+  }
+
+  void Geodesic::Scales(double b, double u2, double sig12,
+			double ssig1, double csig1, double ssig2, double csig2,
+			double tau12,
+			double& m12, double& M12, double& M21) throw() {
+    // See Karney, Geodesics on an ellipsoid of revolution, Sec. 4.  With
+    // k2 = u2, dn(sig) = sqrt(1 + k2 * sin(sig)^2), and J(sig) = I1(sig) -
+    // I2(sig),
+    //
+    //   m12 = b * (dn(sig2) * cos(sig1) * sin(sig2) -
+    //              dn(sig1) * sin(sig1) * cos(sig2) -
+    //              cos(sig1) * cos(sig2) * (J(sig2) - J(sig1)))
+    //
+    // tau12 = I1(sig2) - I1(sig1) has already been found (it's s12 / b).
+    double c[maxpow];
+    i2Coeff(u2, c);
+    double
+      j12 = tau12 - i2Scale(u2) *
+      (sig12 + (SinSeries(ssig2, csig2, c, maxpow) -
+		SinSeries(ssig1, csig1, c, maxpow))),
+      w1 = sqrt(1 + u2 * sq(ssig1)),
+      w2 = sqrt(1 + u2 * sq(ssig2)),
+      csig12 = csig1 * csig2 + ssig1 * ssig2,
+      // u2 * (sin(sig2)^2 - sin(sig1)^2) / (dn(sig1) + dn(sig2))
+      t = u2 * (ssig2 - ssig1) * (ssig2 + ssig1) / (w1 + w2);
+    m12 = b * ((w2 * (csig1 * ssig2) - w1 * (ssig1 * csig2)) -
+	       csig1 * csig2 * j12);
+    M12 = csig12 + (t * ssig2 - csig2 * j12) * ssig1 / w1;
+    M21 = csig12 - (t * ssig1 - csig1 * j12) * ssig2 / w2;
+  }
+
   double Geodesic::dlamScale(double f, double mu) throw() {
     double g = (f * (f * (f * (f * (f * (f * (f * mu * (mu * (mu * (mu * (mu * (mu *
            (184041 * mu - 960498) + 2063880) - 2332400) + 1459200) - 479232) +
@@ -251,9 +328,372 @@ namespace GeographicLib {
     l.Position(s12, lat2, lon2, azi2);
   }
 
+  void Geodesic::Direct(double lat1, double lon1, double azi1, double s12,
+			double& lat2, double& lon2, double& azi2,
+			double& m12, double& M12, double& M21)
+    const throw() {
+    GeodesicLine l(*this, lat1, lon1, azi1);
+    l.Position(s12, lat2, lon2, azi2, m12, M12, M21);
+  }
+
+  void Geodesic::Direct(int n, const double lat1[], const double lon1[],
+			const double azi1[], const double s12[],
+			double lat2[], double lon2[], double azi2[])
+    const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Direct(lat1[i], lon1[i], azi1[i], s12[i], lat2[i], lon2[i], azi2[i]);
+  }
+
+  void Geodesic::DirectFan(double lat1, double lon1, int n,
+			   const double azi1[], const double s12[],
+			   double lat2[], double lon2[], double azi2[])
+    const throw() {
+    if (abs(lat1) == 90) {
+      // The azimuths shift the longitude at a pole; nothing to share.
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+      for (int i = 0; i < n; ++i)
+	Direct(lat1, lon1, azi1[i], s12[i], lat2[i], lon2[i], azi2[i]);
+      return;
+    }
+    lon1 = AngNormalize(lon1);
+    double
+      phi = lat1 * Constants::degree(),
+      sbet1 = _f1 * sin(phi),
+      cbet1 = cos(phi);
+    SinCosNorm(sbet1, cbet1);
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; i += fanblock)
+      DirectFan(lat1, lon1, sbet1, cbet1, min(int(fanblock), n - i),
+		azi1 + i, s12 + i, lat2 + i, lon2 + i, azi2 + i);
+  }
+
+  void Geodesic::DirectFan(double lat1, double lon1,
+			   double sbet1, double cbet1, int n,
+			   const double azi1[], const double s12[],
+			   double lat2[], double lon2[], double azi2[])
+    const throw() {
+    // Set up the lines for a block of azimuths in stages.  The scales are
+    // evaluated in loops over the block which the compiler can vectorize.
+    GeodesicLine l[fanblock];
+    double mu[fanblock], u2[fanblock], tscale[fanblock], lscale[fanblock];
+    for (int i = 0; i < n; ++i)
+      mu[i] = l[i].Start(*this, lat1, lon1, AngNormalize(azi1[i]),
+			 sbet1, cbet1);
+    if (_f1 == 1) {
+      for (int i = 0; i < n; ++i)
+	l[i].Sphere(*this);
+    } else {
+      for (int i = 0; i < n; ++i)
+	u2[i] = mu[i] * _ep2;
+      for (int i = 0; i < n; ++i)
+	tscale[i] = _b * tauScale(u2[i]);
+      for (int i = 0; i < n; ++i)
+	lscale[i] = dlamScale(_f, mu[i]);
+      for (int i = 0; i < n; ++i) {
+	l[i]._sScale = tscale[i];
+	tauCoeff(u2[i], l[i]._tauCoeff);
+	sigCoeff(u2[i], l[i]._sigCoeff);
+	l[i]._u2 = u2[i];
+	l[i]._dlamScale = l[i]._salp0 * lscale[i];
+	dlamCoeff(_f, mu[i], l[i]._dlamCoeff);
+	l[i].Finish();
+      }
+    }
+    for (int i = 0; i < n; ++i)
+      l[i].Position(s12[i], lat2[i], lon2[i], azi2[i]);
+  }
+
+  void Geodesic::Inverse(int n, const double lat1[], const double lon1[],
+			 const double lat2[], const double lon2[],
+			 double s12[], double azi1[], double azi2[])
+    const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Inverse(lat1[i], lon1[i], lat2[i], lon2[i], s12[i], azi1[i], azi2[i]);
+  }
+
+  void Geodesic::Inverse(int n, const double lat1[], const double lon1[],
+			 const double lat2[], const double lon2[], double tol,
+			 double s12[], double azi1[], double azi2[])
+    const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Inverse(lat1[i], lon1[i], lat2[i], lon2[i], tol,
+	      s12[i], azi1[i], azi2[i]);
+  }
+
   void Geodesic::Inverse(double lat1, double lon1, double lat2, double lon2,
+			 double tol,
 			 double& s12, double& azi1, double& azi2)
     const throw() {
+    GEOGRAPHICLIB_COUNT(Stats::GEOD_LOCAL);
+    if (tol > 0 && Local(lat1, lon1, lat2, lon2, tol, s12, azi1, azi2))
+      GEOGRAPHICLIB_COUNT(Stats::GEOD_LOCAL_HIT);
+    else
+      Inverse(lat1, lon1, lat2, lon2, s12, azi1, azi2);
+  }
+
+  void Geodesic::CrossTrack(const GeodesicLine& line, double lat, double lon,
+			    double& s12, double& xtrack,
+			    double& lat2, double& lon2) const throw() {
+    const int maxit = 10;
+    const double eps = _a * tol(), stol = 0.01 * _a * sqrt(tol());
+    // On a sphere of radius R, the right triangle with hypotenuse s (from
+    // point 1 to the point) and angle alp at point 1 has tan(s12/R) =
+    // tan(s/R) * cos(alp).
+    double
+      R = (2 * _a + _b) / 3,
+      s, azi1, azi2, azi0, m12, M12, M21, alp;
+    Inverse(line.Latitude(), line.Longitude(), lat, lon, eps, s, azi1, azi2);
+    alp = (azi1 - line.Azimuth()) * Constants::degree();
+    s12 = R * atan2(sin(s / R) * cos(alp), cos(s / R));
+    for (int i = 0;; ++i) {
+      line.Position(s12, lat2, lon2, azi0);
+      // For short distances m12 = s and M12 = 1 is good enough for Newton's
+      // method (and avoids GenInverse for nearly coincident points).  s and
+      // azi1 also give xtrack, so they are needed to within a few nm.
+      if (Local(lat2, lon2, lat, lon, eps / 20, s, azi1, azi2)) {
+	m12 = s; M12 = 1;
+      } else
+	GenInverse(lat2, lon2, lat, lon, true,
+		   s, azi1, azi2, m12, M12, M21);
+      alp = (azi1 - azi0) * Constants::degree();
+      // The Newton step m12 * cos(alp) / M12, written as an arc tangent so
+      // that it is bounded when M12 is small.
+      double ds = R * atan2(m12 * cos(alp), R * M12);
+      s12 += ds;
+      // Convergence is quadratic, so this last step leaves an error of
+      // order ds^2 / R.
+      if (!(abs(ds) > stol) || i == maxit - 1) {
+	// The foot is off by ds, so the cross-track distance is the other
+	// side of the spherical right triangle.
+	xtrack = R * asin(sin(s / R) * sin(alp));
+	if (ds != 0)
+	  line.Position(s12, lat2, lon2, azi0);
+	break;
+      }
+    }
+  }
+
+  bool Geodesic::Local(double lat1, double lon1, double lat2, double lon2,
+		       double tol,
+		       double& s12, double& azi1, double& azi2)
+    const throw() {
+    // On the auxiliary sphere the geodesic is the great circle from (beta1,
+    // 0) to (beta2, lam12) and the azimuths are the same as on the
+    // ellipsoid.  With
+    //
+    //   h(beta) = sqrt(1 + ep2 * sin(beta)^2)
+    //   g(beta) = (2 - f) / (1 + (1 - f) * h(beta))
+    //   q(beta) = 1 - f * g(beta) * cos(beta)^2
+    //
+    // the distance and longitude are given exactly by
+    //
+    //   s12 = b * int h(beta) dsig,   chi12 = int q(beta) dlam
+    //
+    // taken along the great circle (this is the usual integral for chi
+    // with dsig = cos(beta)^2/sin(alp0) dlam and k^2 sin(sig)^2 = ep2
+    // sin(beta)^2).  Evaluating h and q at betm = (beta1 + beta2)/2 gives
+    //
+    //   lam12 = chi12 / q(betm),   s12 = b * h(betm) * sig12
+    //
+    // and sig12 and the azimuths then follow exactly from Gauss's (or
+    // Delambre's) analogies
+    //
+    //   sin(sig12/2) * sin(alpm)   = sin(lam12/2) * cos(betm)
+    //   sin(sig12/2) * cos(alpm)   = sin(beta12/2) * cos(lam12/2)
+    //   cos(sig12/2) * sin(alp12/2) = sin(lam12/2) * sin(betm)
+    //   cos(sig12/2) * cos(alp12/2) = cos(beta12/2) * cos(lam12/2)
+    //
+    // where alpm = (alp1 + alp2)/2 and alp12 = alp2 - alp1.  The only
+    // approximations are the values of h and q.  Bound the errors as
+    // follows (f >= 0):
+    //
+    // (1) g <= 1 so q >= 1 - f and |lam12| <= |chi12|/(1 - f).  The path
+    //     linear in beta and lam has length at most sqrt(beta12^2 +
+    //     cos(beta)^2 lam12^2), with the largest cos(beta) between beta1
+    //     and beta2; this bounds sig12 by S.  Each point of the great
+    //     circle is within sig12 of both ends, so its latitude is within
+    //     d = S/2 of betm.  cos(beta) and |sin(beta)| on the path are
+    //     therefore at least cl = cos(betm) (1 - d^2/2) - |sin(betm)| d and
+    //     at most ch = cos(betm) + |sin(betm)| d and sh = |sin(betm)| +
+    //     cos(betm) d.
+    //
+    // (2) On a great circle dbeta/dsig = cos(alp), dalp/dsig = sin(alp)
+    //     tan(beta), and sin(alp) cos(beta) = sin(alp0), so d^2beta/dsig^2
+    //     = -sin(alp)^2 tan(beta) and d^2beta/dlam^2 = -sin(beta)
+    //     cos(beta)^3 (1 + cos(alp)^2) / sin(alp0)^2.  The trapezoidal rule
+    //     bounds the difference between betm and the mean of beta over sig
+    //     by S^2 sh/(12 cl) and over lam by S^2 sh ch^3/(6 cl^4) (using
+    //     |lam12| <= |sin(alp0)| S / cl^2).
+    //
+    // (3) Expanding q and h to second order about betm with
+    //     |q'(betm)| <= f cos(betm) |sin(betm)| (2 + ep2/2),
+    //     |q''| <= f (2 + ep2 + ep2^2/4),
+    //     |h'(betm)| <= ep2 cos(betm) |sin(betm)|,
+    //     |h''| <= ep2 + ep2^2/4,
+    //     and |beta - betm| <= d gives the relative error in lam12
+    //
+    //       el = (|q'| S^2 sh ch^3/(6 cl^4) + |q''| S^2/8) / (1 - f)
+    //
+    //     and the error in int h dsig of (|h'| sh/(12 cl) + |h''|/8) S^3.
+    //
+    // (4) With dl = el |chi12|/(1 - f), the largest error in lam12, the
+    //     derivatives dsig12/dlam12 = cos(beta2) sin(alp2), dalp1/dlam12 =
+    //     cos(beta2) cos(alp2)/sin(sig12), and dalp2/dlam12 = cos(sig12)
+    //     dalp1/dlam12 - sin(beta2) give the errors in s12 and in s12 times
+    //     the azimuths (s12 <= a S)
+    //
+    //       b ((|h'| sh/(12 cl) + |h''|/8) S^3 + h(betm) ch dl)
+    //       a S (ch/sin(sig12 - ch dl) + sh) dl
+    //
+    // The larger of these is the bound; it is of order f s12 sig12^2.  To
+    // it is added the roundoff, 16 epsilon s12 + 4 epsilon b.  The first
+    // term allows for relative errors of 8 epsilon in sin(beta12) and chi12,
+    // which are computed from the differences of the arguments, and for the
+    // 26 or so operations after that, each accurate to an ulp.  The second
+    // allows for the absolute error of up to 2^-45 degrees in chi12 when the
+    // longitudes are on either side of the 180th meridian.  Errors in betm
+    // only enter multiplied by lam12 or beta12.  The approximation is not
+    // used if cl <= 0 (the path might go over a pole).
+    double
+      phi12 = (lat2 - lat1) * Constants::degree(),
+      chi12 = AngNormalize(AngNormalize(lon2) - AngNormalize(lon1)) *
+      Constants::degree();
+    if (!(abs(phi12) <= localmax() && abs(chi12) <= localmax()))
+      return false;
+    double
+      phi1 = lat1 * Constants::degree(),
+      phi2 = lat2 * Constants::degree(),
+      sphi1 = sin(phi1), cphi1 = cos(phi1),
+      sphi2 = sin(phi2), cphi2 = cos(phi2),
+      n1 = hypot(cphi1, _f1 * sphi1),
+      sbet1 = _f1 * sphi1 / n1, cbet1 = cphi1 / n1,
+      // sin(beta12) = (1 - f) * sin(phi12) / (n1 * n2), so beta12 is accurate
+      // to a few ulps even when the points are close.
+      sbet12 = _f1 * sin(phi12) / (n1 * hypot(cphi2, _f1 * sphi2)),
+      // The sine and cosine of beta12/2 and of betm = beta1 + beta12/2
+      cbeta = sqrt((1 + sqrt(1 - sq(sbet12))) / 2),
+      sbeta = sbet12 / (2 * cbeta),
+      sbetm = sbet1 * cbeta + cbet1 * sbeta,
+      cbetm = cbet1 * cbeta - sbet1 * sbeta,
+      h = sqrt(1 + _ep2 * sq(sbetm)),
+      lam12 = chi12 / (1 - _f * (2 - _f) / (1 + _f1 * h) * sq(cbetm)),
+      slam = sin(lam12 / 2), clam = cos(lam12 / 2),
+      x = slam * cbetm, y = sbeta * clam,
+      z = slam * sbetm, w = cbeta * clam,
+      sig12 = 2 * atan2(hypot(x, y), hypot(z, w));
+    // Leave coincident points to Inverse which fixes the azimuths
+    if (!(sig12 > 0))
+      return false;
+    // The error bound
+    sbetm = abs(sbetm);
+    double
+      // |beta12|/2 <= |tan(beta12/2)|
+      d = abs(sbeta) / cbeta,
+      S = hypot(2 * d, min(1.0, cbetm + sbetm * d) * abs(chi12) / _f1);
+    d = S / 2;
+    double
+      cl = cbetm * (1 - sq(d) / 2) - sbetm * d,
+      ch = min(1.0, cbetm + sbetm * d),
+      sh = min(1.0, sbetm + cbetm * d);
+    if (!(cl > 0))
+      return false;
+    double
+      q1 = _f * cbetm * sbetm * (2 + _ep2 / 2),
+      q2 = _f * (2 + _ep2 + sq(_ep2) / 4),
+      h1 = _ep2 * cbetm * sbetm,
+      h2 = _ep2 + sq(_ep2) / 4,
+      dl = (q1 * sh * sq(ch) * ch / (6 * sq(sq(cl))) + q2 / 8) * sq(S) *
+      abs(chi12) / sq(_f1),
+      sig = sig12 - ch * dl;
+    if (!(sig > 0))
+      return false;
+    double
+      s = _b * h * sig12,
+      err = max(_b * ((h1 * sh / (12 * cl) + h2 / 8) * sq(S) * S +
+		       h * ch * dl),
+		_a * S * (ch / (sig * (1 - sq(sig) / 6)) + sh) * dl) +
+      numeric_limits<double>::epsilon() * (16 * s + 4 * _b);
+    if (!(err <= tol))
+      return false;
+    s12 = s;
+    double
+      alpm = atan2(x, y),
+      alp12 = 2 * atan2(z, w);
+    azi1 = AngNormalize((alpm - alp12 / 2) / Constants::degree());
+    azi2 = AngNormalize((alpm + alp12 / 2) / Constants::degree());
+    return true;
+  }
+
+  void Geodesic::Inverse(double lat1, double lon1, double lat2, double lon2,
+			 double& s12, double& azi1, double& azi2)
+    const throw() {
+    double m12, M12, M21;
+    GenInverse(lat1, lon1, lat2, lon2, false, s12, azi1, azi2, m12, M12, M21);
+  }
+
+  void Geodesic::Inverse(double lat1, double lon1, double lat2, double lon2,
+			 double& s12, double& azi1, double& azi2,
+			 double& m12, double& M12, double& M21)
+    const throw() {
+    GenInverse(lat1, lon1, lat2, lon2, true, s12, azi1, azi2, m12, M12, M21);
+  }
+
+  void Geodesic::InverseJacobian(double lat1, double lon1,
+				 double lat2, double lon2,
+				 double& s12, double& azi1, double& azi2,
+				 double jac[]) const throw() {
+    double m12, M12, M21;
+    GenInverse(lat1, lon1, lat2, lon2, true, s12, azi1, azi2, m12, M12, M21);
+    // For each end point, resolve the displacements due to unit changes
+    // (degrees) in lat and lon into components along the geodesic and to its
+    // right.  A displacement dt to the right at point 2 changes azi1 by dt /
+    // m12 and azi2 by M21 * dt / m12; one at point 1 changes azi1 by - M12 *
+    // dt / m12 and azi2 by - dt / m12.  In addition, moving a point east
+    // rotates the meridian there, so that the azimuth at that point changes
+    // by sin(phi) * dlon.
+    for (int j = 0; j < 2; ++j) {
+      double
+	lat = j ? lat2 : lat1,
+	phi = lat * Constants::degree(),
+	w2 = 1 - _e2 * sq(sin(phi)),
+	// The displacements north and east (meters per degree)
+	north = _a * sq(_f1) / (w2 * sqrt(w2)) * Constants::degree(),
+	east = (abs(lat) == 90 ? 0 : _a * cos(phi) / sqrt(w2)) *
+	Constants::degree(),
+	alp = (j ? azi2 : azi1) * Constants::degree(),
+	salp = sin(alp), calp = cos(alp),
+	// Along and right components for lat and lon
+	alat = north * calp, alon = east * salp,
+	rlat = - north * salp / (m12 * Constants::degree()),
+	rlon = east * calp / (m12 * Constants::degree()),
+	sign = j ? 1 : -1,
+	// Factors for the changes in azi1 and azi2
+	f1 = j ? 1 : -M12, f2 = j ? M21 : -1;
+      jac[2*j + 0] = sign * alat; jac[2*j + 1] = sign * alon;
+      jac[2*j + 4] = f1 * rlat;   jac[2*j + 5] = f1 * rlon;
+      jac[2*j + 8] = f2 * rlat;   jac[2*j + 9] = f2 * rlon;
+      (j ? jac[11] : jac[5]) += sin(phi);
+    }
+  }
+
+  void Geodesic::GenInverse(double lat1, double lon1, double lat2, double lon2,
+			    bool scalep,
+			    double& s12, double& azi1, double& azi2,
+			    double& m12, double& M12, double& M21)
+    const throw() {
     lon1 = AngNormalize(lon1);
     double lon12 = AngNormalize(AngNormalize(lon2) - lon1);
     // If very close to being on the same meridian, then make it so.
@@ -292,7 +732,7 @@ namespace GeographicLib {
     phi = lat1 * Constants::degree();
     // Ensure cbet1 = +eps at poles
     sbet1 = _f1 * sin(phi);
-    cbet1 = lat1 == -90 ? eps2 : cos(phi);
+    cbet1 = lat1 == -90 ? eps2() : cos(phi);
     // n = sqrt(1 - e2 * sq(sin(phi)))
     n1 = hypot(sbet1, cbet1);
     sbet1 /= n1; cbet1 /= n1;
@@ -300,7 +740,7 @@ namespace GeographicLib {
     phi = lat2 * Constants::degree();
     // Ensure cbet2 = +eps at poles
     sbet2 = _f1 * sin(phi);
-    cbet2 = abs(lat2) == 90 ? eps2 : cos(phi);
+    cbet2 = abs(lat2) == 90 ? eps2() : cos(phi);
     SinCosNorm(sbet2, cbet2);
 
     double
@@ -314,9 +754,11 @@ namespace GeographicLib {
       schi12 = lon12 == 180 ? 0 :sin(chi12);
 
     double calp1, salp1, calp2, salp2, c[maxpow];
+    GEOGRAPHICLIB_COUNT(Stats::GEOD_INVERSE);
     // Enumerate all the cases where the geodesic is a meridian.  This includes
     // coincident points.
     if (schi12 == 0 || lat1 == -90) {
+      GEOGRAPHICLIB_COUNT(Stats::GEOD_MERIDIAN);
       // Head to the target longitude
       calp1 = cchi12; salp1 = schi12;
       // At the target we're heading north
@@ -337,12 +779,46 @@ namespace GeographicLib {
       s12 = _b * tauScale(_ep2) *
 	(sig12 + (SinSeries(ssig2, csig2, c, maxpow) -
 		  SinSeries(ssig1, csig1, c, maxpow)));
+      if (scalep)
+	Scales(_b, _ep2, sig12, ssig1, csig1, ssig2, csig2, s12 / _b,
+	       m12, M12, M21);
     } else if (sbet1 == 0 &&	// and sbet2 == 0
 	       // Mimic the way Chi12 works with calp1 = 0
 	       chi12 <= Constants::pi() - _f * Constants::pi()) {
       // Geodesic runs along equator
+      GEOGRAPHICLIB_COUNT(Stats::GEOD_EQUATORIAL);
       calp1 = calp2 = 0; salp1 = salp2 = 1;
       s12 = _a * chi12;
+      if (scalep) {
+	// On the equator, sig12 = s12 / b
+	double sig12 = chi12 / _f1;
+	m12 = _b * sin(sig12);
+	M12 = M21 = cos(sig12);
+      }
+    } else if (_f == 0) {
+      // On a sphere the geodesic is a great circle, so solve the spherical
+      // triangle directly.  (The expression for calp1 is the starting guess
+      // used below; that for calp2 is its counterpart at point 2.)
+      GEOGRAPHICLIB_COUNT(Stats::GEOD_SPHERE);
+      salp1 = cbet2 * schi12;
+      calp1 = cchi12 >= 0 ?
+	sbet12 + cbet2 * sbet1 * sq(schi12) / (1 + cchi12) :
+	sbet12a - cbet2 * sbet1 * sq(schi12) / (1 - cchi12);
+      salp2 = cbet1 * schi12;
+      calp2 = cchi12 >= 0 ?
+	sbet12 - cbet1 * sbet2 * sq(schi12) / (1 + cchi12) :
+	cbet1 * sbet2 * sq(schi12) / (1 - cchi12) - sbet12a;
+      double
+	ssig12 = hypot(salp1, calp1),
+	csig12 = sbet1 * sbet2 + cbet1 * cbet2 * cchi12;
+      SinCosNorm(salp1, calp1);
+      SinCosNorm(salp2, calp2);
+      s12 = _a * atan2(ssig12, csig12);
+      if (scalep) {
+	double h = hypot(ssig12, csig12);
+	m12 = _a * ssig12 / h;
+	M12 = M21 = csig12 / h;
+      }
     } else {
 
       // Now point1 and point2 belong within a hemisphere bounded by a line of
@@ -356,6 +832,7 @@ namespace GeographicLib {
 	chicrit = Constants::pi() - chicrita;
       if (chi12 == chicrit && cbet1 == cbet2 && sbet2 == -sbet1) {
 	salp1 = 1; calp1 = 0;	// The singular point
+	GEOGRAPHICLIB_COUNT(Stats::GEOD_START_SINGULAR);
 	// This leads to
 	//
 	// sig12 = Constants::pi(); ssig1 = -1; salp2 = ssig2 = 1;
@@ -366,10 +843,12 @@ namespace GeographicLib {
       } else if (chi12 > chicrit && cbet12a > 0 && sbet12a > - chicrita) {
 	salp1 = min(1.0, (Constants::pi() - chi12) / chicrita);
 	calp1 = - sqrt(1 - sq(salp1));
+	GEOGRAPHICLIB_COUNT(Stats::GEOD_START_ANTIPODAL);
       } else if (chi12 > Constants::pi() - 2 * chicrita &&
 		 cbet12a > 0 && sbet12a > - 2 * chicrita) {
 	salp1 = 1;
-	calp1 = sbet2 <= 0 ? -eps2 : eps2;
+	calp1 = sbet2 <= 0 ? -eps2() : eps2();
+	GEOGRAPHICLIB_COUNT(Stats::GEOD_START_EQUATORIAL);
       } else {
 	salp1 = cbet2 * schi12;
 	// calp1 = sbet2 * cbet1 - cbet2 * sbet1 * cchi12;
@@ -379,6 +858,7 @@ namespace GeographicLib {
 	  sbet12a - cbet2 * sbet1 * sq(schi12) / (1 - cchi12);
 	// N.B. ssig1 = hypot(salp1, calp1) (before normalization)
 	SinCosNorm(salp1, calp1);
+	GEOGRAPHICLIB_COUNT(Stats::GEOD_START_SHORT);
       }
 
       // Newton's method
@@ -388,8 +868,15 @@ namespace GeographicLib {
 			 salp1, calp1, salp2, calp2,
 			 sig12, ssig1, csig1, ssig2, csig2,
 			 u2, trip < 1, dv, c) - chi12;
-	if (v == 0 || !(trip < 1))
+	GEOGRAPHICLIB_COUNT(Stats::GEOD_ITERATIONS);
+	// Record the maximum here so that it includes calls which don't
+	// converge.
+	GEOGRAPHICLIB_MAX(Stats::GEOD_ITERATIONS_MAX, i + 1);
+	if (v == 0 || !(trip < 1)) {
+	  GEOGRAPHICLIB_COUNT(v == 0 ?
+			      Stats::GEOD_EXACT : Stats::GEOD_CONVERGED);
 	  break;
+	}
 	double
 	  dalp1 = -v/dv,
 	  sdalp1 = sin(dalp1), cdalp1 = cos(dalp1),
@@ -397,13 +884,16 @@ namespace GeographicLib {
 	calp1 = calp1 * cdalp1 - salp1 * sdalp1;
 	salp1 = max(0.0, nsalp1);
 	SinCosNorm(salp1, calp1);
-	if (abs(v) < tol) ++trip;
+	if (abs(v) < tol()) ++trip;
       }
 	
       tauCoeff(u2, c);
       s12 =  _b * tauScale(u2) *
 	(sig12 + (SinSeries(ssig2, csig2, c, maxpow) -
 		  SinSeries(ssig1, csig1, c, maxpow)));
+      if (scalep)
+	Scales(_b, u2, sig12, ssig1, csig1, ssig2, csig2, s12 / _b,
+	       m12, M12, M21);
     }
 
     // Convert calp, salp to head accounting for
@@ -412,6 +902,8 @@ namespace GeographicLib {
     if (swapp < 0) {
       swap(salp1, salp2);
       swap(calp1, calp2);
+      if (scalep)
+	swap(M12, M21);
     }
 
     // minus signs give range [-180, 180). 0- converts -0 to +0.
@@ -436,7 +928,7 @@ namespace GeographicLib {
     if (sbet1 == 0 && calp1 == 0)
       // Break degeneracy of equatorial line.  This cases has already been
       // handled.
-      calp1 = -eps2;
+      calp1 = -eps2();
 
     double
       // sin(alp1) * cos(bet1) = sin(alp0),
@@ -540,15 +1032,41 @@ namespace GeographicLib {
       lon1 += azi1;
       azi1 = 0;
     }
+    lon1 = Geodesic::AngNormalize(lon1);
+    double cbet1, sbet1, phi;
+    phi = lat1 * Constants::degree();
+    // Ensure cbet1 = +eps at poles
+    sbet1 = g._f1 * sin(phi);
+    cbet1 = abs(lat1) == 90 ? Geodesic::eps2() : cos(phi);
+    Geodesic::SinCosNorm(sbet1, cbet1);
+
+    double mu = Start(g, lat1, lon1, azi1, sbet1, cbet1);
+    if (_f1 == 1) {
+      Sphere(g);
+      return;
+    }
+    double u2 = mu * g._ep2;
+    _u2 = u2;
+    _sScale =  g._b * Geodesic::tauScale(u2);
+    Geodesic::tauCoeff(u2, _tauCoeff);
+    Geodesic::sigCoeff(u2, _sigCoeff);
+    _dlamScale = _salp0 * Geodesic::dlamScale(g._f, mu);
+    Geodesic::dlamCoeff(g._f, mu, _dlamCoeff);
+    Finish();
+  }
+
+  double GeodesicLine::Start(const Geodesic& g,
+			     double lat1, double lon1, double azi1,
+			     double sbet1, double cbet1) throw() {
     // Guard against underflow in salp0
     azi1 = Geodesic::AngRound(azi1);
-    lon1 = Geodesic::AngNormalize(lon1);
     _bsign = azi1 >= 0 ? 1 : -1;
     azi1 *= _bsign;
     _lat1 = lat1;
     _lon1 = lon1;
     _azi1 = azi1;
     _f1 = g._f1;
+    _b = g._b;
     // alp1 is in [0, pi]
     double
       alp1 = azi1 * Constants::degree(),
@@ -556,12 +1074,6 @@ namespace GeographicLib {
       // problems directly than to skirt them.
       salp1 = azi1 == 180 ? 0 : sin(alp1),
       calp1 = azi1 ==  90 ? 0 : cos(alp1);
-    double cbet1, sbet1, phi;
-    phi = lat1 * Constants::degree();
-    // Ensure cbet1 = +eps at poles
-    sbet1 = _f1 * sin(phi);
-    cbet1 = abs(lat1) == 90 ? Geodesic::eps2 : cos(phi);
-    Geodesic::SinCosNorm(sbet1, cbet1);
 
     // Evaluate alp0 from sin(alp1) * cos(bet1) = sin(alp0),
     _salp0 = salp1 * cbet1; // alp0 in [0, pi/2 - |bet1|]
@@ -582,43 +1094,95 @@ namespace GeographicLib {
 
     Geodesic::SinCosNorm(_ssig1, _csig1); // sig1 in (-pi, pi]
     Geodesic::SinCosNorm(_slam1, _clam1);
-    double
-      mu = Geodesic::sq(_calp0),
-      u2 = mu * g._ep2;
+    return Geodesic::sq(_calp0);
+  }
 
-    _sScale =  g._b * Geodesic::tauScale(u2);
-    Geodesic::tauCoeff(u2, _sigCoeff);
-    _dtau1 = Geodesic::SinSeries(_ssig1, _csig1, _sigCoeff, maxpow);
+  void GeodesicLine::Sphere(const Geodesic& g) throw() {
+    // On a sphere tau = sig and chi = lam, so all the series vanish and
+    // Position skips them.
+    _sScale = g._a;
+    _u2 = 0;
+    _dtau1 = _dlamScale = _dchi1 = 0;
+    _stau1 = _ssig1; _ctau1 = _csig1;
+    fill(_tauCoeff, _tauCoeff + maxpow, 0.0);
+    fill(_sigCoeff, _sigCoeff + maxpow, 0.0);
+    fill(_dlamCoeff, _dlamCoeff + maxpow, 0.0);
+  }
+
+  void GeodesicLine::Finish() throw() {
+    _dtau1 = Geodesic::SinSeries(_ssig1, _csig1, _tauCoeff, maxpow);
     {
       double s = sin(_dtau1), c = cos(_dtau1);
       // tau1 = sig1 + dtau1
       _stau1 = _ssig1 * c + _csig1 * s;
       _ctau1 = _csig1 * c - _ssig1 * s;
     }
-    Geodesic::sigCoeff(u2, _sigCoeff);
     // Not necessary because sigCoeff reverts tauCoeff
     //    _dtau1 = -SinSeries(_stau1, _ctau1, _sigCoeff, maxpow);
-
-    _dlamScale = _salp0 * Geodesic::dlamScale(g._f, mu);
-    Geodesic::dlamCoeff(g._f, mu, _dlamCoeff);
     _dchi1 = Geodesic::SinSeries(_ssig1, _csig1, _dlamCoeff, maxpow);
   }
 
+  double GeodesicLine::Sig12(double s12) const throw() {
+    double tau12 = s12 / _sScale;
+    if (_f1 == 1)
+      // Sphere
+      return tau12;
+    double s = sin(tau12), c = cos(tau12);
+    return tau12 + (_dtau1 +
+		    // tau2 = tau1 + tau12
+		    Geodesic::SinSeries(_stau1 * c + _ctau1 * s,
+					_ctau1 * c - _stau1 * s,
+					_sigCoeff, maxpow));
+  }
+
   void GeodesicLine::Position(double s12,
 			      double& lat2, double& lon2, double& azi2)
   const throw() {
     if (_sScale == 0)
       // Uninitialized
       return;
-    double tau12, sig12, lam12, chi12, lon12, s, c;
+    double m12, M12, M21;
+    GenPosition(Sig12(s12), false, false, lat2, lon2, azi2, s12,
+		m12, M12, M21);
+  }
+
+  void GeodesicLine::Position(double s12,
+			      double& lat2, double& lon2, double& azi2,
+			      double& m12, double& M12, double& M21)
+  const throw() {
+    if (_sScale == 0)
+      return;
+    GenPosition(Sig12(s12), false, true, lat2, lon2, azi2, s12,
+		m12, M12, M21);
+  }
+
+  void GeodesicLine::ArcPosition(double a12,
+				 double& lat2, double& lon2, double& azi2)
+    const throw() {
+    if (_sScale == 0)
+      return;
+    double s12, m12, M12, M21;
+    GenPosition(a12 * Constants::degree(), false, false, lat2, lon2, azi2, s12,
+		m12, M12, M21);
+  }
+
+  void GeodesicLine::ArcPosition(double a12,
+				 double& lat2, double& lon2, double& azi2,
+				 double& s12) const throw() {
+    if (_sScale == 0)
+      return;
+    double m12, M12, M21;
+    GenPosition(a12 * Constants::degree(), true, false, lat2, lon2, azi2, s12,
+		m12, M12, M21);
+  }
+
+  void GeodesicLine::GenPosition(double sig12, bool distp, bool scalep,
+				 double& lat2, double& lon2, double& azi2,
+				 double& s12,
+				 double& m12, double& M12, double& M21)
+    const throw() {
+    double lam12, chi12, lon12, s, c;
     double ssig2, csig2, sbet2, cbet2, slam2, clam2, salp2, calp2;
-    tau12 = s12 / _sScale;
-    s = sin(tau12); c = cos(tau12);
-    sig12 = tau12 + (_dtau1 +
-		     // tau2 = tau1 + tau12
-		     Geodesic::SinSeries(_stau1 * c + _ctau1 * s,
-					 _ctau1 * c - _stau1 * s,
-					 _sigCoeff, maxpow));
     s = sin(sig12); c = cos(sig12);
     // sig2 = sig1 + sig12
     ssig2 = _ssig1 * c + _csig1 * s;
@@ -634,7 +1198,7 @@ namespace GeographicLib {
     // lam12 = lam2 - lam1
     lam12 = atan2(slam2 * _clam1 - clam2 * _slam1,
 		  clam2 * _clam1 + slam2 * _slam1);
-    chi12 = lam12 + _dlamScale *
+    chi12 = _f1 == 1 ? lam12 : lam12 + _dlamScale *
       ( sig12 +
 	(Geodesic::SinSeries(ssig2, csig2, _dlamCoeff, maxpow)  - _dchi1));
     lon12 = _bsign * chi12 / Constants::degree();
@@ -646,6 +1210,38 @@ namespace GeographicLib {
     // minus signs give range [-180, 180). 0- converts -0 to +0.
     azi2 = 0-atan2(- Geodesic::azi2sense * _bsign * salp2,
 		   + Geodesic::azi2sense * calp2) / Constants::degree();
+    if (distp)
+      // tau12 = tau2 - tau1 = sig12 + dtau2 - dtau1
+      s12 = _sScale * (_f1 == 1 ? sig12 : sig12 +
+		       (Geodesic::SinSeries(ssig2, csig2, _tauCoeff, maxpow)
+			- _dtau1));
+    if (scalep)
+      Geodesic::Scales(_b, _u2, sig12, _ssig1, _csig1, ssig2, csig2, s12 / _b,
+		       m12, M12, M21);
+  }
+
+  void GeodesicLine::Position(int n, const double s12[],
+			      double lat2[], double lon2[], double azi2[])
+  const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Position(s12[i], lat2[i], lon2[i], azi2[i]);
+  }
+
+  void GeodesicLine::ArcPosition(int n, const double a12[],
+				 double lat2[], double lon2[], double azi2[],
+				 double s12[]) const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i) {
+      if (s12)
+	ArcPosition(a12[i], lat2[i], lon2[i], azi2[i], s12[i]);
+      else
+	ArcPosition(a12[i], lat2[i], lon2[i], azi2[i]);
+    }
   }
 
 } // namespace GeographicLib
@@ -10,6 +10,7 @@
 #define GEODESIC_HPP "$Id: Geodesic.hpp 6559 2009-02-28 16:49:53Z ckarney $"
 
 #include <cmath>
+#include <limits>
 
 namespace GeographicLib {
 
@@ -45,6 +46,11 @@ namespace GeographicLib {
   private:
     friend class GeodesicLine;
     static const int maxpow = 8, azi2sense = 1;
+    // DirectFan sets up the lines in blocks of this many azimuths.
+    enum { fanblock = 32 };
+    void DirectFan(double lat1, double lon1, double sbet1, double cbet1,
+		   int n, const double azi1[], const double s12[],
+		   double lat2[], double lon2[], double azi2[]) const throw();
 
     static inline double sq(double x) throw() { return x * x; }
 #if defined(_MSC_VER)
@@ -61,7 +67,22 @@ namespace GeographicLib {
 		 double& u2, bool diffp, double& dchi12, double c[])
       const throw();
 
-    static const double eps2, tol;
+    // Underflow guard.  We require
+    //   eps2 * epsilon() > 0
+    //   eps2 + epsilon() == epsilon()
+    static inline double eps2() throw()
+    { return std::sqrt(std::numeric_limits<double>::min()); }
+    static inline double tol() throw()
+    { return 100 * std::numeric_limits<double>::epsilon(); }
+    // The largest latitude and longitude differences (radians) for which
+    // Local is tried.
+    static inline double localmax() throw() { return 0.01; }
+    bool Local(double lat1, double lon1, double lat2, double lon2, double tol,
+	       double& s12, double& azi1, double& azi2) const throw();
+    // The work for Inverse; set m12, M12, and M21 only if scalep.
+    void GenInverse(double lat1, double lon1, double lat2, double lon2,
+		    bool scalep, double& s12, double& azi1, double& azi2,
+		    double& m12, double& M12, double& M21) const throw();
     const double _a, _f, _f1, _e2, _ep2, _b;
     static double SinSeries(double sinx, double cosx, const double c[], int n)
       throw();
@@ -91,6 +112,14 @@ namespace GeographicLib {
     static double tauScale(double u2) throw();
     static void tauCoeff(double u2, double c[]) throw();
     static void sigCoeff(double u2, double c[]) throw();
+    static double i2Scale(double u2) throw();
+    static void i2Coeff(double u2, double c[]) throw();
+    // The reduced length and the geodesic scales given the position on the
+    // auxiliary sphere of the end points and tau12 = s12 / b.
+    static void Scales(double b, double u2, double sig12,
+		       double ssig1, double csig1, double ssig2, double csig2,
+		       double tau12,
+		       double& m12, double& M12, double& M21) throw();
     static double dlamScale(double f, double mu) throw();
     static void dlamCoeff(double f, double mu, double e[]) throw();
     static double dlamScalemu(double f, double mu) throw();
@@ -115,6 +144,17 @@ namespace GeographicLib {
     void Direct(double lat1, double lon1, double azi1, double s12,
 		double& lat2, double& lon2, double& azi2) const throw();
 
+    /**
+     * The same as Direct(\e lat1, \e lon1, \e azi1, \e s12, \e lat2, \e
+     * lon2, \e azi2) but also returns the reduced length \e m12 (meters) and
+     * the geodesic scales \e M12 and \e M21 (dimensionless) of the geodesic.
+     * See Inverse(\e lat1, \e lon1, \e lat2, \e lon2, \e s12, \e azi1, \e
+     * azi2, \e m12, \e M12, \e M21) for their definitions.
+     **********************************************************************/
+    void Direct(double lat1, double lon1, double azi1, double s12,
+		double& lat2, double& lon2, double& azi2,
+		double& m12, double& M12, double& M21) const throw();
+
     /**
      * Set up to do a series of ranges.  This returns a GeodesicLine object
      * with point 1 given by latitude, \e lat1, longitude, \e lon1, and azimuth
@@ -135,14 +175,167 @@ namespace GeographicLib {
     void Inverse(double lat1, double lon1, double lat2, double lon2,
 		 double& s12, double& azi1, double& azi2) const throw();
 
+    /**
+     * The same as Inverse(\e lat1, \e lon1, \e lat2, \e lon2, \e s12, \e
+     * azi1, \e azi2) but also returns the reduced length \e m12 (meters) and
+     * the geodesic scales \e M12 and \e M21 (dimensionless).  If point 1 is
+     * held fixed and \e azi1 is changed by a small angle \e dazi1 (radians),
+     * point 2 moves by \e m12 \e dazi1 at right angles to the geodesic.  If
+     * point 1 is moved a small distance \e dt at right angles to the geodesic
+     * at point 1 and the geodesic is moved parallel to itself, its separation
+     * at point 2 is \e M12 \e dt; \e M21 is defined likewise with the roles
+     * of the points exchanged.  Thus the derivatives of \e s12 and \e azi1
+     * with respect to the coordinates of the end points follow directly
+     * (e.g., moving point 2 by \e dt at right angles to the geodesic changes
+     * \e azi1 by \e dt / \e m12).  On a sphere of radius \e a, \e m12 = \e
+     * a sin(\e s12 / \e a) and \e M12 = \e M21 = cos(\e s12 / \e a).  The
+     * extra cost is an additional sine series, about 10% of the total.
+     **********************************************************************/
+    void Inverse(double lat1, double lon1, double lat2, double lon2,
+		 double& s12, double& azi1, double& azi2,
+		 double& m12, double& M12, double& M21) const throw();
+
+    /**
+     * The same as Inverse(\e lat1, \e lon1, \e lat2, \e lon2, \e s12, \e
+     * azi1, \e azi2) but also returns the Jacobian of the results with
+     * respect to the inputs in \e jac[0..11].  This is a 3 x 4 matrix stored
+     * by rows; the rows give the derivatives of \e s12 (meters per degree),
+     * \e azi1, and \e azi2 (degrees per degree) and the columns are with
+     * respect to \e lat1, \e lon1, \e lat2, and \e lon2.  Thus \e jac[2] =
+     * \e ds12/\e dlat2.  The derivatives are found from the azimuths, the
+     * reduced length, and the geodesic scales, so that this costs about 10%
+     * more than Inverse, instead of the 8 extra calls needed to estimate the
+     * Jacobian by central differences.  The derivatives of the azimuths are
+     * infinite if \e m12 = 0 (coincident points or conjugate points, e.g.,
+     * the poles); those with respect to \e lon are zero at a pole.
+     **********************************************************************/
+    void InverseJacobian(double lat1, double lon1, double lat2, double lon2,
+			 double& s12, double& azi1, double& azi2,
+			 double jac[]) const throw();
+
+    /**
+     * Perform \e n direct geodesic calculations.  This is equivalent to
+     * calling Direct(\e lat1[i], \e lon1[i], \e azi1[i], \e s12[i], \e
+     * lat2[i], \e lon2[i], \e azi2[i]) for each \e i in [0, \e n).
+     **********************************************************************/
+    void Direct(int n, const double lat1[], const double lon1[],
+		const double azi1[], const double s12[],
+		double lat2[], double lon2[], double azi2[]) const throw();
+
+    /**
+     * Perform \e n direct geodesic calculations from a single point 1 at
+     * latitude \e lat1 and longitude \e lon1 (e.g., for range rings).  This
+     * is equivalent to calling Direct(\e lat1, \e lon1, \e azi1[i], \e
+     * s12[i], \e lat2[i], \e lon2[i], \e azi2[i]) for each \e i in [0, \e
+     * n), but the work depending only on point 1 is done once and the
+     * geodesics are set up for blocks of azimuths at a time.  This is about
+     * 10% faster than calling Direct.
+     **********************************************************************/
+    void DirectFan(double lat1, double lon1, int n,
+		   const double azi1[], const double s12[],
+		   double lat2[], double lon2[], double azi2[]) const throw();
+
+    /**
+     * Perform \e n inverse geodesic calculations.  This is equivalent to
+     * calling Inverse(\e lat1[i], \e lon1[i], \e lat2[i], \e lon2[i], \e
+     * s12[i], \e azi1[i], \e azi2[i]) for each \e i in [0, \e n).
+     **********************************************************************/
+    void Inverse(int n, const double lat1[], const double lon1[],
+		 const double lat2[], const double lon2[],
+		 double s12[], double azi1[], double azi2[]) const throw();
+
+    /**
+     * Perform the inverse geodesic calculation to within a tolerance \e tol
+     * (meters).  If the points are close, the triangle on the auxiliary
+     * sphere is solved exactly with the integrands relating its longitude
+     * and arc length to those on the ellipsoid evaluated at the mean reduced
+     * latitude.  A bound on the errors in \e s12 and in \e s12 times the
+     * azimuths (in radians) is found from the remainders of these mean
+     * values, the errors they cause in the triangle, and the roundoff (see
+     * the comments in Geodesic.cpp for its derivation).  The bound is of
+     * order \e f \e s12<sup>3</sup>/\e b<sup>2</sup>, plus
+     * 16 &epsilon; \e s12 + 4 &epsilon; \e b for the roundoff.  This approximation is
+     * returned if the bound is at most \e tol and the differences in
+     * latitude and longitude are at most 0.01 radians; otherwise (and
+     * always if \e tol <= 0) the result is the same as for Inverse without
+     * \e tol.  For WGS84 and \e tol = 1 mm, the approximation is used for
+     * lines up to about 16 km long and is about 3 times faster than the
+     * full calculation.  If the library is compiled with
+     * GEOGRAPHICLIB_STATS = 1, the calls are counted in Stats::GEOD_LOCAL
+     * and those using the approximation in Stats::GEOD_LOCAL_HIT.
+     **********************************************************************/
+    void Inverse(double lat1, double lon1, double lat2, double lon2,
+		 double tol,
+		 double& s12, double& azi1, double& azi2) const throw();
+
+    /**
+     * Perform \e n inverse geodesic calculations to within the tolerance \e
+     * tol.  This is equivalent to calling Inverse(\e lat1[i], \e lon1[i], \e
+     * lat2[i], \e lon2[i], \e tol, \e s12[i], \e azi1[i], \e azi2[i]) for
+     * each \e i in [0, \e n).
+     **********************************************************************/
+    void Inverse(int n, const double lat1[], const double lon1[],
+		 const double lat2[], const double lon2[], double tol,
+		 double s12[], double azi1[], double azi2[]) const throw();
+
+    /**
+     * Find the foot of the perpendicular from the point at latitude \e lat
+     * and longitude \e lon (degrees) to the geodesic \e line.  Return the
+     * along-track distance \e s12 (meters) from point 1 of \e line to the
+     * foot, the cross-track distance \e xtrack (meters) from the foot to
+     * the point, positive if the point is to the right of \e line, and the
+     * latitude \e lat2 and longitude \e lon2 (degrees) of the foot.  The
+     * starting guess for \e s12 is found by solving the right spherical
+     * triangle with the distance and azimuth from point 1 to the point.
+     * This is refined with Newton's method which moves the foot along \e
+     * line by \e m12 cos(\e alp) / \e M12, where \e alp is the angle
+     * between \e line and the geodesic from the foot to the point, and \e
+     * m12 and \e M12 are the reduced length and geodesic scale of that
+     * geodesic; this usually converges in 2 iterations.  The foot returned
+     * is the nearer of the two (on opposite sides of the earth), so |\e
+     * s12| is at most about half the circumference.  The foot is
+     * ill-defined if the point is close to one of the poles of \e line (the
+     * points a quarter circumference from \e line); \e s12 may be
+     * inaccurate there but \e xtrack is still accurate.
+     **********************************************************************/
+    void CrossTrack(const GeodesicLine& line, double lat, double lon,
+		    double& s12, double& xtrack, double& lat2, double& lon2)
+      const throw();
+
+    /**
+     * Return the major radius of the ellipsoid (meters).
+     **********************************************************************/
+    double MajorRadius() const throw() { return _a; }
+
+    /**
+     * Return the flattening of the ellipsoid (0 for a sphere).
+     **********************************************************************/
+    double Flattening() const throw() { return _f; }
 
     /**
      * A global instantiation of Geodesic with the parameters for the WGS84
      * ellipsoid.
+     *
+     * WGS84 is constructed before the static objects in any file which
+     * includes this header, so it may be used in their initialization.
      **********************************************************************/
-    const static Geodesic WGS84;
+    const static Geodesic& WGS84;
+
+    /// \cond SKIP
+    // Each file including this header has an Init; the first constructs WGS84.
+    class Init {
+    public:
+      Init() throw();
+    private:
+      static int _count;
+    };
+    /// \endcond
   };
 
+  namespace {
+    Geodesic::Init Geodesic_init;
+  }
+
   /**
    * \brief A geodesic line.
    *
@@ -184,13 +377,28 @@ namespace GeographicLib {
 
     int _bsign;
     double _lat1, _lon1, _azi1;
-    double  _f1, _salp0, _calp0,
+    double  _f1, _b, _u2, _salp0, _calp0,
       _ssig1, _csig1, _stau1, _ctau1, _slam1, _clam1,
       _sScale, _dlamScale, _dtau1, _dchi1;
-    double _sigCoeff[maxpow], _dlamCoeff[maxpow];
+    double _tauCoeff[maxpow], _sigCoeff[maxpow], _dlamCoeff[maxpow];
 
     GeodesicLine(const Geodesic& g, double lat1, double lon1, double azi1)
       throw();
+    // The stages of the constructor.  Start sets the quantities depending
+    // on the azimuth at point 1 given the reduced latitude there and returns
+    // mu = sq(calp0); the caller then sets the scales and the coefficients
+    // (or calls Sphere) and calls Finish.
+    double Start(const Geodesic& g, double lat1, double lon1, double azi1,
+		 double sbet1, double cbet1) throw();
+    void Sphere(const Geodesic& g) throw();
+    void Finish() throw();
+    // The work for Position and ArcPosition given sig12 in radians; set s12
+    // only if distp; set m12, M12, and M21 (using s12) only if scalep.
+    void GenPosition(double sig12, bool distp, bool scalep,
+		     double& lat2, double& lon2, double& azi2, double& s12,
+		     double& m12, double& M12, double& M21) const throw();
+    // sig12 for Position.
+    double Sig12(double s12) const throw();
   public:
 
     /**
@@ -209,6 +417,54 @@ namespace GeographicLib {
     void Position(double s12, double& lat2, double& lon2, double& azi2)
       const throw();
 
+    /**
+     * The same as Position(\e s12, \e lat2, \e lon2, \e azi2) but also
+     * returns the reduced length \e m12 (meters) and the geodesic scales \e
+     * M12 and \e M21 (dimensionless) between point 1 and point 2.  (See
+     * Geodesic::Inverse for their definitions.)
+     **********************************************************************/
+    void Position(double s12, double& lat2, double& lon2, double& azi2,
+		  double& m12, double& M12, double& M21) const throw();
+
+    /**
+     * Return the positions and azimuths of the \e n points a distance \e
+     * s12[i] from point 1 in \e lat2[i], \e lon2[i], and \e azi2[i].
+     **********************************************************************/
+    void Position(int n, const double s12[],
+		  double lat2[], double lon2[], double azi2[]) const throw();
+
+    /**
+     * Return the latitude, \e lat2, longitude, \e lon2, and forward azimuth,
+     * \e azi2 (in degrees) of the point 2 which is an arc length, \e a12
+     * (degrees), from point 1 on the auxiliary sphere.  \e a12 can be
+     * signed.  This avoids the conversion from distance to arc length in
+     * Position and so is faster, which helps if many points are needed on a
+     * line but their spacing need not be uniform in distance.  An arc length
+     * of 180 degrees takes you to the next crossing of the equator (in the
+     * same direction) and 90 degrees to the vertex, or from the vertex to
+     * the equator.
+     **********************************************************************/
+    void ArcPosition(double a12, double& lat2, double& lon2, double& azi2)
+      const throw();
+
+    /**
+     * The same as ArcPosition(\e a12, \e lat2, \e lon2, \e azi2) but also
+     * returns the distance, \e s12 (meters), from point 1 to point 2.
+     * Computing \e s12 takes an extra sine series, so call the shorter form
+     * if it isn't needed.
+     **********************************************************************/
+    void ArcPosition(double a12, double& lat2, double& lon2, double& azi2,
+		     double& s12) const throw();
+
+    /**
+     * Return the positions and azimuths of the \e n points an arc length \e
+     * a12[i] from point 1 in \e lat2[i], \e lon2[i], and \e azi2[i] and, if
+     * \e s12 is non-null, the distances in \e s12[i].
+     **********************************************************************/
+    void ArcPosition(int n, const double a12[],
+		     double lat2[], double lon2[], double azi2[],
+		     double s12[] = 0) const throw();
+
     /**
      * Has this object been initialize so that Position can be called?
      **********************************************************************/
@@ -0,0 +1,162 @@
+/**
+ * \file GeodesicRoute.cpp
+ * \brief Implementation for GeographicLib::GeodesicRoute class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/GeodesicRoute.hpp"
+#include "GeographicLib/Constants.hpp"
+#include "GeographicLib/Parallel.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = GEODESICROUTE_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  GeodesicRoute::GeodesicRoute(int n, const double lats[], const double lons[],
+			       const Geodesic& g)
+    : _g(g)
+    , _a(g.MajorRadius())
+    , _f1(1 - g.Flattening())
+    , _e2(g.Flattening() * (2 - g.Flattening()))
+    , _lat(lats, lats + max(n, 0))
+    , _lon(lons, lons + max(n, 0))
+    , _s(max(n, 0), 0.0)
+    , _box(6 * max(n - 1, 0))
+    , _line(max(n - 1, 0)) {
+    // The curvature of a geodesic (as a curve in space) is its normal
+    // curvature which is at most 1/rho.  A curve of length len with this
+    // curvature lies within len^2 / (8 * rho) of its chord if len <= pi *
+    // rho; in any case it lies within len of its ends.
+    const double rho = sq(_a * _f1) / _a;
+    for (int i = 0; i < int(_line.size()); ++i) {
+      double len, azi1, azi2;
+      _g.Inverse(_lat[i], _lon[i], _lat[i + 1], _lon[i + 1], len, azi1, azi2);
+      _line[i] = _g.Line(_lat[i], _lon[i], azi1);
+      _s[i + 1] = _s[i] + len;
+      double
+	r1[3], r2[3],
+	d = len <= Constants::pi() * rho ? len * len / (8 * rho) : len;
+      Cartesian(_lat[i], _lon[i], r1);
+      Cartesian(_lat[i + 1], _lon[i + 1], r2);
+      for (int k = 0; k < 3; ++k) {
+	_box[6 * i + 2 * k] = min(r1[k], r2[k]) - d;
+	_box[6 * i + 2 * k + 1] = max(r1[k], r2[k]) + d;
+      }
+    }
+  }
+
+  void GeodesicRoute::Cartesian(double lat, double lon, double r[])
+    const throw() {
+    double
+      phi = lat * Constants::degree(),
+      lam = lon * Constants::degree(),
+      sphi = sin(phi),
+      cphi = abs(lat) == 90 ? 0 : cos(phi),
+      n = _a / sqrt(1 - _e2 * sq(sphi));
+    r[0] = n * cphi * cos(lam);
+    r[1] = n * cphi * sin(lam);
+    r[2] = n * sq(_f1) * sphi;
+  }
+
+  double GeodesicRoute::Bound(int i, const double r[]) const throw() {
+    const double* box = &_box[6 * i];
+    double d2 = 0;
+    for (int k = 0; k < 3; ++k) {
+      double t = r[k] < box[2 * k] ? box[2 * k] - r[k] :
+	r[k] > box[2 * k + 1] ? r[k] - box[2 * k + 1] : 0;
+      d2 += t * t;
+    }
+    return sqrt(d2);
+  }
+
+  double GeodesicRoute::Segment(int i, double lat, double lon,
+				double& s, double& xtrack,
+				double& lat2, double& lon2) const throw() {
+    _g.CrossTrack(_line[i], lat, lon, s, xtrack, lat2, lon2);
+    double len = _s[i + 1] - _s[i];
+    if (s < 0 || s > len) {
+      // The foot is beyond the end of the segment so use the vertex there
+      // (on the same side of the segment as the foot on the geodesic).
+      int k = s < 0 ? i : i + 1;
+      double d, azi1, azi2;
+      // Use the local approximation for nearly coincident points
+      _g.Inverse(_lat[k], _lon[k], lat, lon, _a * tol(),
+		 d, azi1, azi2);
+      xtrack = xtrack < 0 ? -d : d;
+      s = s < 0 ? 0 : len;
+      lat2 = _lat[k];
+      lon2 = _lon[k];
+    }
+    return abs(xtrack);
+  }
+
+  int GeodesicRoute::Nearest(double lat, double lon, double& s,
+			     double& xtrack, double& lat2, double& lon2,
+			     double maxdist) const throw() {
+    const int m = Segments();
+    double r[3];
+    Cartesian(lat, lon, r);
+    // Start with the segment whose box is nearest
+    int i0 = -1;
+    double b0 = 0;
+    for (int i = 0; i < m; ++i) {
+      double b = Bound(i, r);
+      if (i0 < 0 || b < b0) {
+	i0 = i;
+	b0 = b;
+      }
+    }
+    int ibest = -1;
+    double best = maxdist;
+    if (i0 >= 0 && b0 <= maxdist) {
+      for (int j = -1; j < m; ++j) {
+	int i = j < 0 ? i0 : j;
+	if ((j >= 0 && i == i0) || !(Bound(i, r) <= best))
+	  continue;
+	double s1, x1, lat1, lon1, d = Segment(i, lat, lon, s1, x1, lat1, lon1);
+	if (d < best || (ibest < 0 && d <= best)) {
+	  ibest = i;
+	  best = d;
+	  s = _s[i] + s1;
+	  xtrack = x1;
+	  lat2 = lat1;
+	  lon2 = lon1;
+	}
+      }
+    }
+    if (ibest < 0)
+      s = xtrack = lat2 = lon2 = numeric_limits<double>::quiet_NaN();
+    return ibest;
+  }
+
+  void GeodesicRoute::Nearest(int n, const double lat[], const double lon[],
+			      int seg[], double s[], double xtrack[],
+			      double lat2[], double lon2[],
+			      double maxdist) const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n, minchunk)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i) {
+      double s1, x1, lat1, lon1;
+      seg[i] = Nearest(lat[i], lon[i], s1, x1, lat1, lon1, maxdist);
+      if (s)
+	s[i] = s1;
+      if (xtrack)
+	xtrack[i] = x1;
+      if (lat2)
+	lat2[i] = lat1;
+      if (lon2)
+	lon2[i] = lon1;
+    }
+  }
+
+} // namespace GeographicLib
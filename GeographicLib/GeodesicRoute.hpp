@@ -0,0 +1,116 @@
+/**
+ * \file GeodesicRoute.hpp
+ * \brief Header for GeographicLib::GeodesicRoute class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(GEODESICROUTE_HPP)
+#define GEODESICROUTE_HPP "$Id$"
+
+#include "GeographicLib/Geodesic.hpp"
+#include <vector>
+#include <limits>
+
+namespace GeographicLib {
+
+  /**
+   * \brief Distances from points to a route of geodesic segments
+   *
+   * A route is given by its \e n vertices, which are joined by \e n - 1
+   * geodesic segments.  For a given point, Nearest finds the nearest point
+   * (the foot) on the route and returns the along-track and cross-track
+   * distances of the point.  For each segment, Geodesic::CrossTrack gives
+   * the foot on the full geodesic; if this lies beyond the end of the
+   * segment, the foot is the vertex at that end instead.
+   *
+   * Most segments are rejected without this calculation.  The constructor
+   * finds a box in geocentric coordinates enclosing each segment.  The
+   * straight line distance from a point to a box is a lower bound for the
+   * geodesic distance to the segment, so only those segments whose boxes
+   * are closer than the nearest segment found so far need be considered.
+   * This also quickly rejects points which are farther than a given
+   * distance from the whole route (e.g., for checking whether points lie
+   * within a corridor).
+   **********************************************************************/
+  class GeodesicRoute {
+  private:
+    // Minimum number of points to hand to each thread.
+    enum { minchunk = 100 };
+    const Geodesic& _g;
+    // The major radius, 1 - f, and e^2 of the ellipsoid
+    const double _a, _f1, _e2;
+    static inline double sq(double x) throw() { return x * x; }
+    // The local approximation is used for the distances to the vertices if
+    // it is good to this fraction of the major radius.
+    static inline double tol() throw()
+    { return 100 * std::numeric_limits<double>::epsilon(); }
+    // The vertices, the lines for the segments, the cumulative distances
+    // along the route to the vertices, and the boxes (xmin, xmax, ymin,
+    // ymax, zmin, zmax) for the segments.
+    std::vector<double> _lat, _lon, _s, _box;
+    std::vector<GeodesicLine> _line;
+    // Geocentric coordinates of a point on the surface.
+    void Cartesian(double lat, double lon, double r[]) const throw();
+    // The straight line distance from the point r to the box for segment i.
+    double Bound(int i, const double r[]) const throw();
+    // Return the distance from a point to segment i and set the along-track
+    // distance from the vertex i, the cross-track distance, and the foot.
+    double Segment(int i, double lat, double lon, double& s, double& xtrack,
+		   double& lat2, double& lon2) const throw();
+  public:
+
+    /**
+     * Constructor for the route through the \e n vertices at latitudes \e
+     * lats[i] and longitudes \e lons[i] (degrees) on the ellipsoid given by
+     * \e g (default Geodesic::WGS84).  This throws std::bad_alloc if the
+     * memory for the route can't be allocated.
+     **********************************************************************/
+    GeodesicRoute(int n, const double lats[], const double lons[],
+		  const Geodesic& g = Geodesic::WGS84);
+
+    /**
+     * Find the nearest point on the route to the point at latitude \e lat
+     * and longitude \e lon (degrees).  Return the index \e i of the segment
+     * (joining vertices \e i and \e i + 1) containing the foot, the distance
+     * \e s (meters) along the route from its start to the foot, the
+     * cross-track distance \e xtrack (meters) from the foot to the point,
+     * positive if the point is to the right of the route, and the latitude
+     * \e lat2 and longitude \e lon2 (degrees) of the foot.  The distance
+     * from the point to the route is |\e xtrack|.  If this exceeds \e
+     * maxdist (meters; default infinity) or the route has no segments,
+     * return -1 and set the other results to NaN; this test is cheap for
+     * points which are far from the route.
+     **********************************************************************/
+    int Nearest(double lat, double lon, double& s, double& xtrack,
+		double& lat2, double& lon2,
+		double maxdist = std::numeric_limits<double>::infinity())
+      const throw();
+
+    /**
+     * Find the nearest points on the route for \e n points.  This is
+     * equivalent to calling Nearest(\e lat[i], \e lon[i], \e s[i], \e
+     * xtrack[i], \e lat2[i], \e lon2[i], \e maxdist) and storing the value
+     * returned in \e seg[i] for each \e i in [0, \e n).  \e s, \e xtrack,
+     * \e lat2, and \e lon2 may be 0 if these results are not needed.
+     **********************************************************************/
+    void Nearest(int n, const double lat[], const double lon[], int seg[],
+		 double s[], double xtrack[], double lat2[], double lon2[],
+		 double maxdist = std::numeric_limits<double>::infinity())
+      const throw();
+
+    /**
+     * Return the number of segments in the route.
+     **********************************************************************/
+    int Segments() const throw() { return int(_line.size()); }
+
+    /**
+     * Return the length of the route (meters).
+     **********************************************************************/
+    double Length() const throw() { return _s.empty() ? 0 : _s.back(); }
+  };
+
+} // namespace GeographicLib
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "GeographicLib/LocalCartesian.hpp"
 #include "GeographicLib/Constants.hpp"
+#include "GeographicLib/Parallel.hpp"
 #include <cmath>
 #include <stdexcept>
 
@@ -60,4 +61,26 @@ namespace GeographicLib {
     _earth.Reverse(xc, yc, zc, lat, lon, h);
   }
 
+  void LocalCartesian::Forward(int n, const double lat[], const double lon[],
+			       const double h[],
+			       double x[], double y[], double z[])
+    const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Forward(lat[i], lon[i], h[i], x[i], y[i], z[i]);
+  }
+
+  void LocalCartesian::Reverse(int n, const double x[], const double y[],
+			       const double z[],
+			       double lat[], double lon[], double h[])
+    const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(n)) schedule(static)
+#endif
+    for (int i = 0; i < n; ++i)
+      Reverse(x[i], y[i], z[i], lat[i], lon[i], h[i]);
+  }
+
 } // namespace GeographicLib
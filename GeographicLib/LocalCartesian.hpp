@@ -81,6 +81,25 @@ namespace GeographicLib {
     void Reverse(double x, double y, double z,
 		 double& lat, double& lon, double& h) const throw();
 
+    /**
+     * Perform \e n forward conversions.  This is equivalent to calling
+     * Forward(\e lat[i], \e lon[i], \e h[i], \e x[i], \e y[i], \e z[i])
+     * for each \e i in [0, \e n).  The rotation to the local system is set
+     * up once (by the constructor or Reset), so it costs nothing to apply
+     * the same LocalCartesian object to many batches.
+     **********************************************************************/
+    void Forward(int n, const double lat[], const double lon[],
+		 const double h[], double x[], double y[], double z[])
+      const throw();
+
+    /**
+     * Perform \e n reverse conversions.  This is equivalent to calling
+     * Reverse(\e x[i], \e y[i], \e z[i], \e lat[i], \e lon[i], \e h[i])
+     * for each \e i in [0, \e n).
+     **********************************************************************/
+    void Reverse(int n, const double x[], const double y[], const double z[],
+		 double lat[], double lon[], double h[]) const throw();
+
     /**
      * Return the latitude of the origin (degrees).
      **********************************************************************/
@@ -10,6 +10,7 @@
 #include "GeographicLib/UTMUPS.hpp"
 #include <stdexcept>
 #include <limits>
+#include <cstring>
 
 namespace {
   char RCSID[] = "$Id: MGRS.cpp 6553 2009-02-24 03:10:01Z ckarney $";
@@ -38,6 +39,55 @@ namespace GeographicLib {
   const string MGRS::latband = "CDEFGHJKLMNPQRSTUVWX";
   const string MGRS::upsband = "ABYZ";
   const string MGRS::digits  = "0123456789";
+  const MGRS::cellkey MGRS::badkey;
+
+  // These tables are constant-initialized and so, unlike the strings above,
+  // are safe to use during static initialization.
+  const signed char MGRS::charval[256] = {
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+     -1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+     25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
+     -1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+     25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+  };
+  const signed char MGRS::letterind[nsets][26] = {
+    {  0, 1, 2, 3, 4, 5, 6, 7,-1,-1,-1,-1,-1,  // utmcols[0]
+      -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1 },
+    { -1,-1,-1,-1,-1,-1,-1,-1,-1, 0, 1, 2, 3,  // utmcols[1]
+       4,-1, 5, 6, 7,-1,-1,-1,-1,-1,-1,-1,-1 },
+    { -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,  // utmcols[2]
+      -1,-1,-1,-1,-1, 0, 1, 2, 3, 4, 5, 6, 7 },
+    {  0, 1, 2, 3, 4, 5, 6, 7,-1, 8, 9,10,11,  // utmrow
+      12,-1,13,14,15,16,17,18,19,-1,-1,-1,-1 },
+    { -1,-1,-1,-1,-1,-1,-1,-1,-1, 0, 1, 2,-1,  // upscols[0]
+      -1,-1, 3, 4, 5, 6, 7, 8,-1,-1, 9,10,11 },
+    {  0, 1, 2,-1,-1, 3, 4, 5,-1, 6, 7, 8,-1,  // upscols[1]
+      -1,-1, 9,10,11,-1,-1,-1,-1,-1,-1,-1,-1 },
+    { -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,  // upscols[2]
+      -1,-1,-1,-1, 0, 1, 2, 3,-1,-1, 4, 5, 6 },
+    {  0, 1, 2,-1,-1, 3, 4, 5,-1, 6,-1,-1,-1,  // upscols[3]
+      -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1 },
+    {  0, 1, 2, 3, 4, 5, 6, 7,-1, 8, 9,10,11,  // upsrows[0]
+      12,-1,13,14,15,16,17,18,19,20,21,22,23 },
+    {  0, 1, 2, 3, 4, 5, 6, 7,-1, 8, 9,10,11,  // upsrows[1]
+      12,-1,13,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1 },
+    { -1,-1, 0, 1, 2, 3, 4, 5,-1, 6, 7, 8, 9,  // latband
+      10,-1,11,12,13,14,15,16,17,18,19,-1,-1 },
+    {  0, 1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,  // upsband
+      -1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1, 2, 3 }
+  };
+
 
   const int MGRS::mineasting[4] =
     { minupsSind, minupsNind, minutmcol, minutmcol };
@@ -50,57 +100,99 @@ namespace GeographicLib {
     { maxupsSind, maxupsNind,
       maxutmNrow + (maxutmSrow - minutmNrow), maxutmNrow };
 
-  void MGRS::Forward(int zone, bool northp, double x, double y, double lat,
-		     int prec, std::string& mgrs) {
+  bool MGRS::Letters(int zone, bool& northp, double& x, double& y,
+		     double lat, int prec,
+		     int& iband, int& icol, int& irow, bool throwp) {
     bool utmp = zone != 0;
-    CheckCoords(utmp, northp, x, y);
-    if (!(zone >= 0 || zone <= 60))
+    if (!CheckCoords(utmp, northp, x, y, throwp))
+      return false;
+    if (!(zone >= 0 && zone <= 60)) {
+      if (!throwp) return false;
       throw out_of_range("Zone " + str(zone) + " not in [0,60]");
-    if (!(prec >= 0 || prec <= maxprec))
+    }
+    if (!(prec >= 0 && prec <= maxprec)) {
+      if (!throwp) return false;
       throw out_of_range("MGRS precision " + str(prec) + " not in [0, "
-			      + str(int(maxprec)) + "]");
-    int
-      zone1 = zone - 1,
-      z = utmp ? 2 : 0;
-    // Space for zone, 3 block letters, easting + northing
-    mgrs.resize(z + 3 + 2 * prec);
-    if (utmp) {
-      mgrs[0] = digits[ zone / base ];
-      mgrs[1] = digits[ zone % base ];
-      // This isn't necessary...!  Keep y non-neg
-      // if (!northp) y -= maxutmSrow * tile;
+			 + str(int(maxprec)) + "]");
     }
     int
       xh = int(floor(x)) / tile,
       yh = int(floor(y)) / tile;
-    double
-      xf = x - tile * xh,
-      yf = y - tile * yh;
+    x -= tile * xh;
+    y -= tile * yh;
     if (utmp) {
-      int
-	// Correct fuzziness in latitude near equator
-	iband = abs(lat) > angeps ? LatitudeBand(lat) : (northp ? 0 : -1),
-	icol = xh - minutmcol,
-	irow = UTMRow(iband, icol, yh % utmrowperiod);
-      if (irow != yh - (northp ? minutmNrow : maxutmSrow))
+      // Correct fuzziness in latitude near equator
+      iband = abs(lat) > angeps ? LatitudeBand(lat) : (northp ? 0 : -1);
+      icol = xh - minutmcol;
+      irow = UTMRow(iband, icol, yh % utmrowperiod);
+      if (irow != yh - (northp ? minutmNrow : maxutmSrow)) {
+	if (!throwp) return false;
 	throw out_of_range("Latitude " + str(lat)
-				+ " is inconsistent with UTM coordinates");
-      mgrs[z++] = latband[10 + iband];
-      mgrs[z++] = utmcols[zone1 % 3][icol];
-      mgrs[z++] = utmrow[(yh + (zone1 & 1 ? utmevenrowshift : 0))
-			 % utmrowperiod];
+			   + " is inconsistent with UTM coordinates");
+      }
+      iband += 10;
+      irow = (yh + ((zone - 1) & 1 ? utmevenrowshift : 0)) % utmrowperiod;
     } else {
       bool eastp = xh >= upseasting;
-      int iband = (northp ? 2 : 0) + (eastp ? 1 : 0);
+      iband = (northp ? 2 : 0) + (eastp ? 1 : 0);
+      icol = xh - (eastp ? upseasting : northp ? minupsNind : minupsSind);
+      irow = yh - (northp ? minupsNind : minupsSind);
+    }
+    return true;
+  }
+
+  bool MGRS::Block(int zone, int iband, int icol, int irow,
+		   int& xh, int& yh) throw() {
+    if (zone) {
+      bool northp = iband >= 10;
+      if ((zone - 1) & 1)
+	irow = (irow + utmrowperiod - utmevenrowshift) % utmrowperiod;
+      irow = UTMRow(iband - 10, icol, irow);
+      if (irow == maxutmSrow)
+	return false;
+      yh = northp ? irow : irow + 100;
+      xh = icol + minutmcol;
+    } else {
+      bool
+	northp = iband >= 2,
+	eastp = iband & 1;
+      xh = icol + (eastp ? upseasting : northp ? minupsNind : minupsSind);
+      yh = irow + (northp ? minupsNind : minupsSind);
+    }
+    return true;
+  }
+
+  int MGRS::PutLetters(int zone, int iband, int icol, int irow, char mgrs[])
+    throw() {
+    int z = 0;
+    if (zone) {
+      mgrs[z++] = digits[ zone / base ];
+      mgrs[z++] = digits[ zone % base ];
+      mgrs[z++] = latband[iband];
+      mgrs[z++] = utmcols[(zone - 1) % 3][icol];
+      mgrs[z++] = utmrow[irow];
+    } else {
       mgrs[z++] = upsband[iband];
-      mgrs[z++] = upscols[iband][xh - (eastp ? upseasting :
-				       northp ? minupsNind : minupsSind)];
-      mgrs[z++] = upsrows[northp][yh - (northp ? minupsNind : minupsSind)];
+      mgrs[z++] = upscols[iband][icol];
+      mgrs[z++] = upsrows[iband >> 1][irow];
     }
+    return z;
+  }
+
+  int MGRS::Encode(int zone, bool northp, double x, double y, double lat,
+		   int prec, char mgrs[], bool throwp) {
+    int iband, icol, irow;
+    // x and y are replaced by the offsets within the 100km block
+    if (!Letters(zone, northp, x, y, lat, prec, iband, icol, irow, throwp))
+      return -1;
+    int
+      z = PutLetters(zone, iband, icol, irow, mgrs),
+      // Space for zone, 3 block letters, easting + northing
+      len = z + 2 * prec;
     double mult = pow(double(base), min(prec - tilelevel, 0));
     int
-      ix = int(floor(xf * mult)),
-      iy = int(floor(yf * mult));
+      ix = int(floor(x * mult)),
+      iy = int(floor(y * mult));
     for (int c = min(prec, int(tilelevel)); c--;) {
       mgrs[z + c] = digits[ ix % base ];
       ix /= base;
@@ -108,11 +200,11 @@ namespace GeographicLib {
       iy /= base;
     }
     if (prec > tilelevel) {
-      xf -= floor(xf * mult);
-      yf -= floor(yf * mult);
+      x -= floor(x * mult);
+      y -= floor(y * mult);
       mult = pow(double(base), prec - tilelevel);
-      ix = int(floor(xf * mult));
-      iy = int(floor(yf * mult));
+      ix = int(floor(x * mult));
+      iy = int(floor(y * mult));
       for (int c = prec - tilelevel; c--;) {
 	mgrs[z + c + tilelevel] = digits[ ix % base ];
 	ix /= base;
@@ -120,6 +212,19 @@ namespace GeographicLib {
 	iy /= base;
       }
     }
+    mgrs[len] = '\0';
+    return len;
+  }
+
+  void MGRS::Forward(int zone, bool northp, double x, double y, double lat,
+		     int prec, std::string& mgrs) {
+    char buf[bufsize];
+    mgrs.assign(buf, Encode(zone, northp, x, y, lat, prec, buf, true));
+  }
+
+  int MGRS::Forward(int zone, bool northp, double x, double y, double lat,
+		    int prec, char mgrs[]) {
+    return Encode(zone, northp, x, y, lat, prec, mgrs, true);
   }
 
   void MGRS::Forward(int zone, bool northp, double x, double y,
@@ -133,67 +238,249 @@ namespace GeographicLib {
     Forward(zone, northp, x, y, lat, prec, mgrs);
   }
 
-  void MGRS::Reverse(const std::string& mgrs,
-		     int& zone, bool& northp, double& x, double& y,
-		     int& prec, bool centerp) {
+  int MGRS::Forward(int zone, bool northp, double x, double y,
+		    int prec, char mgrs[]) {
+    double lat, lon;
+    if (zone)
+      UTMUPS::Reverse(zone, northp, x, y, lat, lon);
+    else
+      // Latitude isn't needed for UPS specs.
+      lat = 0;
+    return Encode(zone, northp, x, y, lat, prec, mgrs, true);
+  }
+
+  int MGRS::Forward(int n, const int zone[], const bool northp[],
+		    const double x[], const double y[], const double lat[],
+		    int prec, char mgrs[]) throw() {
+    if (!(prec >= 0 && prec <= maxprec)) {
+      fill(mgrs, mgrs + max(n, 0) * (5 + 2 * max(prec, 0)), ' ');
+      return max(n, 0);
+    }
+    int width = 5 + 2 * prec, nerr = 0;
+    char buf[bufsize];
+    for (int i = 0; i < n; ++i, mgrs += width) {
+      double lat1 = 0;
+      bool ok = true;
+      if (lat)
+	lat1 = lat[i];
+      else
+	ok = Latitude(zone[i], northp[i], x[i], y[i], lat1);
+      int len = ok ?
+	Encode(zone[i], northp[i], x[i], y[i], lat1, prec, buf, false) : -1;
+      if (len < 0) {
+	++nerr;
+	fill(mgrs, mgrs + width, ' ');
+      } else {
+	fill(mgrs, mgrs + width - len, ' ');
+	copy(buf, buf + len, mgrs + width - len);
+      }
+    }
+    return nerr;
+  }
+
+  bool MGRS::Latitude(int zone, bool northp, double x, double y,
+		      double& lat) throw() {
+    lat = 0;
+    // Latitude isn't needed for UPS (or for an illegal zone which will be
+    // caught later).
+    if (!(zone > 0 && zone <= 60))
+      return true;
+    // Screen the coordinates first so that UTMUPS::Reverse can't throw.
+    // (The MGRS ranges are narrower than the UTMUPS ranges.)
+    double lon;
+    if (!CheckCoords(true, northp, x, y, false))
+      return false;
+    UTMUPS::Reverse(zone, northp, x, y, lat, lon);
+    return true;
+  }
+
+  MGRS::cellkey MGRS::Key(int zone, bool northp, double x, double y,
+			  double lat, int prec, bool throwp) {
+    if (!(prec >= 0 && prec <= maxkeyprec)) {
+      if (!throwp) return badkey;
+      throw out_of_range("MGRS key precision " + str(prec) + " not in [0, "
+			 + str(int(maxkeyprec)) + "]");
+    }
+    int iband, icol, irow;
+    if (!Letters(zone, northp, x, y, lat, prec, iband, icol, irow, throwp))
+      return badkey;
+    // Same arithmetic as Encode
+    double mult = pow(double(base), prec - tilelevel);
     int
-      p = 0,
-      len = int(mgrs.size());
+      ix = int(floor(x * mult)),
+      iy = int(floor(y * mult));
+    return
+      cellkey(zone) << keyzoneshift |
+      cellkey(iband) << keybandshift |
+      cellkey(icol) << keycolshift |
+      cellkey(irow) << keyrowshift |
+      cellkey(prec) << keyprecshift |
+      cellkey(ix) << keyxshift |
+      cellkey(iy) << keyyshift;
+  }
+
+  bool MGRS::Unkey(cellkey key, int& zone, int& iband, int& icol,
+		   int& irow, int& prec, int& xh, int& yh,
+		   int& ix, int& iy) throw() {
+    const cellkey
+      mask5 = (1 << 5) - 1,
+      mask17 = (1 << 17) - 1;
+    // zone also picks up the unused high bits
+    zone = int(key >> keyzoneshift);
+    iband = int(key >> keybandshift & mask5);
+    icol = int(key >> keycolshift & mask5);
+    irow = int(key >> keyrowshift & mask5);
+    prec = int(key >> keyprecshift & 7);
+    ix = int(key >> keyxshift & mask17);
+    iy = int(key >> keyyshift & mask17);
+    if (!(zone <= 60 && prec <= maxkeyprec))
+      return false;
+    int n = 1;
+    for (int i = 0; i < prec; ++i)
+      n *= base;
+    if (!(ix < n && iy < n))
+      return false;
+    if (zone) {
+      if (!(iband < int(latband.size()) &&
+	    icol < int(utmcols[0].size()) && irow < int(utmrow.size())))
+	return false;
+    } else {
+      if (!(iband < int(upsband.size()) &&
+	    icol < int(upscols[iband].size()) &&
+	    irow < int(upsrows[iband >> 1].size())))
+	return false;
+    }
+    return Block(zone, iband, icol, irow, xh, yh);
+  }
+
+  MGRS::cellkey MGRS::ForwardKey(int zone, bool northp, double x, double y,
+				 int prec) {
+    double lat, lon;
+    if (zone)
+      UTMUPS::Reverse(zone, northp, x, y, lat, lon);
+    else
+      // Latitude isn't needed for UPS specs.
+      lat = 0;
+    return Key(zone, northp, x, y, lat, prec, true);
+  }
+
+  MGRS::cellkey MGRS::ForwardKey(int zone, bool northp, double x, double y,
+				 double lat, int prec) {
+    return Key(zone, northp, x, y, lat, prec, true);
+  }
+
+  int MGRS::ForwardKey(int n, const int zone[], const bool northp[],
+		       const double x[], const double y[], const double lat[],
+		       int prec, cellkey key[]) throw() {
+    int nerr = 0;
+    for (int i = 0; i < n; ++i) {
+      double lat1 = 0;
+      bool ok = true;
+      if (lat)
+	lat1 = lat[i];
+      else
+	ok = Latitude(zone[i], northp[i], x[i], y[i], lat1);
+      key[i] = ok ?
+	Key(zone[i], northp[i], x[i], y[i], lat1, prec, false) : badkey;
+      if (key[i] == badkey)
+	++nerr;
+    }
+    return nerr;
+  }
+
+  void MGRS::ReverseKey(cellkey key,
+			int& zone, bool& northp, double& x, double& y,
+			int& prec, bool centerp) {
+    int iband, icol, irow, xh, yh, ix, iy;
+    if (!Unkey(key, zone, iband, icol, irow, prec, xh, yh, ix, iy))
+      throw out_of_range("Illegal MGRS key " + str(key));
+    northp = iband >= (zone ? 10 : 2);
+    double unit = tile;
+    for (int i = 0; i < prec; ++i)
+      unit /= base;
+    x = tile * xh + unit * ix;
+    y = tile * yh + unit * iy;
+    if (centerp) {
+      x += unit/2;
+      y += unit/2;
+    }
+  }
+
+  int MGRS::KeyString(cellkey key, char mgrs[]) {
+    int zone, iband, icol, irow, prec, xh, yh, ix, iy;
+    if (!Unkey(key, zone, iband, icol, irow, prec, xh, yh, ix, iy))
+      throw out_of_range("Illegal MGRS key " + str(key));
+    int z = PutLetters(zone, iband, icol, irow, mgrs);
+    for (int c = prec; c--;) {
+      mgrs[z + c] = digits[ ix % base ];
+      ix /= base;
+      mgrs[z + c + prec] = digits[ iy % base ];
+      iy /= base;
+    }
+    mgrs[z + 2 * prec] = '\0';
+    return z + 2 * prec;
+  }
+
+  int MGRS::Decode(const char* mgrs, int len,
+		   int& zone, bool& northp, double& x, double& y,
+		   int& prec, bool centerp, bool throwp) {
+    int p = 0;
     zone = 0;
     while (p < len) {
-      int i = lookup(digits, mgrs[p]);
+      int i = digitval(mgrs[p]);
       if (i < 0)
 	break;
-      zone = 10 * zone + i;
+      // Guard against overflow with absurdly long zones
+      if (zone < 100000000)
+	zone = 10 * zone + i;
       ++p;
     }
-    if (p > 0 && (zone == 0 || zone > 60))
+    if (p > 0 && (zone == 0 || zone > 60)) {
+      if (!throwp) return BADZONE;
       throw out_of_range("Zone " + str(zone) + " not in [1,60]");
-    if (p > 2)
+    }
+    if (p > 2) {
+      if (!throwp) return LONGZONE;
       throw out_of_range("More than 2 digits at start of MGRS "
-			 + mgrs.substr(0, p));
-    if (len - p < 3)
-      throw out_of_range("MGRS string " + mgrs + " too short");
+			 + string(mgrs, p));
+    }
+    if (len - p < 3) {
+      if (!throwp) return SHORT;
+      throw out_of_range("MGRS string " + string(mgrs, len) + " too short");
+    }
     bool utmp = zone != 0;
     int zone1 = zone - 1;
-    const string& band = utmp ? latband : upsband;
-    int iband = lookup(band, mgrs[p++]);
-    if (iband < 0)
+    int iband = letterval(utmp ? latbandset : upsbandset, mgrs[p++]);
+    if (iband < 0) {
+      if (!throwp) return BADBAND;
       throw out_of_range("Band letter " + str(mgrs[p-1])
 			 + " not in " + (utmp ? "UTM" : "UPS")
-			 + " set " + band);
+			 + " set " + (utmp ? latband : upsband));
+    }
     northp = iband >= (utmp ? 10 : 2);
-    const string& col = utmp ? utmcols[zone1 % 3] : upscols[iband];
-    const string& row = utmp ? utmrow : upsrows[northp];
-    int icol = lookup(col, mgrs[p++]);
-    if (icol < 0)
+    int icol = letterval(utmp ? utmcolset + zone1 % 3 : upscolset + iband,
+			 mgrs[p++]);
+    if (icol < 0) {
+      if (!throwp) return BADCOLUMN;
       throw out_of_range("Column letter " + str(mgrs[p-1])
 			 + " not in "
-			 + (utmp ? "zone " + mgrs.substr(0, p-2) :
+			 + (utmp ? "zone " + string(mgrs, p-2) :
 			    "UPS band " + str(mgrs[p-2]))
-			 + " set " + col );
-    int irow = lookup(row, mgrs[p++]);
-    if (irow < 0)
+			 + " set " + (utmp ? utmcols[zone1 % 3] : upscols[iband]));
+    }
+    int irow = letterval(utmp ? utmrowset : upsrowset + northp, mgrs[p++]);
+    if (irow < 0) {
+      if (!throwp) return BADROW;
       throw out_of_range("Row letter " + str(mgrs[p-1])
 			 + " not in "
 			 + (utmp ? "UTM" :
 			    "UPS " + str(hemispheres[northp]))
-			 + " set " + row);
-    if (utmp) {
-      if (zone1 & 1)
-	irow = (irow + utmrowperiod - utmevenrowshift) % utmrowperiod;
-      iband -= 10;
-      irow = UTMRow(iband, icol, irow);
-      if (irow == maxutmSrow)
-	throw out_of_range("Block " + mgrs.substr(p-2, 2)
-			   + " not in zone/band " + mgrs.substr(0, p-2));
-
-      irow = northp ? irow : irow + 100;
-      icol = icol + minutmcol;
-    } else {
-      bool eastp = iband & 1;
-      icol += eastp ? upseasting : northp ? minupsNind : minupsSind;
-      irow += northp ? minupsNind : minupsSind;
+			 + " set " + (utmp ? utmrow : upsrows[northp]));
+    }
+    if (!Block(zone, iband, icol, irow, icol, irow)) {
+      if (!throwp) return BADBLOCK;
+      throw out_of_range("Block " + string(mgrs + p-2, 2)
+			 + " not in zone/band " + string(mgrs, p-2));
     }
     prec = (len - p)/2;
     double unit = tile;
@@ -202,30 +489,78 @@ namespace GeographicLib {
     for (int i = 0; i < prec; ++i) {
       unit /= base;
       int
-	ix = lookup(digits, mgrs[p + i]),
-	iy = lookup(digits, mgrs[p + i + prec]);
-      if (ix < 0 || iy < 0)
-	throw out_of_range("Encountered a non-digit in " + mgrs.substr(p));
+	ix = digitval(mgrs[p + i]),
+	iy = digitval(mgrs[p + i + prec]);
+      if (ix < 0 || iy < 0) {
+	if (!throwp) return NONDIGIT;
+	throw out_of_range("Encountered a non-digit in "
+			   + string(mgrs + p, len - p));
+      }
       x += unit * ix;
       y += unit * iy;
     }
     if ((len - p) % 2) {
-      if (lookup(digits, mgrs[len - 1]) < 0)
-	throw out_of_range("Encountered a non-digit in " + mgrs.substr(p));
+      if (!throwp)
+	return digitval(mgrs[len - 1]) < 0 ? NONDIGIT : ODDDIGITS;
+      if (digitval(mgrs[len - 1]) < 0)
+	throw out_of_range("Encountered a non-digit in "
+			   + string(mgrs + p, len - p));
       else
 	throw out_of_range("Not an even number of digits in "
-			   + mgrs.substr(p));
+			   + string(mgrs + p, len - p));
     }
-    if (prec > maxprec)
+    if (prec > maxprec) {
+      if (!throwp) return LONGDIGITS;
       throw out_of_range("More than " + str(2*maxprec) + " digits in "
-			 + mgrs.substr(p));
+			 + string(mgrs + p, len - p));
+    }
     if (centerp) {
       x += unit/2;
       y += unit/2;
     }
+    return OK;
+  }
+
+  void MGRS::Reverse(const std::string& mgrs,
+		     int& zone, bool& northp, double& x, double& y,
+		     int& prec, bool centerp) {
+    Decode(mgrs.data(), int(mgrs.size()),
+	   zone, northp, x, y, prec, centerp, true);
+  }
+
+  int MGRS::Reverse(const char* mgrs, int len,
+		    int& zone, bool& northp, double& x, double& y,
+		    int& prec, bool centerp) throw() {
+    return Decode(mgrs, len, zone, northp, x, y, prec, centerp, false);
+  }
+
+  int MGRS::Reverse(const char* text, size_t len, int n,
+		    int zone[], bool northp[], double x[], double y[],
+		    int prec[], int status[], size_t& used,
+		    bool centerp) throw() {
+    const char
+      *p = text,
+      *end = text + len;
+    int i = 0;
+    for (; i < n && p < end; ++i) {
+      const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+      const char
+	*b = p,
+	*e = eol ? eol : end;
+      p = eol ? eol + 1 : end;
+      while (b < e && isspace((unsigned char)*b))
+	++b;
+      while (e > b && isspace((unsigned char)e[-1]))
+	--e;
+      status[i] = Decode(b, int(e - b), zone[i], northp[i], x[i], y[i],
+			 prec[i], centerp, false);
+    }
+    used = p - text;
+    return i;
   }
 
-  void MGRS::CheckCoords(bool utmp, bool& northp, double& x, double& y) {
+  bool MGRS::CheckCoords(bool utmp, bool& northp, double& x, double& y,
+			 bool throwp) {
     // Limits are all multiples of 100km and are all closed on the lower end
     // and open on the upper end -- and this is reflected in the error
     // messages.  However if a coordinate lies on the excluded upper end (e.g.,
@@ -238,6 +573,8 @@ namespace GeographicLib {
     if (! (ix >= mineasting[ind] && ix < maxeasting[ind]) ) {
       if (ix == maxeasting[ind] && x == maxeasting[ind] * tile)
 	x -= eps;
+      else if (!throwp)
+	return false;
       else
 	throw out_of_range("Easting " + str(int(floor(x/1000)))
 			   + "km not in MGRS/"
@@ -250,6 +587,8 @@ namespace GeographicLib {
     if (! (iy >= minnorthing[ind] && iy < maxnorthing[ind]) ) {
       if (iy == maxnorthing[ind] && y == maxnorthing[ind] * tile)
 	y -= eps;
+      else if (!throwp)
+	return false;
       else
 	throw out_of_range("Northing " + str(int(floor(y/1000)))
 			   + "km not in MGRS/"
@@ -275,6 +614,7 @@ namespace GeographicLib {
 	}
       }
     }
+    return true;
   }
 
   int MGRS::UTMRow(int iband, int icol, int irow) throw() {
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <string>
 #include <sstream>
+#include <cstddef>
 
 namespace GeographicLib {
 
@@ -54,6 +55,16 @@ namespace GeographicLib {
    * - The underlying projections are not very accurately implemented.
    **********************************************************************/
   class MGRS {
+  public:
+    /**
+     * The type of the 64-bit integer keys for MGRS squares (see
+     * MGRS::ForwardKey).
+     **********************************************************************/
+#if defined(_MSC_VER)
+    typedef unsigned __int64 cellkey;
+#else
+    typedef unsigned long long cellkey;
+#endif
   private:
     // The smallest length s.t., 1.0e7 - eps < 1.0e7 (approx 1.9 nm)
     static const double eps;
@@ -83,10 +94,74 @@ namespace GeographicLib {
       // Maximum precision is um
       maxprec = 5 + 6
     };
-    static void CheckCoords(bool utmp, bool& northp, double& x, double& y);
-    static int lookup(const std::string& s, char c) throw() {
-      std::string::size_type r = s.find(toupper(c));
-      return r == std::string::npos ? -1 : int(r);
+    // Throw an error if easting or northing are outside MGRS ranges.  If
+    // throwp = false, return bool instead.
+    static bool CheckCoords(bool utmp, bool& northp, double& x, double& y,
+			    bool throwp = true);
+    // Write the MGRS string into mgrs and return its length.  On failure
+    // throw an error if throwp, otherwise return -1.
+    static int Encode(int zone, bool northp, double x, double y, double lat,
+		      int prec, char mgrs[], bool throwp);
+    // Compute the indices of the band, column, and row letters of the 100km
+    // block containing (x, y) and replace x and y by the offsets within the
+    // block.  On failure throw an error if throwp, otherwise return false.
+    static bool Letters(int zone, bool& northp, double& x, double& y,
+			double lat, int prec,
+			int& iband, int& icol, int& irow, bool throwp);
+    // The inverse of Letters; convert the letter indices to the indices of
+    // the 100km block.  Return false if the block is not legal.
+    static bool Block(int zone, int iband, int icol, int irow,
+		      int& xh, int& yh) throw();
+    // Write the zone and block letters and return the number of chars.
+    static int PutLetters(int zone, int iband, int icol, int irow,
+			  char mgrs[]) throw();
+    // Compute the latitude needed by Encode without throwing errors.
+    static bool Latitude(int zone, bool northp, double x, double y,
+			 double& lat) throw();
+    // Bit positions of the fields of a cellkey
+    enum {
+      keyyshift = 0,
+      keyxshift = 17,
+      keyprecshift = 34,
+      keyrowshift = 37,
+      keycolshift = 42,
+      keybandshift = 47,
+      keyzoneshift = 52,
+      maxkeyprec = tilelevel
+    };
+    // Return the key for the MGRS square.  On failure throw an error if
+    // throwp, otherwise return badkey.
+    static cellkey Key(int zone, bool northp, double x, double y, double lat,
+		       int prec, bool throwp);
+    // Unpack the key.  Return false if it is not legal.
+    static bool Unkey(cellkey key, int& zone, int& iband, int& icol,
+		      int& irow, int& prec, int& xh, int& yh,
+		      int& ix, int& iy) throw();
+    // Parse the len chars at mgrs.  On failure throw an error if throwp,
+    // otherwise return the status code.
+    static int Decode(const char* mgrs, int len,
+		      int& zone, bool& northp, double& x, double& y,
+		      int& prec, bool centerp, bool throwp);
+    // Map digits to 0-9 and letters (either case) to 10-35, else -1.
+    static const signed char charval[256];
+    // The indices of the letters A-Z within each of the letter sets above.
+    enum {
+      utmcolset = 0,		// 3 sets indexed by (zone - 1) % 3
+      utmrowset = 3,
+      upscolset = 4,		// 4 sets indexed by the UPS band
+      upsrowset = 8,		// 2 sets indexed by northp
+      latbandset = 10,
+      upsbandset = 11,
+      nsets = 12
+    };
+    static const signed char letterind[nsets][26];
+    static int digitval(char c) throw() {
+      int v = charval[(unsigned char)(c)];
+      return v < 10 ? v : -1;
+    }
+    static int letterval(int set, char c) throw() {
+      int v = charval[(unsigned char)(c)] - 10;
+      return v >= 0 ? letterind[set][v] : -1;
     }
     template<typename T> static std::string str(T x) {
       std::ostringstream s; s << x; return s.str();
@@ -102,6 +177,8 @@ namespace GeographicLib {
     }
     // These are protected also so that UTMUPS can access them.
     friend class GeoCoords;	// GeoCoords accesses utmNshift
+    friend class MGRSGrid;	// MGRSGrid uses Encode and the MGRS ranges
+    friend class MGRSBins;	// MGRSBins uses Key
     enum {
       tile = 100000,		// Size MGRS blocks
       minutmcol = 1,
@@ -121,6 +198,30 @@ namespace GeographicLib {
     };
   public:
 
+    /**
+     * Size of a char array which can hold any MGRS string produced by Forward
+     * (with \e prec = 11) together with its terminating null.  A char[16]
+     * suffices for \e prec <= 5 (1 m).
+     **********************************************************************/
+    enum { bufsize = 2 + 3 + 2 * (5 + 6) + 1 };
+
+    /**
+     * Status codes returned by the non-throwing versions of Reverse.
+     **********************************************************************/
+    enum status {
+      OK = 0,			// Success
+      BADZONE = 1,		// Zone not in [1,60]
+      LONGZONE = 2,		// More than 2 digits at start
+      SHORT = 3,		// Less than 3 letters following the zone
+      BADBAND = 4,		// Illegal latitude band letter
+      BADCOLUMN = 5,		// Illegal column letter
+      BADROW = 6,		// Illegal row letter
+      BADBLOCK = 7,		// 100km block not in zone/band
+      NONDIGIT = 8,		// Non-digit in easting or northing
+      ODDDIGITS = 9,		// Odd number of digits
+      LONGDIGITS = 10		// More than 22 digits
+    };
+
     /**
      * Convert UTM or UPS coordinate to an MGRS coordinate.  \e zone and \e
      * northp give input zone (with \e zone = 0 indicating UPS) and hemisphere,
@@ -183,6 +284,39 @@ namespace GeographicLib {
     static void Forward(int zone, bool northp, double x, double y, double lat,
 			int prec, std::string& mgrs);
 
+    /**
+     * Convert UTM or UPS coordinates to an MGRS coordinate written as a null
+     * terminated string into \e mgrs, which must hold at least 6 + 2 * \e
+     * prec chars (MGRS::bufsize suffices for all \e prec).  Return the length
+     * of the string.  This is otherwise the same as the std::string version;
+     * however no heap allocation is done unless an error is thrown.
+     **********************************************************************/
+    static int Forward(int zone, bool northp, double x, double y,
+		       int prec, char mgrs[]);
+
+    /**
+     * Convert UTM or UPS coordinates to an MGRS coordinate written into a char
+     * array in case that latitude is already known.
+     **********************************************************************/
+    static int Forward(int zone, bool northp, double x, double y, double lat,
+		       int prec, char mgrs[]);
+
+    /**
+     * Convert \e n UTM or UPS coordinates given by the arrays \e zone, \e
+     * northp, \e x, and \e y to MGRS coordinates at precision \e prec.  If
+     * \e lat is non-null, it gives the latitudes of the points (see the
+     * Forward with latitude); otherwise these are computed when needed.  The
+     * results are written into \e mgrs as a packed array of \e n fixed-width
+     * records of 5 + 2 * \e prec chars, without separators or terminating
+     * nulls.  The UPS coordinates, which lack the 2-digit zone, are right
+     * justified with 2 leading blanks.  Records which cannot be converted are
+     * filled with blanks.  Return the number of such failures.  No heap
+     * allocation is done and no exceptions are thrown.
+     **********************************************************************/
+    static int Forward(int n, const int zone[], const bool northp[],
+		       const double x[], const double y[], const double lat[],
+		       int prec, char mgrs[]) throw();
+
     /**
      * Convert a MGRS coordinate to UTM or UPS coordinates returning zone \e
      * zone, hemisphere \e northp, easting \e x (meters), northing \e y
@@ -214,6 +348,88 @@ namespace GeographicLib {
 			int& zone, bool& northp, double& x, double& y,
 			int& prec, bool centerp = true);
 
+    /**
+     * Convert the \e len chars at \e mgrs (which need not be null terminated)
+     * to UTM or UPS coordinates.  This is the same as the std::string version
+     * of Reverse except that it returns a status code (MGRS::OK on success)
+     * instead of throwing an error.  The letters are decoded with table
+     * lookups and no heap allocation is done.
+     **********************************************************************/
+    static int Reverse(const char* mgrs, int len,
+		       int& zone, bool& northp, double& x, double& y,
+		       int& prec, bool centerp = true) throw();
+
+    /**
+     * Parse up to \e n newline separated MGRS coordinates from the \e len
+     * chars at \e text, storing the results for line \e i in \e zone[i], \e
+     * northp[i], \e x[i], \e y[i], \e prec[i], and \e status[i] (see the
+     * non-throwing Reverse).  Leading and trailing white space (including
+     * carriage returns) is ignored; a blank line gives MGRS::SHORT.  The last
+     * line need not be terminated by a newline.  Return the number of lines
+     * parsed and set \e used to the number of chars consumed (so that the
+     * rest of the text can be processed by another call).  If \e n lines
+     * are parsed without reaching the end of \e text, \e used includes the
+     * newline of the last line.
+     **********************************************************************/
+    static int Reverse(const char* text, std::size_t len, int n,
+		       int zone[], bool northp[], double x[], double y[],
+		       int prec[], int status[], std::size_t& used,
+		       bool centerp = true) throw();
+
+    /**
+     * A value which is never a legal key; this is returned by the batch
+     * version of ForwardKey for points which cannot be converted.
+     **********************************************************************/
+    static const cellkey badkey = ~cellkey(0);
+
+    /**
+     * Return a 64-bit integer key for the MGRS square of precision \e prec
+     * (which must be in [0, 5]) containing the UTM or UPS coordinates.  The
+     * key packs the zone, the band, column, and row letters, the precision
+     * and the digits of the MGRS string which Forward would produce, so that
+     * points with the same MGRS string have the same key.  From the most
+     * significant end, the fields are the zone (6 bits), the indices of the
+     * band, column, and row letters (5 bits each), \e prec (3 bits), and
+     * the easting and northing digits (17 bits each).  Thus keys sort by
+     * zone, then by 100km block, and then by position within the block.  The
+     * arguments and the errors thrown are the same as for Forward.
+     **********************************************************************/
+    static cellkey ForwardKey(int zone, bool northp, double x, double y,
+			      int prec);
+
+    /**
+     * Return the key for the MGRS square in case that latitude is already
+     * known (see Forward).
+     **********************************************************************/
+    static cellkey ForwardKey(int zone, bool northp, double x, double y,
+			      double lat, int prec);
+
+    /**
+     * Convert \e n UTM or UPS coordinates to keys written into \e key.  The
+     * arguments are as for the batch version of Forward.  Points which cannot
+     * be converted are given the key MGRS::badkey.  Return the number of
+     * such failures.
+     **********************************************************************/
+    static int ForwardKey(int n, const int zone[], const bool northp[],
+			  const double x[], const double y[],
+			  const double lat[], int prec, cellkey key[]) throw();
+
+    /**
+     * Convert a key to UTM or UPS coordinates.  The results are identical to
+     * those given by Reverse applied to the corresponding MGRS string.
+     * Throw an error if \e key is not a legal key.
+     **********************************************************************/
+    static void ReverseKey(cellkey key,
+			   int& zone, bool& northp, double& x, double& y,
+			   int& prec, bool centerp = true);
+
+    /**
+     * Write the MGRS string for \e key as a null terminated string into \e
+     * mgrs (which must hold at least 16 chars) and return its length.  Throw
+     * an error if \e key is not a legal key.
+     **********************************************************************/
+    static int KeyString(cellkey key, char mgrs[]);
+
   };
 
 } // namespace GeographicLib
@@ -0,0 +1,168 @@
+/**
+ * \file MGRSBins.cpp
+ * \brief Implementation for GeographicLib::MGRSBins class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/MGRSBins.hpp"
+#include "GeographicLib/UTMUPS.hpp"
+#include "GeographicLib/Parallel.hpp"
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = MGRSBINS_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  MGRSBins::MGRSBins(int prec)
+    : _prec(prec)
+    , _size(0)
+    , _keys(16, MGRS::badkey)
+    , _counts(16, 0.0)
+    , _sums(16, 0.0) {
+    if (!(prec >= 0 && prec <= MGRS::maxkeyprec))
+      throw out_of_range("MGRS key precision " + MGRS::str(prec)
+			 + " not in [0, " + MGRS::str(int(MGRS::maxkeyprec))
+			 + "]");
+  }
+
+  void MGRSBins::Clear() {
+    fill(_keys.begin(), _keys.end(), MGRS::badkey);
+    fill(_counts.begin(), _counts.end(), 0.0);
+    fill(_sums.begin(), _sums.end(), 0.0);
+    _size = 0;
+  }
+
+  void MGRSBins::Rehash(size_t n) {
+    vector<cellkey> keys(n, MGRS::badkey);
+    vector<double> counts(n, 0.0), sums(n, 0.0);
+    keys.swap(_keys);
+    counts.swap(_counts);
+    sums.swap(_sums);
+    for (size_t i = 0; i < keys.size(); ++i)
+      if (keys[i] != MGRS::badkey) {
+	size_t j = Slot(keys[i]);
+	_keys[j] = keys[i];
+	_counts[j] = counts[i];
+	_sums[j] = sums[i];
+      }
+  }
+
+  void MGRSBins::Insert(cellkey key, double count, double sum) {
+    if (key == MGRS::badkey)
+      throw out_of_range("Cannot add a point with an illegal MGRS key");
+    size_t i = Slot(key);
+    if (_keys[i] == MGRS::badkey) {
+      // Keep the load factor below 1/2
+      if (2 * (_size + 1) > _keys.size()) {
+	Rehash(2 * _keys.size());
+	i = Slot(key);
+      }
+      _keys[i] = key;
+      ++_size;
+    }
+    _counts[i] += count;
+    _sums[i] += sum;
+  }
+
+  bool MGRSBins::Add(int zone, bool northp, double x, double y,
+		     double value) {
+    double lat;
+    if (!MGRS::Latitude(zone, northp, x, y, lat))
+      return false;
+    cellkey key = MGRS::Key(zone, northp, x, y, lat, _prec, false);
+    if (key == MGRS::badkey)
+      return false;
+    Insert(key, 1, value);
+    return true;
+  }
+
+  bool MGRSBins::AddPoint(double lat, double lon, double value) {
+    int zone;
+    bool northp;
+    double x, y;
+    try {
+      UTMUPS::Forward(lat, lon, zone, northp, x, y);
+    }
+    catch (const out_of_range&) {
+      return false;
+    }
+    cellkey key = MGRS::Key(zone, northp, x, y, lat, _prec, false);
+    if (key == MGRS::badkey)
+      return false;
+    Insert(key, 1, value);
+    return true;
+  }
+
+  int MGRSBins::Add(int n, const double lat[], const double lon[],
+		    const double value[]) {
+    int nerr = 0;
+#if defined(_OPENMP)
+    int nthreads = Parallel::Threads(n);
+    if (nthreads > 1) {
+#pragma omp parallel num_threads(nthreads) reduction(+:nerr)
+      {
+	MGRSBins bins(_prec);
+#pragma omp for schedule(static)
+	for (int i = 0; i < n; ++i)
+	  if (!bins.AddPoint(lat[i], lon[i], value ? value[i] : 0))
+	    ++nerr;
+#pragma omp critical
+	Merge(bins);
+      }
+      return nerr;
+    }
+#endif
+    for (int i = 0; i < n; ++i)
+      if (!AddPoint(lat[i], lon[i], value ? value[i] : 0))
+	++nerr;
+    return nerr;
+  }
+
+  void MGRSBins::Merge(const MGRSBins& bins) {
+    if (bins._prec != _prec)
+      throw out_of_range("Cannot merge MGRS bins of precision "
+			 + MGRS::str(bins._prec) + " into bins of precision "
+			 + MGRS::str(_prec));
+    if (2 * (_size + bins._size) > _keys.size()) {
+      size_t n = _keys.size();
+      while (2 * (_size + bins._size) > n)
+	n *= 2;
+      Rehash(n);
+    }
+    for (size_t i = 0; i < bins._keys.size(); ++i)
+      if (bins._keys[i] != MGRS::badkey)
+	Insert(bins._keys[i], bins._counts[i], bins._sums[i]);
+  }
+
+  bool MGRSBins::Find(cellkey key, double& count, double& sum) const throw() {
+    size_t i = Slot(key);
+    count = _counts[i];
+    sum = _sums[i];
+    return _keys[i] != MGRS::badkey;
+  }
+
+  void MGRSBins::Bins(vector<cellkey>& keys,
+		      vector<double>& counts, vector<double>& sums) const {
+    keys.clear();
+    for (size_t i = 0; i < _keys.size(); ++i)
+      if (_keys[i] != MGRS::badkey)
+	keys.push_back(_keys[i]);
+    sort(keys.begin(), keys.end());
+    counts.resize(keys.size());
+    sums.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      size_t j = Slot(keys[i]);
+      counts[i] = _counts[j];
+      sums[i] = _sums[j];
+    }
+  }
+
+} // namespace GeographicLib
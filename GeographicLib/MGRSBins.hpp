@@ -0,0 +1,142 @@
+/**
+ * \file MGRSBins.hpp
+ * \brief Header for GeographicLib::MGRSBins class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(MGRSBINS_HPP)
+#define MGRSBINS_HPP "$Id$"
+
+#include "GeographicLib/MGRS.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace GeographicLib {
+
+  /**
+   * \brief Aggregate points into %MGRS squares
+   *
+   * MGRSBins accumulates a count and a sum of values for each MGRS square of
+   * a given precision, keyed by MGRS::cellkey.  No MGRS strings are built;
+   * the bins are held in an open addressing hash table.  The batch version
+   * of Add splits the points between threads (see Parallel), with each
+   * thread filling a private MGRSBins which is then merged into this one.
+   * Other multi-threaded uses should follow the same pattern: give each
+   * thread its own MGRSBins and combine them with Merge.  (A single MGRSBins
+   * object must not be modified by several threads at once.)
+   *
+   * Example of use:
+   \verbatim
+   MGRSBins bins(3);                 // 100 m squares
+   bins.Add(n, lat, lon, 0);         // count the points
+   std::vector<MGRS::cellkey> keys;
+   std::vector<double> counts, sums;
+   bins.Bins(keys, counts, sums);
+   char mgrs[MGRS::bufsize];
+   for (std::size_t i = 0; i < keys.size(); ++i) {
+     MGRS::KeyString(keys[i], mgrs);
+     std::cout << mgrs << " " << counts[i] << "\n";
+   }
+   \endverbatim
+   **********************************************************************/
+  class MGRSBins {
+  private:
+    typedef MGRS::cellkey cellkey;
+    int _prec;
+    std::size_t _size;
+    // The table size is a power of 2; empty slots have key MGRS::badkey.
+    std::vector<cellkey> _keys;
+    std::vector<double> _counts, _sums;
+    static cellkey Hash(cellkey key) throw() {
+      // The finalizer of MurmurHash3; this spreads the fields of the key
+      // over all the bits.
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdULL;
+      key ^= key >> 33;
+      key *= 0xc4ceb9fe1a85ec53ULL;
+      key ^= key >> 33;
+      return key;
+    }
+    std::size_t Slot(cellkey key) const throw() {
+      std::size_t mask = _keys.size() - 1, i = std::size_t(Hash(key)) & mask;
+      while (_keys[i] != key && _keys[i] != MGRS::badkey)
+	i = (i + 1) & mask;
+      return i;
+    }
+    void Rehash(std::size_t n);
+    void Insert(cellkey key, double count, double sum);
+    bool AddPoint(double lat, double lon, double value);
+  public:
+
+    /**
+     * Set up to aggregate points into MGRS squares of precision \e prec
+     * (0 means 100 km, 5 means 1 m).  Throw an error if \e prec is not in
+     * [0, 5].
+     **********************************************************************/
+    explicit MGRSBins(int prec);
+
+    /**
+     * The precision of the squares.
+     **********************************************************************/
+    int Precision() const throw() { return _prec; }
+
+    /**
+     * The number of non-empty bins.
+     **********************************************************************/
+    std::size_t Size() const throw() { return _size; }
+
+    /**
+     * Remove all the bins.
+     **********************************************************************/
+    void Clear();
+
+    /**
+     * Add a point with value \e value to the bin with key \e key, i.e.,
+     * increment its count by 1 and its sum by \e value.  Throw an error if
+     * \e key is MGRS::badkey.
+     **********************************************************************/
+    void Add(MGRS::cellkey key, double value = 0) {
+      Insert(key, 1, value);
+    }
+
+    /**
+     * Add a point given by UTM or UPS coordinates (see MGRS::ForwardKey)
+     * with value \e value.  Return false (without adding the point) if the
+     * coordinates are out of range.
+     **********************************************************************/
+    bool Add(int zone, bool northp, double x, double y, double value = 0);
+
+    /**
+     * Add \e n points with latitudes \e lat[i] and longitudes \e lon[i]
+     * (degrees) and values \e value[i] (if \e value is null, the values are
+     * taken to be 0).  The points are converted to UTM or UPS in their
+     * standard zones.  Return the number of points which could not be
+     * converted (these are skipped).
+     **********************************************************************/
+    int Add(int n, const double lat[], const double lon[],
+	    const double value[]);
+
+    /**
+     * Add the bins of \e bins to this.  Throw an error if the precisions
+     * differ.
+     **********************************************************************/
+    void Merge(const MGRSBins& bins);
+
+    /**
+     * Look up the bin with key \e key, returning its count and sum.  Return
+     * false (and zero \e count and \e sum) if the bin is empty.
+     **********************************************************************/
+    bool Find(MGRS::cellkey key, double& count, double& sum) const throw();
+
+    /**
+     * Return the keys, counts, and sums of the non-empty bins in order of
+     * increasing key.
+     **********************************************************************/
+    void Bins(std::vector<MGRS::cellkey>& keys,
+	      std::vector<double>& counts, std::vector<double>& sums) const;
+  };
+
+} // namespace GeographicLib
+#endif
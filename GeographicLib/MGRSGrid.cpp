@@ -0,0 +1,423 @@
+/**
+ * \file MGRSGrid.cpp
+ * \brief Implementation for GeographicLib::MGRSGrid class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/MGRSGrid.hpp"
+#include "GeographicLib/UTMUPS.hpp"
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = MGRSGRID_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  MGRSGrid::MGRSGrid(double lat1, double lon1, double lat2, double lon2,
+		     int prec)
+    : _prec(prec) {
+    CheckLatLon(lat1, lon1);
+    CheckLatLon(lat2, lon2);
+    if (!(lat1 <= lat2))
+      throw out_of_range("Latitude " + MGRS::str(lat1)
+			 + "d of south edge more than latitude "
+			 + MGRS::str(lat2) + "d of north edge");
+    // Crossing the 180 degree meridian
+    double lon2a = lon2 < lon1 ? lon2 + 360 : lon2;
+    double region[] = { lon1, lat1,  lon2a, lat1,  lon2a, lat2,  lon1, lat2 };
+    Init(vector<double>(region, region + 8));
+  }
+
+  MGRSGrid::MGRSGrid(int n, const double lat[], const double lon[], int prec)
+    : _prec(prec) {
+    if (n < 3)
+      throw out_of_range("Polygon with " + MGRS::str(n)
+			 + " vertices has less than 3");
+    vector<double> region(2 * n);
+    for (int i = 0; i < n; ++i) {
+      CheckLatLon(lat[i], lon[i]);
+      // Unroll the longitudes so that the edges are less than 180d long.
+      double d = i ? lon[i] - lon[i-1] : 0;
+      d -= 360 * floor((d + 180)/360);
+      region[2*i] = i ? region[2*i-2] + d : lon[0];
+      region[2*i+1] = lat[i];
+    }
+    Init(region);
+  }
+
+  void MGRSGrid::CheckLatLon(double lat, double lon) {
+    if (! (lat >= -90 && lat <= 90))
+      throw out_of_range("Latitude " + MGRS::str(lat) +
+			 "d not in [-90d, 90d]");
+    if (! (lon >= -180 && lon <= 360))
+      throw out_of_range("Longitude " + MGRS::str(lon) +
+			 "d not in [-180d, 360d]");
+  }
+
+  void MGRSGrid::Init(const vector<double>& region) {
+    if (!(_prec >= 0 && _prec <= maxprec))
+      throw out_of_range("MGRS grid precision " + MGRS::str(_prec)
+			 + " not in [0, " + MGRS::str(int(maxprec)) + "]");
+    _scale = 1;
+    for (int i = 0; i < _prec; ++i)
+      _scale *= MGRS::base;
+    _unit = double(MGRS::tile) / _scale;
+    // The error from replacing the projected edges by chords is at most
+    // about 1.2m * (step/0.1d)^2.  Make this less than unit/100.
+    _step = min(1.0, 0.1 * sqrt(_unit / 120));
+    double
+      lonmin = numeric_limits<double>::max(), lonmax = -lonmin,
+      latmin = lonmin, latmax = -lonmin;
+    for (size_t i = 0; i < region.size(); i += 2) {
+      lonmin = min(lonmin, region[i]); lonmax = max(lonmax, region[i]);
+      latmin = min(latmin, region[i+1]); latmax = max(latmax, region[i+1]);
+    }
+    vector<double> ring, tmp;
+    for (int zone = 0; zone <= 60; ++zone)
+      for (int h = 0; h < 2; ++h) {
+	Part part;
+	part.zone = zone;
+	part.northp = h != 0;
+	part.tol = 0;
+	int nring = 0;
+	double lat0, lat1, lon0, lon1;
+	for (int s = 0; ZoneArea(zone, part.northp, s,
+				 lat0, lat1, lon0, lon1); ++s) {
+	  if (lon1 == lon0 || lat1 < latmin || lat0 > latmax)
+	    continue;
+	  // Split the UTM areas into latitude bands (band X is 12d high).
+	  for (double la = lat0; la < lat1;) {
+	    int band = zone ? MGRS::LatitudeBand(la) : 0;
+	    double lb = zone ? min(lat1, band == 9 ? 84.0 : 8.0 * (band + 1)) :
+	      lat1;
+	    if (lb >= latmin && la <= latmax)
+	      for (int k = -2; k <= 2; ++k) {
+		double a = lon0 + 360 * k, b = lon1 + 360 * k;
+		if (b < lonmin || a > lonmax)
+		  continue;
+		ring = region;
+		Clip(ring, tmp, 0, a, false); Clip(tmp, ring, 0, b, true);
+		Clip(ring, tmp, 1, la, false); Clip(tmp, ring, 1, lb, true);
+		if (ring.size() >= 6)
+		  AddRing(part, ring, nring++, band);
+	      }
+	    la = lb;
+	  }
+	}
+	if (nring && SetBounds(part))
+	  _parts.push_back(part);
+      }
+  }
+
+  bool MGRSGrid::ZoneArea(int zone, bool northp, int s,
+			  double& lat0, double& lat1,
+			  double& lon0, double& lon1) throw() {
+    // The latitude ranges of the areas of a zone.  The bands between 56d
+    // and 84d are treated separately because of the Norway and Svalbard
+    // exceptions.
+    static const double latbreak[] = {0, 56, 64, 72, 84};
+    if (zone == 0) {
+      if (s > 0)
+	return false;
+      lat0 = northp ? 84 : -90;
+      lat1 = northp ? 90 : -80;
+      lon0 = -180; lon1 = 180;
+      return true;
+    }
+    if (s > (northp ? 3 : 0))
+      return false;
+    lat0 = northp ? latbreak[s] : -80;
+    lat1 = northp ? latbreak[s + 1] : 0;
+    lon0 = 6 * zone - 186; lon1 = lon0 + 6;
+    if (northp && s == 1) {
+      // Band V
+      if (zone == 31)
+	lon1 = 3;
+      else if (zone == 32)
+	lon0 = 3;
+    } else if (northp && s == 3 && zone >= 31 && zone <= 37) {
+      // Band X
+      static const double xlon[] = { 0, 9, 21, 33, 42 };
+      if (zone & 1) {
+	lon0 = xlon[(zone - 31)/2];
+	lon1 = xlon[(zone - 31)/2 + 1];
+      } else
+	lon1 = lon0;		// An empty area
+    }
+    return true;
+  }
+
+  void MGRSGrid::Clip(const vector<double>& in, vector<double>& out,
+		      int c, double v, bool upper) {
+    // One stage of Sutherland-Hodgman clipping.  Keep the points with
+    // coordinate c (0 for longitude, 1 for latitude) >= v (or <= v if
+    // upper).
+    out.clear();
+    size_t n = in.size();
+    for (size_t i = 0; i < n; i += 2) {
+      size_t j = (i + n - 2) % n;
+      bool
+	curin = upper ? in[i + c] <= v : in[i + c] >= v,
+	previn = upper ? in[j + c] <= v : in[j + c] >= v;
+      if (curin != previn) {
+	double t = (v - in[j + c]) / (in[i + c] - in[j + c]);
+	for (int k = 0; k < 2; ++k)
+	  out.push_back(k == c ? v : in[j + k] + t * (in[i + k] - in[j + k]));
+      }
+      if (curin) {
+	out.push_back(in[i]);
+	out.push_back(in[i + 1]);
+      }
+    }
+  }
+
+  void MGRSGrid::AddRing(Part& part, const vector<double>& ring, int r,
+			 int band) {
+    // Densify the edges of the ring and project them into the part.  The
+    // midpoints of the resulting chords are also projected in order to
+    // bound the error in replacing the projected edges by the chords.
+    vector<double> xy, mid;
+    size_t n = ring.size();
+    for (size_t i = 0; i < n; i += 2) {
+      size_t j = (i + 2) % n;
+      double
+	dlon = ring[j] - ring[i],
+	dlat = ring[j + 1] - ring[i + 1];
+      int m = 2 * int(ceil(max(abs(dlon), abs(dlat)) / _step));
+      for (int k = 0; k < m; ++k) {
+	double
+	  lon = ring[i] + dlon * k / m,
+	  lat = min(90.0, max(-90.0, ring[i + 1] + dlat * k / m)),
+	  x, y;
+	int zone;
+	bool northp;
+	UTMUPS::Forward(lat, lon - 360 * floor((lon + 180) / 360),
+			zone, northp, x, y, part.zone);
+	// Points on the equator are returned in the N hemisphere
+	if (northp != part.northp)
+	  y += part.northp ? -MGRS::utmNshift : MGRS::utmNshift;
+	vector<double>& v = k & 1 ? mid : xy;
+	v.push_back(x);
+	v.push_back(y);
+      }
+    }
+    n = xy.size();
+    for (size_t i = 0; i < n; i += 2) {
+      size_t j = (i + 2) % n;
+      part.tol = max(part.tol,
+		     hypot(mid[i] - (xy[i] + xy[j])/2,
+			   mid[i + 1] - (xy[i + 1] + xy[j + 1])/2));
+      if (xy[i] == xy[j] && xy[i + 1] == xy[j + 1])
+	continue;
+      part.edges.push_back(xy[i]); part.edges.push_back(xy[i + 1]);
+      part.edges.push_back(xy[j]); part.edges.push_back(xy[j + 1]);
+      part.ring.push_back(r);
+      part.band.push_back(band);
+    }
+  }
+
+  bool MGRSGrid::SetBounds(Part& part) const throw() {
+    if (part.edges.empty())
+      return false;
+    double
+      xmin = numeric_limits<double>::max(), xmax = -xmin,
+      ymin = xmin, ymax = -xmin;
+    for (size_t i = 0; i < part.edges.size(); i += 2) {
+      xmin = min(xmin, part.edges[i]); xmax = max(xmax, part.edges[i]);
+      ymin = min(ymin, part.edges[i+1]); ymax = max(ymax, part.edges[i+1]);
+    }
+    // Allow for the chord error (with a 50% margin).
+    part.tol *= 1.5;
+    xmin -= part.tol; xmax += part.tol;
+    ymin -= part.tol; ymax += part.tol;
+    bool utmp = part.zone != 0;
+    int ind = (utmp ? 2 : 0) + (part.northp ? 1 : 0);
+    // Restrict to the legal MGRS squares.  The UTM northings are not
+    // continued across the equator.
+    part.ix0 = max(int(floor(xmin / _unit)), MGRS::mineasting[ind] * _scale);
+    part.ix1 = min(int(floor(xmax / _unit)),
+		   MGRS::maxeasting[ind] * _scale - 1);
+    part.iy0 = max(int(floor(ymin / _unit)),
+		   (utmp && part.northp ? int(MGRS::minutmNrow) :
+		    MGRS::minnorthing[ind]) * _scale);
+    part.iy1 = min(int(floor(ymax / _unit)),
+		   (utmp && !part.northp ? int(MGRS::maxutmSrow) :
+		    MGRS::maxnorthing[ind]) * _scale - 1);
+    return part.ix0 <= part.ix1 && part.iy0 <= part.iy1;
+  }
+
+  void MGRSGrid::Iterator::StartPart() throw() {
+    _iy = _grid->_parts[_part].iy0 - 1;
+    _ix = 0;
+    _ixend = -1;
+    _bands.clear();
+    _ib = -1;
+  }
+
+  void MGRSGrid::Iterator::StartRow() {
+    // Collect the edges overlapping the current row and the range of
+    // eastings they cover.  Squares outside this range cannot intersect the
+    // region.
+    const Part& part = _grid->_parts[_part];
+    const double* e = &part.edges[0];
+    double
+      unit = _grid->_unit,
+      y0 = _iy * unit - part.tol,
+      y1 = (_iy + 1) * unit + part.tol,
+      xmin = numeric_limits<double>::max(),
+      xmax = -xmin;
+    _row.clear();
+    _bands.clear();
+    for (int i = 0; i < int(part.ring.size()); ++i, e += 4) {
+      if (min(e[1], e[3]) > y1 || max(e[1], e[3]) < y0)
+	continue;
+      _row.push_back(i);
+      if (find(_bands.begin(), _bands.end(), part.band[i]) == _bands.end())
+	_bands.push_back(part.band[i]);
+      // The portion of the edge within the row
+      double ta = 0, tb = 1;
+      if (e[1] != e[3]) {
+	ta = (y0 - e[1]) / (e[3] - e[1]);
+	tb = (y1 - e[1]) / (e[3] - e[1]);
+	if (ta > tb)
+	  swap(ta, tb);
+	ta = max(0.0, ta); tb = min(1.0, tb);
+      }
+      double
+	xa = e[0] + ta * (e[2] - e[0]),
+	xb = e[0] + tb * (e[2] - e[0]);
+      xmin = min(xmin, min(xa, xb)); xmax = max(xmax, max(xa, xb));
+    }
+    if (_row.empty()) {
+      _ix = 0;
+      _ixend = -1;
+    } else {
+      _ix = max(part.ix0, int(floor((xmin - part.tol) / unit))) - 1;
+      _ixend = min(part.ix1, int(floor((xmax + part.tol) / unit)));
+    }
+    sort(_bands.begin(), _bands.end());
+    // So that Next moves to the first band of the next square
+    _ib = int(_bands.size()) - 1;
+  }
+
+  bool MGRSGrid::Iterator::Covered(int band) const throw() {
+    // Only the edges of the rings for latitude band band are considered.
+    const Part& part = _grid->_parts[_part];
+    double
+      unit = _grid->_unit,
+      x0 = _ix * unit - part.tol, x1 = (_ix + 1) * unit + part.tol,
+      y0 = _iy * unit - part.tol, y1 = (_iy + 1) * unit + part.tol;
+    // Does any edge intersect the square (expanded by the tolerance)?
+    // (Liang-Barsky clipping.)
+    for (size_t k = 0; k < _row.size(); ++k) {
+      if (part.band[_row[k]] != band)
+	continue;
+      const double* e = &part.edges[4 * _row[k]];
+      double
+	dx = e[2] - e[0], dy = e[3] - e[1],
+	p[4] = { -dx, dx, -dy, dy },
+	q[4] = { e[0] - x0, x1 - e[0], e[1] - y0, y1 - e[1] },
+	t0 = 0, t1 = 1;
+      bool hit = true;
+      for (int i = 0; hit && i < 4; ++i) {
+	if (p[i] == 0)
+	  hit = q[i] >= 0;
+	else {
+	  double r = q[i] / p[i];
+	  if (p[i] < 0) {
+	    hit = r <= t1;
+	    t0 = max(t0, r);
+	  } else {
+	    hit = r >= t0;
+	    t1 = min(t1, r);
+	  }
+	}
+      }
+      if (hit)
+	return true;
+    }
+    // Otherwise the square is inside a ring if its center is.  Count the
+    // crossings of a ray running east from the center separately for each
+    // ring, since adjacent rings share edges.  The edges of a ring are
+    // contiguous in _row.
+    double
+      xc = (_ix + 0.5) * unit,
+      yc = (_iy + 0.5) * unit;
+    bool inside = false;
+    int prev = -1;
+    for (size_t k = 0; k < _row.size(); ++k) {
+      if (part.band[_row[k]] != band)
+	continue;
+      if (prev >= 0 && part.ring[_row[k]] != part.ring[prev]) {
+	if (inside)
+	  return true;
+	inside = false;
+      }
+      prev = _row[k];
+      const double* e = &part.edges[4 * _row[k]];
+      if ((e[1] > yc) != (e[3] > yc) &&
+	  xc < e[0] + (yc - e[1]) * (e[2] - e[0]) / (e[3] - e[1]))
+	inside = !inside;
+    }
+    return inside;
+  }
+
+  bool MGRSGrid::Iterator::Next() {
+    while (_part < _endpart) {
+      const Part& part = _grid->_parts[_part];
+      while (true) {
+	while (true) {
+	  // Move to the next band of the square or the next square
+	  if (++_ib >= int(_bands.size())) {
+	    if (++_ix > _ixend)
+	      break;
+	    _ib = 0;
+	  }
+	  if (Covered(_bands[_ib])) {
+	    double unit = _grid->_unit;
+	    UTMUPS::Reverse(part.zone, part.northp,
+			    (_ix + 0.5) * unit, (_iy + 0.5) * unit,
+			    _lat, _lon);
+	    _band = _bands[_ib];
+	    return true;
+	  }
+	}
+	if (++_iy > part.iy1)
+	  break;
+	StartRow();
+      }
+      if (++_part < _endpart)
+	StartPart();
+    }
+    return false;
+  }
+
+  int MGRSGrid::Iterator::MGRS(char mgrs[]) const throw() {
+    // Encode the center of the square with a latitude in the band for
+    // which the square is given (the middle of the band if the center lies
+    // in a neighboring band).
+    double
+      unit = _grid->_unit,
+      lat = _grid->_parts[_part].zone == 0 ||
+      GeographicLib::MGRS::LatitudeBand(_lat) == _band ? _lat :
+      8.0 * _band + 4;
+    int n = GeographicLib::MGRS::Encode(_grid->_parts[_part].zone,
+					_grid->_parts[_part].northp,
+					(_ix + 0.5) * unit, (_iy + 0.5) * unit,
+					lat, _grid->_prec, mgrs, false);
+    if (n < 0) {
+      mgrs[0] = '\0';
+      n = 0;
+    }
+    return n;
+  }
+
+} // namespace GeographicLib
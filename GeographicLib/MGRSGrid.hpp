@@ -0,0 +1,247 @@
+/**
+ * \file MGRSGrid.hpp
+ * \brief Header for GeographicLib::MGRSGrid class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(MGRSGRID_HPP)
+#define MGRSGRID_HPP "$Id$"
+
+#include "GeographicLib/MGRS.hpp"
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace GeographicLib {
+
+  /**
+   * \brief Enumerate the %MGRS squares covering a region
+   *
+   * The region is given either as a latitude/longitude box or as a polygon
+   * whose edges are straight lines in latitude and longitude.  MGRSGrid
+   * splits the region into \e parts, one for each UTM zone and hemisphere
+   * and one for each UPS cap that it overlaps, honoring the Norway and
+   * Svalbard exceptions of UTMUPS::StandardZone.  The squares of a part at a
+   * given precision are then produced lazily, row by row, by an
+   * MGRSGrid::Iterator.  A square is included if it intersects the portion
+   * of the region lying within the standard area of its zone and its
+   * latitude band.  Thus squares cut by a zone boundary are given in both
+   * zones and squares straddling a latitude band boundary are given once for
+   * each band (with that band's letter), in agreement with the labels that
+   * MGRS::Forward gives to the points of the region.
+   *
+   * The tests are carried out in the projected coordinates of each part:
+   * the edges of the region are densified and projected so that the square
+   * sides can be compared exactly.  The densification is fine enough that
+   * the error from replacing the projected edges by chords is about 1/100
+   * of the size of the square; the squares are expanded by a bound on this
+   * error so that the squares given always cover the region.
+   *
+   * The object is not changed by iterating over it and the parts are
+   * independent of one another.  So the parts can be processed in parallel,
+   * for example, with
+   \verbatim
+   MGRSGrid grid(40.0, -75.0, 45.0, -69.0, 2);
+   #pragma omp parallel for
+   for (int p = 0; p < grid.Parts(); ++p) {
+     char mgrs[MGRS::bufsize];
+     for (MGRSGrid::Iterator i = grid.Begin(p); i.Next();) {
+       i.MGRS(mgrs);
+       ...
+     }
+   }
+   \endverbatim
+   **********************************************************************/
+  class MGRSGrid {
+  private:
+    struct Part {
+      int zone;
+      bool northp;
+      // Range of the square indices (inclusive)
+      int ix0, ix1, iy0, iy1;
+      // The projected boundary as edges xa, ya, xb, yb
+      std::vector<double> edges;
+      // The ring number and the latitude band (0 for UPS) of each edge
+      std::vector<int> ring, band;
+      // The maximum error in replacing the projected edges by chords
+      double tol;
+    };
+    enum { maxprec = 5 };
+    int _prec, _scale;
+    // The size of the squares and the step size (degrees) for densifying
+    // the edges of the region
+    double _unit, _step;
+    std::vector<Part> _parts;
+#if defined(_MSC_VER)
+    static inline double hypot(double x, double y) throw()
+    { return _hypot(x, y); }
+#else
+    static inline double hypot(double x, double y) throw()
+    { return ::hypot(x, y); }
+#endif
+    static void CheckLatLon(double lat, double lon);
+    // The region is given as pairs of longitude and latitude with the
+    // longitudes unrolled.
+    void Init(const std::vector<double>& region);
+    // Return the latitude and longitude ranges of area s of zone.  Return
+    // false if there are no more areas.
+    static bool ZoneArea(int zone, bool northp, int s,
+			 double& lat0, double& lat1,
+			 double& lon0, double& lon1) throw();
+    static void Clip(const std::vector<double>& in, std::vector<double>& out,
+		     int c, double v, bool upper);
+    void AddRing(Part& part, const std::vector<double>& ring, int r,
+		 int band);
+    bool SetBounds(Part& part) const throw();
+  public:
+
+    /**
+     * Set up to enumerate the MGRS squares of precision \e prec (0 means 100
+     * km, 5 means 1 m) covering the box with south west corner (\e lat1, \e
+     * lon1) and north east corner (\e lat2, \e lon2) (degrees).  If \e lon2
+     * < \e lon1, the box crosses the 180 degree meridian.  Throw an error if
+     * \e lat1 > \e lat2 or if \e prec is not in [0, 5].
+     **********************************************************************/
+    MGRSGrid(double lat1, double lon1, double lat2, double lon2, int prec);
+
+    /**
+     * Set up to enumerate the MGRS squares of precision \e prec covering the
+     * polygon with \e n vertices (\e lat[i], \e lon[i]) (degrees).  The edges
+     * are straight lines in latitude and longitude and consecutive vertices
+     * should differ in longitude by less than 180 degrees.  The polygon may
+     * cross the 180 degree meridian but should not encircle a pole.  Throw an
+     * error if \e n < 3 or if \e prec is not in [0, 5].
+     **********************************************************************/
+    MGRSGrid(int n, const double lat[], const double lon[], int prec);
+
+    /**
+     * The number of parts (UTM zone/hemisphere or UPS cap combinations) of
+     * the region.
+     **********************************************************************/
+    int Parts() const throw() { return int(_parts.size()); }
+
+    /**
+     * The zone of part \e p (0 means UPS).
+     **********************************************************************/
+    int Zone(int p) const throw() { return _parts[p].zone; }
+
+    /**
+     * The hemisphere of part \e p.
+     **********************************************************************/
+    bool Northp(int p) const throw() { return _parts[p].northp; }
+
+    /**
+     * The precision of the squares.
+     **********************************************************************/
+    int Precision() const throw() { return _prec; }
+
+    /**
+     * \brief Iterate over the squares of an MGRSGrid
+     *
+     * Next() must be called to move to the first square.  The squares of a
+     * part are given in order of increasing northing and then increasing
+     * easting.  The iterator holds a pointer to the MGRSGrid which must
+     * therefore outlive it.
+     **********************************************************************/
+    class Iterator {
+    private:
+      friend class MGRSGrid;
+      const MGRSGrid* _grid;
+      int _part, _endpart;
+      int _ix, _iy, _ixend, _ib, _band;
+      double _lat, _lon;
+      // Indices of the edges of the current part overlapping the current row
+      std::vector<int> _row;
+      // The latitude bands of these edges
+      std::vector<int> _bands;
+      Iterator(const MGRSGrid* grid, int part, int endpart) throw()
+	: _grid(grid), _part(part), _endpart(endpart)
+	, _ix(0), _iy(0), _ixend(-1), _ib(0), _band(0)
+      { if (_part < _endpart) StartPart(); }
+      void StartPart() throw();
+      void StartRow();
+      bool Covered(int band) const throw();
+    public:
+
+      /**
+       * A default constructor for an iterator with no squares.
+       **********************************************************************/
+      Iterator() throw()
+	: _grid(0), _part(0), _endpart(0), _ix(0), _iy(0), _ixend(-1)
+	, _ib(0), _band(0) {}
+
+      /**
+       * Move to the next square.  Return false when there are no more.  This
+       * throws std::bad_alloc if the memory for the edges of a row can't be
+       * allocated.
+       **********************************************************************/
+      bool Next();
+
+      /**
+       * The zone of the current square (0 means UPS).
+       **********************************************************************/
+      int Zone() const throw() { return _grid->_parts[_part].zone; }
+
+      /**
+       * The hemisphere of the current square.
+       **********************************************************************/
+      bool Northp() const throw() { return _grid->_parts[_part].northp; }
+
+      /**
+       * The easting of the south west corner of the current square (meters).
+       **********************************************************************/
+      double Easting() const throw() { return _ix * _grid->_unit; }
+
+      /**
+       * The northing of the south west corner of the current square
+       * (meters).
+       **********************************************************************/
+      double Northing() const throw() { return _iy * _grid->_unit; }
+
+      /**
+       * The latitude of the center of the current square (degrees).  If the
+       * square straddles a latitude band boundary, the center may lie in a
+       * different band from the one for which the square is given.
+       **********************************************************************/
+      double Latitude() const throw() { return _lat; }
+
+      /**
+       * The longitude of the center of the current square (degrees).
+       **********************************************************************/
+      double Longitude() const throw() { return _lon; }
+
+      /**
+       * Write the MGRS string for the current square into \e mgrs (which must
+       * have room for MGRSGrid::Precision() * 2 + 6 chars) and return its
+       * length.
+       **********************************************************************/
+      int MGRS(char mgrs[]) const throw();
+
+      /**
+       * Return the MGRS string for the current square.
+       **********************************************************************/
+      std::string MGRS() const {
+	char mgrs[GeographicLib::MGRS::bufsize];
+	return std::string(mgrs, MGRS(mgrs));
+      }
+    };
+
+    /**
+     * Return an iterator over the squares of part \e p.
+     **********************************************************************/
+    Iterator Begin(int p) const throw() {
+      return Iterator(this, p, p + 1);
+    }
+
+    /**
+     * Return an iterator over the squares of all the parts.
+     **********************************************************************/
+    Iterator Begin() const throw() {
+      return Iterator(this, 0, Parts());
+    }
+  };
+
+} // namespace GeographicLib
+#endif
@@ -0,0 +1,252 @@
+/**
+ * \file Multilateration.cpp
+ * \brief Implementation for GeographicLib::Multilateration class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/Multilateration.hpp"
+#include "GeographicLib/Constants.hpp"
+#include "GeographicLib/Parallel.hpp"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = MULTILATERATION_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  double Multilateration::Normal(int n, const double lats[],
+				 const double lons[], const double ranges[],
+				 const double sigmas[], double lat, double lon,
+				 double h[], double g[]) const throw() {
+    double chi2 = 0;
+    h[0] = h[1] = h[2] = g[0] = g[1] = 0;
+    for (int i = 0; i < n; ++i) {
+      double s12, azi1, azi2;
+      _g.Inverse(lats[i], lons[i], lat, lon, s12, azi1, azi2);
+      double
+	w = sigmas ? 1 / sigmas[i] : 1,
+	r = (s12 - ranges[i]) * w,
+	alp = azi2 * Constants::degree(),
+	// Derivatives of r with respect to displacements north and east
+	jn = cos(alp) * w,
+	je = sin(alp) * w;
+      chi2 += r * r;
+      h[0] += jn * jn; h[1] += jn * je; h[2] += je * je;
+      g[0] += jn * r; g[1] += je * r;
+    }
+    return chi2;
+  }
+
+  void Multilateration::Unit(double lat, double lon, double u[]) throw() {
+    double
+      phi = lat * Constants::degree(),
+      lam = lon * Constants::degree();
+    u[0] = cos(phi) * cos(lam);
+    u[1] = cos(phi) * sin(lam);
+    u[2] = sin(phi);
+  }
+
+  void Multilateration::Start(int n, const double lats[], const double lons[],
+			      const double ranges[],
+			      double lat[], double lon[]) const throw() {
+    // On a sphere of radius R, the unit vector x to the solution satisfies
+    // u[i] . x = cos(ranges[i] / R) where u[i] is the unit vector to
+    // station i.  Write x = p + z where p is the unit vector to the centroid
+    // of the stations and solve u[i] . z = cos(ranges[i] / R) - u[i] . p in
+    // the least squares sense for z (ignoring the constraint |x| = 1).  The
+    // right hand sides are computed without cancellation, so that this is
+    // accurate even if the stations are close together.
+    double
+      R = (2 * _a + _a * _f1) / 3,
+      p[3] = {0, 0, 0},
+      u0[3],
+      e[3] = {0, 0, 0};                 // largest u[0] x u[i]
+    Unit(lats[0], lons[0], u0);
+    for (int i = 0; i < n; ++i) {
+      double u[3], v[3];
+      Unit(lats[i], lons[i], u);
+      for (int k = 0; k < 3; ++k)
+	p[k] += u[k];
+      Cross(u0, u, v);
+      if (Norm2(v) > Norm2(e))
+	copy(v, v + 3, e);
+    }
+    double t = sqrt(Norm2(p));
+    if (t > 0)
+      for (int k = 0; k < 3; ++k)
+	p[k] /= t;
+    else
+      copy(u0, u0 + 3, p);
+    double
+      m[6] = {0, 0, 0, 0, 0, 0},        // xx, xy, xz, yy, yz, zz
+      b[3] = {0, 0, 0};
+    for (int i = 0; i < n; ++i) {
+      double u[3], v[3];
+      Unit(lats[i], lons[i], u);
+      Cross(u, p, v);
+      double
+	sig = ranges[i] / R,
+	theta = atan2(sqrt(Norm2(v)), u[0] * p[0] + u[1] * p[1] + u[2] * p[2]),
+	// cos(sig) - cos(theta)
+	r = -2 * sin((sig + theta) / 2) * sin((sig - theta) / 2);
+      m[0] += u[0] * u[0]; m[1] += u[0] * u[1]; m[2] += u[0] * u[2];
+      m[3] += u[1] * u[1]; m[4] += u[1] * u[2]; m[5] += u[2] * u[2];
+      for (int k = 0; k < 3; ++k)
+	b[k] += r * u[k];
+    }
+    double
+      // Cofactors of m
+      a0 = m[3] * m[5] - m[4] * m[4],
+      a1 = m[2] * m[4] - m[1] * m[5],
+      a2 = m[1] * m[4] - m[2] * m[3],
+      a3 = m[0] * m[5] - m[2] * m[2],
+      a4 = m[1] * m[2] - m[0] * m[4],
+      a5 = m[0] * m[3] - m[1] * m[1],
+      det = m[0] * a0 + m[1] * a1 + m[2] * a2,
+      x[3] = {0, 0, 0};
+    if (det > 0) {
+      x[0] = (a0 * b[0] + a1 * b[1] + a2 * b[2]) / det;
+      x[1] = (a1 * b[0] + a3 * b[1] + a4 * b[2]) / det;
+      x[2] = (a2 * b[0] + a4 * b[1] + a5 * b[2]) / det;
+    }
+    // m is singular if the stations lie on one great circle; then start at
+    // their centroid.
+    if (!(Norm2(x) < 4))
+      x[0] = x[1] = x[2] = 0;
+    for (int k = 0; k < 3; ++k)
+      x[k] += p[k];
+    // If the stations are nearly on a great circle, the solution is nearly
+    // ambiguous; the other candidate is the reflection of x in the plane
+    // through u[0] and the station farthest from it.
+    double e2 = Norm2(e), xe = e2 > 0 ?
+      (x[0] * e[0] + x[1] * e[1] + x[2] * e[2]) / e2 : 0;
+    for (int j = 0; j < 2; ++j) {
+      double
+	y0 = x[0] - 2 * j * xe * e[0],
+	y1 = x[1] - 2 * j * xe * e[1],
+	y2 = x[2] - 2 * j * xe * e[2];
+      lat[j] = atan2(y2, hypot(y0, y1)) / Constants::degree();
+      lon[j] = AngNormalize(atan2(y1, y0) / Constants::degree());
+    }
+  }
+
+  int Multilateration::Iterate(int n, const double lats[],
+			       const double lons[], const double ranges[],
+			       const double sigmas[], double& lat,
+			       double& lon, double h[], double& chi2)
+    const throw() {
+    double g[2];
+    chi2 = Normal(n, lats, lons, ranges, sigmas, lat, lon, h, g);
+    double lambda = 1e-3;
+    // Levenberg-Marquardt with the step (dn, de) measured in meters north
+    // and east from lat, lon.
+    for (int iter = 0; iter < maxit;) {
+      double
+	a00 = h[0] * (1 + lambda), a11 = h[2] * (1 + lambda),
+	det = a00 * a11 - h[1] * h[1];
+      if (!(det > 0))
+	break;
+      double
+	dn = -(a11 * g[0] - h[1] * g[1]) / det,
+	de = -(a00 * g[1] - h[1] * g[0]) / det,
+	// Convert the step to degrees using the meridional and transverse
+	// radii of curvature.
+	phi = lat * Constants::degree(),
+	w2 = 1 - _e2 * sq(sin(phi)),
+	rn = _a / sqrt(w2),
+	rm = rn * sq(_f1) / w2,
+	lat1 = lat + dn / rm / Constants::degree(),
+	lon1 = lon + de / (rn * max(cos(phi), eps2())) /
+	Constants::degree();
+      if (abs(lat1) > 90) {
+	// Stepped over a pole
+	lat1 = (lat1 > 0 ? 180 : -180) - lat1;
+	lon1 += 180;
+      }
+      lon1 = AngNormalize(fmod(lon1, 360.0));
+      if (hypot(dn, de) <= tol()) {
+	// Converged; the change in chi2 and h is negligible.
+	lat = lat1; lon = lon1;
+	return iter;
+      }
+      ++iter;
+      double h1[3], g1[2],
+	chi21 = Normal(n, lats, lons, ranges, sigmas, lat1, lon1, h1, g1);
+      if (chi21 <= chi2) {
+	lat = lat1; lon = lon1; chi2 = chi21;
+	copy(h1, h1 + 3, h);
+	copy(g1, g1 + 2, g);
+	lambda = max(lambda / 10, 1e-12);
+      } else
+	lambda *= 10;
+    }
+    return -1;
+  }
+
+  int Multilateration::Solve(int n, const double lats[], const double lons[],
+			     const double ranges[], const double sigmas[],
+			     double& lat, double& lon, double cov[],
+			     double& chi2) const throw() {
+    const double nan = numeric_limits<double>::quiet_NaN();
+    cov[0] = cov[1] = cov[2] = nan;
+    if (n < 2) {
+      lat = lon = chi2 = nan;
+      return -1;
+    }
+    double lat0[2], lon0[2], h[3];
+    Start(n, lats, lons, ranges, lat0, lon0);
+    lat = lat0[0]; lon = lon0[0];
+    int iter = Iterate(n, lats, lons, ranges, sigmas, lat, lon, h, chi2);
+    // A large chi2 indicates that the iterations ended at the wrong
+    // minimum; so try again from the other starting point.
+    if (iter < 0 || chi2 > 10 * n) {
+      double lat1 = lat0[1], lon1 = lon0[1], h1[3], chi21;
+      int iter1 = Iterate(n, lats, lons, ranges, sigmas,
+			  lat1, lon1, h1, chi21);
+      if (iter1 >= 0 && (iter < 0 || chi21 < chi2)) {
+	lat = lat1; lon = lon1; chi2 = chi21;
+	copy(h1, h1 + 3, h);
+      }
+      // The total number of iterations if either run converged
+      iter = iter < 0 ? iter1 : (iter1 < 0 ? iter : iter + iter1);
+    }
+    double det = h[0] * h[2] - h[1] * h[1];
+    if (iter < 0 || !(det > 0))
+      return -1;
+    cov[0] = h[2] / det;
+    cov[1] = -h[1] / det;
+    cov[2] = h[0] / det;
+    return iter;
+  }
+
+  void Multilateration::Solve(int m, const int start[],
+			      const double lats[], const double lons[],
+			      const double ranges[], const double sigmas[],
+			      double lat[], double lon[], double cov[],
+			      double chi2[], int iter[]) const throw() {
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(Parallel::Threads(m, minchunk)) schedule(static)
+#endif
+    for (int j = 0; j < m; ++j) {
+      int k = start[j];
+      double c[3], x;
+      int it = Solve(start[j + 1] - k, lats + k, lons + k, ranges + k,
+		     sigmas ? sigmas + k : 0, lat[j], lon[j], c, x);
+      if (cov)
+	copy(c, c + 3, cov + 3 * j);
+      if (chi2)
+	chi2[j] = x;
+      if (iter)
+	iter[j] = it;
+    }
+  }
+
+} // namespace GeographicLib
@@ -0,0 +1,149 @@
+/**
+ * \file Multilateration.hpp
+ * \brief Header for GeographicLib::Multilateration class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(MULTILATERATION_HPP)
+#define MULTILATERATION_HPP "$Id$"
+
+#include "GeographicLib/Geodesic.hpp"
+#include <cmath>
+#include <limits>
+
+namespace GeographicLib {
+
+  /**
+   * \brief Position from geodesic ranges to known stations
+   *
+   * Find the point on the ellipsoid whose geodesic distances to \e n
+   * stations best match measured ranges in the least squares sense.  The
+   * starting guess is found by solving the problem on a sphere, which
+   * requires only a linear solution.  This is then refined by
+   * Levenberg-Marquardt iterations in which the distances and their
+   * derivatives are given by Geodesic::Inverse; the derivative of the
+   * distance from a station with respect to a displacement of the solution
+   * is the unit vector along the geodesic there, so this is exact.  A solve
+   * typically takes 3 or 4 iterations (each requiring \e n calls to
+   * Geodesic::Inverse).
+   *
+   * The results include the covariance of the north and east components of
+   * the position (in meters<sup>2</sup>) and chi<sup>2</sup> = sum ((\e
+   * s12[i] - \e range[i]) / \e sigma[i])<sup>2</sup>, where \e sigma[i] is
+   * the standard deviation of \e range[i].  The covariance is found from the
+   * given \e sigma; if these are only relative weights, multiply it by
+   * chi<sup>2</sup> / (\e n - 2).
+   *
+   * The solution is unique if there are at least 3 stations which do not
+   * lie on a single geodesic and the ranges are less than about a quarter
+   * of the circumference of the earth; otherwise the iterations may end at
+   * one of several local minima.  In particular, if the stations lie nearly
+   * on a geodesic, the reflection of the solution in that geodesic fits the
+   * ranges nearly as well.  If chi<sup>2</sup> > 10 \e n at the end of the
+   * iterations, they are repeated starting from the reflected point and the
+   * better solution is returned.
+   **********************************************************************/
+  class Multilateration {
+  private:
+    // Minimum number of problems to hand to each thread.
+    enum { minchunk = 16 };
+    static const int maxit = 100;
+    const Geodesic& _g;
+    // The major radius, 1 - f, and e^2 of the ellipsoid
+    const double _a, _f1, _e2;
+    static inline double sq(double x) throw() { return x * x; }
+#if defined(_MSC_VER)
+    static inline double hypot(double x, double y) throw()
+    { return _hypot(x, y); }
+#else
+    static inline double hypot(double x, double y) throw()
+    { return ::hypot(x, y); }
+#endif
+    // Underflow guard (as in Geodesic)
+    static inline double eps2() throw()
+    { return std::sqrt(std::numeric_limits<double>::min()); }
+    static inline double AngNormalize(double x) throw() {
+      // Place angle in [-180, 180).  Assumes x is in [-540, 540).
+      return x >= 180 ? x - 360 : x < -180 ? x + 360 : x;
+    }
+    static inline double Norm2(const double x[]) throw()
+    { return x[0] * x[0] + x[1] * x[1] + x[2] * x[2]; }
+    static inline void Cross(const double x[], const double y[], double z[])
+      throw() {
+      z[0] = x[1] * y[2] - x[2] * y[1];
+      z[1] = x[2] * y[0] - x[0] * y[2];
+      z[2] = x[0] * y[1] - x[1] * y[0];
+    }
+    // The unit vector u[0..2] to lat, lon on a sphere.
+    static void Unit(double lat, double lon, double u[]) throw();
+    // The step (meters) below which the solution is considered converged
+    inline double tol() const throw()
+    { return 1000 * std::numeric_limits<double>::epsilon() * _a; }
+    // Accumulate the normal equations h[0..2] (upper triangle of J^T J)
+    // and g[0..1] (J^T r) at lat, lon; return chi2.
+    double Normal(int n, const double lats[], const double lons[],
+		  const double ranges[], const double sigmas[],
+		  double lat, double lon, double h[], double g[]) const throw();
+    // Two starting guesses: the solution on a sphere and its reflection in
+    // the plane of the stations.
+    void Start(int n, const double lats[], const double lons[],
+	       const double ranges[], double lat[], double lon[])
+      const throw();
+    // Levenberg-Marquardt from lat, lon; return the number of iterations or
+    // -1 on failure.
+    int Iterate(int n, const double lats[], const double lons[],
+		const double ranges[], const double sigmas[],
+		double& lat, double& lon, double h[], double& chi2)
+      const throw();
+  public:
+
+    /**
+     * Constructor for solving on the ellipsoid given by \e g (default
+     * Geodesic::WGS84).
+     **********************************************************************/
+    explicit Multilateration(const Geodesic& g = Geodesic::WGS84) throw()
+      : _g(g)
+      , _a(g.MajorRadius())
+      , _f1(1 - g.Flattening())
+      , _e2(g.Flattening() * (2 - g.Flattening())) {}
+
+    /**
+     * Find the position given \e n stations at latitudes \e lats[i] and
+     * longitudes \e lons[i] (degrees) and the measured ranges \e ranges[i]
+     * (meters) to them with standard deviations \e sigmas[i] (meters); if \e
+     * sigmas is 0, all the standard deviations are taken to be 1 m.  Return
+     * the latitude \e lat and longitude \e lon (degrees) of the solution,
+     * the covariance of its north and east components in \e cov[0..2] (the
+     * variance north, the covariance, and the variance east, in
+     * meters<sup>2</sup>), and chi<sup>2</sup> in \e chi2.  The value
+     * returned is the number of iterations, or -1 (and \e cov is set to
+     * NaNs) if \e n < 2, the iterations did not converge, or the geometry
+     * was degenerate.  \e lon is in the range [-180, 180).
+     **********************************************************************/
+    int Solve(int n, const double lats[], const double lons[],
+	      const double ranges[], const double sigmas[],
+	      double& lat, double& lon, double cov[], double& chi2)
+      const throw();
+
+    /**
+     * Solve \e m independent problems.  The stations for problem \e j are
+     * those with indices \e k in [\e start[j], \e start[j+1]) in \e lats, \e
+     * lons, \e ranges, and \e sigmas (so \e start has \e m + 1 elements).
+     * This is equivalent to calling Solve(\e start[j+1] - \e start[j], \e
+     * lats + \e start[j], ..., \e lat[j], \e lon[j], \e cov + 3 \e j, \e
+     * chi2[j]) and storing the value returned in \e iter[j] for each \e j in
+     * [0, \e m).  \e cov, \e chi2, and \e iter may be 0 if these results
+     * are not needed.
+     **********************************************************************/
+    void Solve(int m, const int start[],
+	       const double lats[], const double lons[],
+	       const double ranges[], const double sigmas[],
+	       double lat[], double lon[], double cov[], double chi2[],
+	       int iter[]) const throw();
+  };
+
+} // namespace GeographicLib
+
+#endif
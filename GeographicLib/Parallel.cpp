@@ -0,0 +1,32 @@
+/**
+ * \file Parallel.cpp
+ * \brief Implementation for GeographicLib::Parallel class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/Parallel.hpp"
+#include <algorithm>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = PARALLEL_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  int Parallel::Threads(int n, int chunk) throw() {
+#if defined(_OPENMP)
+    return max(1, min(omp_get_max_threads(), n / max(chunk, 1)));
+#else
+    return 1;
+#endif
+  }
+
+} // namespace GeographicLib
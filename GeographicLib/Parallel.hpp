@@ -0,0 +1,45 @@
+/**
+ * \file Parallel.hpp
+ * \brief Header for GeographicLib::Parallel class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(PARALLEL_HPP)
+#define PARALLEL_HPP "$Id$"
+
+namespace GeographicLib {
+
+  /**
+   * \brief Splitting batches between threads
+   *
+   * The batch versions of the functions in %GeographicLib (those taking a
+   * count \e n and arrays of inputs and outputs) give the same results as
+   * calling the single versions for each element.  If the library is
+   * compiled with OpenMP, the elements of a batch are split between
+   * threads, but only if each thread gets at least a minimum number of
+   * elements.  This is Parallel::minchunk for the conversions, each of
+   * which take about a microsecond, and less for costlier calculations
+   * (Multilateration and GeodesicRoute).  Small batches are handled by the
+   * calling thread alone.
+   **********************************************************************/
+  class Parallel {
+  public:
+    /**
+     * The minimum number of elements of a batch of conversions to hand to
+     * each thread.
+     **********************************************************************/
+    enum { minchunk = 10000 };
+
+    /**
+     * Return the number of threads to use for a batch of \e n elements if
+     * each thread should get at least \e chunk of them.  This is 1 if the
+     * library is compiled without OpenMP.
+     **********************************************************************/
+    static int Threads(int n, int chunk = minchunk) throw();
+  };
+
+} // namespace GeographicLib
+
+#endif
@@ -0,0 +1,262 @@
+/**
+ * \file PointFile.cpp
+ * \brief Implementation for GeographicLib::PointFile class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/PointFile.hpp"
+#include <cstring>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = POINTFILE_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  namespace {
+    const char magic[8] = {'G', 'e', 'o', 'P', 't', 's', '\0', '\0'};
+    const unsigned byteorder = 0x01020304U, version = 1;
+  }
+
+  PointFile::PointFile() throw()
+    : _data(0)
+    , _bytes(0)
+    , _mapped(false)
+    , _writable(false)
+    , _dev(0)
+    , _ino(0)
+    , _n(0)
+    , _stride(0)
+    , _ncols(0)
+    , _zones(false)
+  {}
+
+  PointFile::~PointFile() throw() {
+    Close();
+  }
+
+  void PointFile::Open(const string& filename) {
+    Close();
+#if defined(_WIN32)
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (!f)
+      throw runtime_error("Cannot open point file " + filename);
+    fseek(f, 0, SEEK_END);
+    long bytes = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    _buffer.resize(bytes > 0 ? bytes : 1);
+    size_t nread = bytes > 0 ? fread(&_buffer[0], 1, bytes, f) : 0;
+    fclose(f);
+    if (bytes < 0 || nread != size_t(bytes)) {
+      _buffer.clear();
+      throw runtime_error("Cannot read point file " + filename);
+    }
+    _data = &_buffer[0];
+    _bytes = bytes;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw runtime_error("Cannot open point file " + filename);
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < off_t(headersize)) {
+      close(fd);
+      throw runtime_error(filename + " is not a point file");
+    }
+    void* p = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping persists after the file is closed.
+    close(fd);
+    if (p == MAP_FAILED)
+      throw runtime_error("Cannot map point file " + filename);
+    // The tools scan the columns from start to finish.
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    _data = static_cast<char*>(p);
+    _bytes = st.st_size;
+    _mapped = true;
+    _dev = st.st_dev;
+    _ino = st.st_ino;
+#endif
+    _filename = filename;
+    try {
+      ReadHeader();
+    }
+    catch (const runtime_error&) {
+      Close();
+      throw;
+    }
+  }
+
+  void PointFile::ReadHeader() {
+    unsigned order, vers, ncols, zones;
+    unsigned long long n;
+    if (_bytes < size_t(headersize) || memcmp(_data, magic, 8) != 0)
+      throw runtime_error(_filename + " is not a point file");
+    memcpy(&order, _data + 8, 4);
+    memcpy(&vers, _data + 12, 4);
+    memcpy(&n, _data + 16, 8);
+    memcpy(&ncols, _data + 24, 4);
+    memcpy(&zones, _data + 28, 4);
+    if (order != byteorder)
+      throw runtime_error("Point file " + _filename
+			  + " was written with a different byte order");
+    if (vers != version)
+      throw runtime_error("Point file " + _filename
+			  + " has an unsupported version");
+    if (ncols > unsigned(maxcols) || zones > 1)
+      throw runtime_error("Point file " + _filename + " has a bad header");
+    _n = size_t(n);
+    _stride = Align(_n * sizeof(double));
+    _ncols = int(ncols);
+    _zones = zones != 0;
+    // Check the sizes of the columns one at a time, so that a header with
+    // a huge n can't make the total wrap around.
+    size_t avail = _bytes - headersize;
+    if (_n != n || _stride / sizeof(double) < _n ||
+	(_ncols > 0 && _stride > avail / _ncols))
+      throw runtime_error("Point file " + _filename + " is truncated");
+    avail -= _ncols * _stride;
+    if (_zones && _n > avail)
+      throw runtime_error("Point file " + _filename + " is truncated");
+    _names.resize(_ncols);
+    for (int k = 0; k < _ncols; ++k) {
+      const char
+	*name = _data + 32 + k * namesize,
+	*end = static_cast<const char*>(memchr(name, '\0', namesize));
+      _names[k] = string(name, end ? end - name : int(namesize));
+    }
+  }
+
+  void PointFile::Create(const string& filename, size_t n,
+			 const string& names, bool zones,
+			 const PointFile* input) {
+    Close();
+#if !defined(_WIN32)
+    // Opening the input with O_TRUNC would zero the data still to be read.
+    // (On Windows the input has been read into memory.)
+    struct stat st;
+    if (input && input->_mapped && stat(filename.c_str(), &st) == 0 &&
+	(unsigned long long)(st.st_dev) == input->_dev &&
+	(unsigned long long)(st.st_ino) == input->_ino)
+      throw runtime_error("Cannot overwrite the input point file "
+			  + filename);
+#endif
+    vector<string> cols;
+    {
+      istringstream str(names);
+      string name;
+      while (str >> name) {
+	if (name.size() >= size_t(namesize))
+	  throw runtime_error("Column name " + name + " is too long");
+	cols.push_back(name);
+      }
+    }
+    if (cols.size() > size_t(maxcols))
+      throw runtime_error("Too many columns for a point file");
+    size_t
+      stride = Align(n * sizeof(double)),
+      bytes = headersize + cols.size() * stride + (zones ? n : 0);
+#if defined(_WIN32)
+    _buffer.assign(bytes, 0);
+    _data = &_buffer[0];
+#else
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0)
+      throw runtime_error("Cannot create point file " + filename);
+    if (ftruncate(fd, off_t(bytes)) < 0) {
+      close(fd);
+      throw runtime_error("Cannot extend point file " + filename);
+    }
+    void* p = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+      throw runtime_error("Cannot map point file " + filename);
+    _data = static_cast<char*>(p);
+    _mapped = true;
+#endif
+    _bytes = bytes;
+    _writable = true;
+    _filename = filename;
+    _n = n;
+    _stride = stride;
+    _ncols = int(cols.size());
+    _zones = zones;
+    _names = cols;
+    unsigned long long n1 = n;
+    unsigned ncols = _ncols, zones1 = _zones ? 1 : 0;
+    memcpy(_data, magic, 8);
+    memcpy(_data + 8, &byteorder, 4);
+    memcpy(_data + 12, &version, 4);
+    memcpy(_data + 16, &n1, 8);
+    memcpy(_data + 24, &ncols, 4);
+    memcpy(_data + 28, &zones1, 4);
+    for (int k = 0; k < _ncols; ++k)
+      // The file is initially zero so the names are null padded.
+      memcpy(_data + 32 + k * namesize, _names[k].data(), _names[k].size());
+    if (_zones)
+      memset(Zones(), nozone, _n);
+  }
+
+  void PointFile::Close() throw() {
+    if (!_data)
+      return;
+#if defined(_WIN32)
+    if (_writable) {
+      FILE* f = fopen(_filename.c_str(), "wb");
+      if (f) {
+	fwrite(_data, 1, _bytes, f);
+	fclose(f);
+      }
+    }
+    _buffer.clear();
+#else
+    if (_mapped)
+      munmap(_data, _bytes);
+#endif
+    _data = 0;
+    _bytes = 0;
+    _mapped = _writable = false;
+    _dev = _ino = 0;
+    _n = _stride = 0;
+    _ncols = 0;
+    _zones = false;
+    _names.clear();
+  }
+
+  int PointFile::Find(const string& name) const throw() {
+    for (int k = 0; k < _ncols; ++k)
+      if (_names[k] == name)
+	return k;
+    return -1;
+  }
+
+  const double* PointFile::Data(const string& name) const {
+    int k = Find(name);
+    if (k < 0)
+      throw runtime_error("Point file " + _filename + " has no column "
+			  + name);
+    return Data(k);
+  }
+
+  double* PointFile::Data(const string& name) {
+    int k = Find(name);
+    if (k < 0)
+      throw runtime_error("Point file " + _filename + " has no column "
+			  + name);
+    return Data(k);
+  }
+
+} // namespace GeographicLib
@@ -0,0 +1,216 @@
+/**
+ * \file PointFile.hpp
+ * \brief Header for GeographicLib::PointFile class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(POINTFILE_HPP)
+#define POINTFILE_HPP "$Id$"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GeographicLib {
+
+  /**
+   * \brief Memory-mapped columnar files of points
+   *
+   * A point file holds \e n points as named columns of doubles together with
+   * an optional column of UTM/UPS zone bytes.  The file consists of
+   * - a header of PointFile::headersize bytes:
+   *   - bytes 0-7: the magic string "GeoPts\\0\\0";
+   *   - bytes 8-11: the unsigned int 0x01020304, used to detect files
+   *     written with a different byte order;
+   *   - bytes 12-15: the format version (1);
+   *   - bytes 16-23: \e n as an unsigned long long;
+   *   - bytes 24-27: the number of double columns (at most
+   *     PointFile::maxcols);
+   *   - bytes 28-31: 1 if there is a zone column, otherwise 0;
+   *   - bytes 32-511: the names of the columns, each null padded to
+   *     PointFile::namesize bytes;
+   * - the double columns in order, each starting on a multiple of
+   *   PointFile::alignment bytes;
+   * - the zone column (if present), \e n bytes each holding the zone (0 for
+   *   UPS) in its low 7 bits and the hemisphere (1 for north) in its top
+   *   bit.  PointFile::nozone marks a point with no zone.
+   *
+   * All numbers are in the byte order of the machine writing the file (and
+   * files with the other byte order are rejected).  Open maps an existing
+   * file into memory read-only, so that the columns are accessed without any
+   * parsing or copying.  Create makes a new file of the right size for \e n
+   * points and maps it for writing; the columns are then filled in place (by
+   * several threads, if need be).  Close (or the destructor) unmaps the file.
+   * (On Windows the file is read into memory and written out on Close.)
+   *
+   * Errors in opening, creating, or mapping a file cause a
+   * std::runtime_error to be thrown.
+   *
+   * Example of use:
+   \verbatim
+   PointFile in, out;
+   in.Open("points.dat");
+   const double
+     *lat = in.Data("lat"),
+     *lon = in.Data("lon");
+   out.Create("utm.dat", in.Size(), "easting northing", true, &in);
+   double
+     *x = out.Data(0),
+     *y = out.Data(1);
+   unsigned char* zones = out.Zones();
+   ...
+   out.Close();
+   \endverbatim
+   **********************************************************************/
+  class PointFile {
+  public:
+    /**
+     * Constants describing the layout of the file.
+     **********************************************************************/
+    enum {
+      headersize = 512,		// The size of the header
+      maxcols = 30,		// The maximum number of double columns
+      namesize = 16,		// The space for each column name
+      alignment = 64,		// The alignment of the columns
+      nozone = 0x7f		// The zone byte for a point without a zone
+    };
+
+  private:
+    char* _data;
+    std::size_t _bytes;
+    bool _mapped, _writable;
+    // The contents of the file and its name when not mapped (on Windows)
+    std::vector<char> _buffer;
+    std::string _filename;
+    // The device and inode of a mapped file (to detect an attempt to
+    // overwrite it)
+    unsigned long long _dev, _ino;
+    std::size_t _n, _stride;
+    int _ncols;
+    bool _zones;
+    std::vector<std::string> _names;
+    static std::size_t Align(std::size_t n) throw() {
+      return (n + alignment - 1) / alignment * alignment;
+    }
+    void ReadHeader();
+    // Disallow copying
+    PointFile(const PointFile&);
+    PointFile& operator=(const PointFile&);
+  public:
+
+    /**
+     * Construct a PointFile with no file attached.
+     **********************************************************************/
+    PointFile() throw();
+
+    /**
+     * Close the file.
+     **********************************************************************/
+    ~PointFile() throw();
+
+    /**
+     * Open the point file \e filename for reading.
+     **********************************************************************/
+    void Open(const std::string& filename);
+
+    /**
+     * Create the point file \e filename to hold \e n points.  \e names is a
+     * blank separated list of the names of the double columns.  If \e zones
+     * is true, the file also contains a zone column.  The double columns are
+     * initially zero and the zone bytes are PointFile::nozone.  If \e input
+     * is given, it is the point file being read to produce this one; an
+     * error is thrown if \e filename is the same file (which would otherwise
+     * be truncated while it is still being read).
+     **********************************************************************/
+    void Create(const std::string& filename, std::size_t n,
+		const std::string& names, bool zones,
+		const PointFile* input = 0);
+
+    /**
+     * Close the file (this does nothing if no file is attached).
+     **********************************************************************/
+    void Close() throw();
+
+    /**
+     * The number of points.
+     **********************************************************************/
+    std::size_t Size() const throw() { return _n; }
+
+    /**
+     * The number of double columns.
+     **********************************************************************/
+    int Columns() const throw() { return _ncols; }
+
+    /**
+     * The name of column \e k.
+     **********************************************************************/
+    const std::string& Name(int k) const throw() { return _names[k]; }
+
+    /**
+     * The index of the column called \e name or -1 if there isn't one.
+     **********************************************************************/
+    int Find(const std::string& name) const throw();
+
+    /**
+     * The \e n doubles in column \e k.  The columns must only be modified if
+     * the file was made with Create.
+     **********************************************************************/
+    const double* Data(int k) const throw() {
+      return reinterpret_cast<const double*>(_data + headersize +
+					     k * _stride);
+    }
+    double* Data(int k) throw() {
+      return reinterpret_cast<double*>(_data + headersize + k * _stride);
+    }
+
+    /**
+     * The doubles in the column called \e name.  Throw an error if there is
+     * no such column.
+     **********************************************************************/
+    const double* Data(const std::string& name) const;
+    double* Data(const std::string& name);
+
+    /**
+     * Is there a zone column?
+     **********************************************************************/
+    bool HasZones() const throw() { return _zones; }
+
+    /**
+     * The \e n bytes in the zone column (0 if there isn't one).  As with the
+     * double columns, these must only be modified if the file was made with
+     * Create.
+     **********************************************************************/
+    const unsigned char* Zones() const throw() {
+      return _zones ? reinterpret_cast<const unsigned char*>
+	(_data + headersize + _ncols * _stride) : 0;
+    }
+    unsigned char* Zones() throw() {
+      return _zones ? reinterpret_cast<unsigned char*>
+	(_data + headersize + _ncols * _stride) : 0;
+    }
+
+    /**
+     * The zone byte for \e zone (0 means UPS) and hemisphere \e northp.  An
+     * illegal zone gives PointFile::nozone.
+     **********************************************************************/
+    static unsigned char ZoneByte(int zone, bool northp) throw() {
+      return zone >= 0 && zone <= 60 ?
+	(unsigned char)((northp ? 0x80 : 0) | zone) : (unsigned char)(nozone);
+    }
+
+    /**
+     * Decode the zone byte \e byte into a \e zone and hemisphere \e northp.
+     * Return false if the byte does not hold a legal zone.
+     **********************************************************************/
+    static bool DecodeZone(unsigned char byte, int& zone, bool& northp)
+      throw() {
+      zone = byte & 0x7f;
+      northp = (byte & 0x80) != 0;
+      return zone <= 60;
+    }
+  };
+
+} // namespace GeographicLib
+#endif
@@ -8,6 +8,7 @@
 
 #include "GeographicLib/PolarStereographic.hpp"
 #include "GeographicLib/Constants.hpp"
+#include <new>
 #include <limits>
 
 namespace {
@@ -31,9 +32,25 @@ namespace GeographicLib {
     , _numit(5)
   {}
 
-  const PolarStereographic
-  PolarStereographic::UPS(Constants::WGS84_a(), Constants::WGS84_invf(),
-			  Constants::UPS_k0());
+  namespace {
+    // Storage for UPS (zero until Init constructs it).
+    union {
+      double align;
+      char data[sizeof(PolarStereographic)];
+    } upsstore;
+  }
+
+  const PolarStereographic& PolarStereographic::UPS =
+    *reinterpret_cast<const PolarStereographic*>(upsstore.data);
+
+  int PolarStereographic::Init::_count = 0;
+
+  PolarStereographic::Init::Init() throw() {
+    if (_count++ == 0)
+      new (upsstore.data) PolarStereographic(Constants::WGS84_a(),
+					     Constants::WGS84_invf(),
+					     Constants::UPS_k0());
+  }
 
   void PolarStereographic::Forward(bool northp, double lat, double lon,
 				   double& x, double& y,
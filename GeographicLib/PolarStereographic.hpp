@@ -76,10 +76,27 @@ namespace GeographicLib {
      * A global instantiation of PolarStereographic with the WGS84 ellipsoid
      * and the UPS scale factor.  However, unlike UPS, no false easting or
      * northing is added.
+     *
+     * UPS is constructed before the static objects in any file which
+     * includes this header, so it may be used in their initialization.
      **********************************************************************/
-    const static PolarStereographic UPS;
+    const static PolarStereographic& UPS;
+
+    /// \cond SKIP
+    // Each file including this header has an Init; the first constructs UPS.
+    class Init {
+    public:
+      Init() throw();
+    private:
+      static int _count;
+    };
+    /// \endcond
   };
 
+  namespace {
+    PolarStereographic::Init PolarStereographic_init;
+  }
+
 } // namespace GeographicLib
 
 #endif
@@ -0,0 +1,139 @@
+/**
+ * \file Registry.cpp
+ * \brief Implementation for GeographicLib::Registry class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/Registry.hpp"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = REGISTRY_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  namespace {
+    // An object in the registry.  Entries are never changed once they have
+    // been linked into a bucket and are never freed.
+    struct Entry {
+      int type;
+      double a, invf, k0;
+      const void* obj;
+      Entry* next;
+    };
+
+    enum { nbuckets = 64 };
+    // The heads of the bucket lists.  Readers traverse these without a lock;
+    // a new entry is pushed onto the front of its list in a critical section.
+    Entry* volatile buckets[nbuckets];
+
+    unsigned Hash(int type, double a, double invf, double k0) throw() {
+      double x[3] = {a, invf, k0};
+      unsigned char b[sizeof(x)];
+      memcpy(b, x, sizeof(x));
+      // FNV-1a
+      unsigned h = 2166136261U ^ unsigned(type);
+      for (size_t i = 0; i < sizeof(b); ++i)
+	h = (h ^ b[i]) * 16777619U;
+      return h % nbuckets;
+    }
+
+    const Entry* Find(const Entry* e,
+		      int type, double a, double invf, double k0) throw() {
+      for (; e; e = e->next)
+	if (e->type == type && e->a == a && e->invf == invf && e->k0 == k0)
+	  return e;
+      return 0;
+    }
+  }
+
+  const void* Registry::Make(int type, double a, double invf, double k0)
+    throw() {
+    switch (type) {
+    case GEODESIC:
+      return new (nothrow) Geodesic(a, invf);
+    case GEOCENTRIC:
+      return new (nothrow) Geocentric(a, invf);
+    case TRANSVERSEMERCATOR:
+      return new (nothrow) TransverseMercator(a, invf, k0);
+    case TRANSVERSEMERCATOREXACT:
+      {
+	TransverseMercatorExact* t =
+	  new (nothrow) TransverseMercatorExact(a, invf, k0);
+	if (t) {
+	  // Evaluate the complete elliptic integrals now so that the object
+	  // isn't modified when it is shared.
+	  t->_Eu.K();
+	  t->_Ev.K();
+	}
+	return t;
+      }
+    case POLARSTEREOGRAPHIC:
+      return new (nothrow) PolarStereographic(a, invf, k0);
+    default:
+      return 0;
+    }
+  }
+
+  const void* Registry::Get(int type, double a, double invf, double k0) {
+    // A NaN never matches itself, so each request would add a new entry.
+    if (a != a || invf != invf || k0 != k0)
+      throw out_of_range("NaN parameter for Registry");
+    unsigned h = Hash(type, a, invf, k0);
+    // Pair with the flush in the writer so that an entry published by
+    // another thread is seen with its contents.
+#if defined(_OPENMP)
+#pragma omp flush
+#endif
+    const Entry* e = Find(buckets[h], type, a, invf, k0);
+    if (e)
+      return e->obj;
+#if defined(_OPENMP)
+#pragma omp critical (GeographicLib_Registry)
+#endif
+    {
+      // Check again in case another thread has just added the object.
+      e = Find(buckets[h], type, a, invf, k0);
+      if (!e) {
+	Entry* n = new (nothrow) Entry;
+	if (n && !(n->obj = Make(type, a, invf, k0))) {
+	  delete n;
+	  n = 0;
+	}
+	if (n) {
+	  n->type = type; n->a = a; n->invf = invf; n->k0 = k0;
+	  n->next = buckets[h];
+	  // Make the new entry visible to other threads before publishing it.
+#if defined(_OPENMP)
+#pragma omp flush
+#endif
+	  buckets[h] = n;
+#if defined(_OPENMP)
+#pragma omp flush
+#endif
+	  e = n;
+	}
+      }
+    }
+    if (!e)
+      throw bad_alloc();
+    return e->obj;
+  }
+
+  int Registry::Size() throw() {
+    int n = 0;
+    for (int h = 0; h < nbuckets; ++h)
+      for (const Entry* e = buckets[h]; e; e = e->next)
+	++n;
+    return n;
+  }
+
+} // namespace GeographicLib
@@ -0,0 +1,113 @@
+/**
+ * \file Registry.hpp
+ * \brief Header for GeographicLib::Registry class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(REGISTRY_HPP)
+#define REGISTRY_HPP "$Id$"
+
+#include "GeographicLib/Geodesic.hpp"
+#include "GeographicLib/Geocentric.hpp"
+#include "GeographicLib/TransverseMercator.hpp"
+#include "GeographicLib/TransverseMercatorExact.hpp"
+#include "GeographicLib/PolarStereographic.hpp"
+
+namespace GeographicLib {
+
+  /**
+   * \brief Shared instances of the ellipsoidal classes
+   *
+   * A program which handles many ellipsoids and scale factors can get the
+   * objects it needs from here instead of constructing them for each
+   * request.  The first request for a given major radius \e a, inverse
+   * flattening \e invf, central scale \e k0, and type constructs the object;
+   * later requests return a reference to the same object, which lives for
+   * the life of the program.  The objects are immutable (the elliptic
+   * integrals for TransverseMercatorExact are evaluated when it is added),
+   * so they may be used by several threads at once.
+   *
+   * The lookups take no locks; only adding a new object takes a lock (an
+   * OpenMP critical section), so the registry is thread safe if compiled
+   * with OpenMP.  Without OpenMP there is no lock and the registry must
+   * only be used by one thread at a time.  The parameters must match
+   * exactly for an object to be shared.  The Get functions throw
+   * std::out_of_range if a parameter is a NaN and std::bad_alloc if a new
+   * object can't be allocated.
+   **********************************************************************/
+  class Registry {
+  private:
+    // Construct a new object; return 0 if it can't be allocated.
+    static const void* Make(int type, double a, double invf, double k0)
+      throw();
+    static const void* Get(int type, double a, double invf, double k0);
+  public:
+    /**
+     * The types of objects held in the registry.
+     **********************************************************************/
+    enum type {
+      GEODESIC,
+      GEOCENTRIC,
+      TRANSVERSEMERCATOR,
+      TRANSVERSEMERCATOREXACT,
+      POLARSTEREOGRAPHIC
+    };
+
+    /**
+     * The Geodesic object for an ellipsoid with major radius \e a and
+     * inverse flattening \e invf.
+     **********************************************************************/
+    static const Geodesic& GetGeodesic(double a, double invf) {
+      return *static_cast<const Geodesic*>(Get(GEODESIC, a, invf, 1));
+    }
+
+    /**
+     * The Geocentric object for an ellipsoid with major radius \e a and
+     * inverse flattening \e invf.
+     **********************************************************************/
+    static const Geocentric& GetGeocentric(double a, double invf) {
+      return *static_cast<const Geocentric*>(Get(GEOCENTRIC, a, invf, 1));
+    }
+
+    /**
+     * The TransverseMercator object for an ellipsoid with major radius \e a
+     * and inverse flattening \e invf and with central scale \e k0.
+     **********************************************************************/
+    static const TransverseMercator&
+    GetTransverseMercator(double a, double invf, double k0) {
+      return *static_cast<const TransverseMercator*>
+	(Get(TRANSVERSEMERCATOR, a, invf, k0));
+    }
+
+    /**
+     * The TransverseMercatorExact object (with the standard cut) for an
+     * ellipsoid with major radius \e a and inverse flattening \e invf and
+     * with central scale \e k0.
+     **********************************************************************/
+    static const TransverseMercatorExact&
+    GetTransverseMercatorExact(double a, double invf, double k0) {
+      return *static_cast<const TransverseMercatorExact*>
+	(Get(TRANSVERSEMERCATOREXACT, a, invf, k0));
+    }
+
+    /**
+     * The PolarStereographic object for an ellipsoid with major radius \e a
+     * and inverse flattening \e invf and with central scale \e k0.
+     **********************************************************************/
+    static const PolarStereographic&
+    GetPolarStereographic(double a, double invf, double k0) {
+      return *static_cast<const PolarStereographic*>
+	(Get(POLARSTEREOGRAPHIC, a, invf, k0));
+    }
+
+    /**
+     * The number of objects in the registry.
+     **********************************************************************/
+    static int Size() throw();
+  };
+
+} // namespace GeographicLib
+
+#endif
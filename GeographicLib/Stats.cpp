@@ -0,0 +1,134 @@
+/**
+ * \file Stats.cpp
+ * \brief Implementation for GeographicLib::Stats class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/Stats.hpp"
+#include <algorithm>
+#include <new>
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = STATS_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  namespace {
+    const char* const names[Stats::NUMCOUNTERS] = {
+      "GEOD_INVERSE",
+      "GEOD_MERIDIAN",
+      "GEOD_EQUATORIAL",
+      "GEOD_SPHERE",
+      "GEOD_START_SINGULAR",
+      "GEOD_START_ANTIPODAL",
+      "GEOD_START_EQUATORIAL",
+      "GEOD_START_SHORT",
+      "GEOD_ITERATIONS",
+      "GEOD_ITERATIONS_MAX",
+      "GEOD_EXACT",
+      "GEOD_CONVERGED",
+      "GEOD_LOCAL",
+      "GEOD_LOCAL_HIT",
+      "TME_PSIINV",
+      "TME_PSIINV_EXACT",
+      "TME_PSIINV_ITERATIONS",
+      "TME_ZETAINV",
+      "TME_ZETAINV_SOUTHPOLE",
+      "TME_ZETAINV_TAYLOR",
+      "TME_ZETAINV_SPHERICAL",
+      "TME_ZETAINV_EXACT",
+      "TME_ZETAINV_ITERATIONS",
+      "TME_ZETAINV_ITERATIONS_MAX",
+      "TME_ZETAINV_CONVERGED",
+      "TME_SIGMAINV",
+      "TME_SIGMAINV_POLE",
+      "TME_SIGMAINV_TAYLOR",
+      "TME_SIGMAINV_PLANAR",
+      "TME_SIGMAINV_EXACT",
+      "TME_SIGMAINV_ITERATIONS",
+      "TME_SIGMAINV_ITERATIONS_MAX",
+      "TME_SIGMAINV_CONVERGED",
+    };
+
+    bool IsMax(Stats::counter c) throw() {
+      return c == Stats::GEOD_ITERATIONS_MAX ||
+	c == Stats::TME_ZETAINV_ITERATIONS_MAX ||
+	c == Stats::TME_SIGMAINV_ITERATIONS_MAX;
+    }
+
+    // The counters for one thread.  The blocks are linked together so that
+    // Total can find them; they are never freed.
+    struct Block {
+      Stats::count_t count[Stats::NUMCOUNTERS];
+      Block* next;
+    };
+
+    Block* head = 0;
+    // The block for this thread.  This is only per-thread with OpenMP;
+    // otherwise it is an ordinary global shared by all threads.
+    Block* local = 0;
+    // Where to count if a block can't be allocated
+    Stats::count_t scratch[Stats::NUMCOUNTERS];
+#if defined(_OPENMP)
+#pragma omp threadprivate(local)
+#endif
+  }
+
+  const char* Stats::Name(counter c) throw() {
+    return c >= 0 && c < NUMCOUNTERS ? names[c] : "";
+  }
+
+  Stats::count_t* Stats::Local() throw() {
+    if (!local) {
+      Block* b = new (nothrow) Block;
+      if (!b)
+	return scratch;
+      fill(b->count, b->count + NUMCOUNTERS, count_t(0));
+#if defined(_OPENMP)
+#pragma omp critical (GeographicLib_Stats)
+#endif
+      {
+	b->next = head;
+	head = b;
+      }
+      local = b;
+    }
+    return local->count;
+  }
+
+  Stats::count_t Stats::Count(counter c) throw() {
+    return local && c >= 0 && c < NUMCOUNTERS ? local->count[c] : 0;
+  }
+
+  Stats::count_t Stats::Total(counter c) throw() {
+    if (!(c >= 0 && c < NUMCOUNTERS))
+      return 0;
+    count_t t = 0;
+#if defined(_OPENMP)
+#pragma omp critical (GeographicLib_Stats)
+#endif
+    for (Block* b = head; b; b = b->next)
+      t = IsMax(c) ? max(t, b->count[c]) : t + b->count[c];
+    return t;
+  }
+
+  void Stats::Reset() throw() {
+    if (local)
+      fill(local->count, local->count + NUMCOUNTERS, count_t(0));
+  }
+
+  void Stats::ResetAll() throw() {
+#if defined(_OPENMP)
+#pragma omp critical (GeographicLib_Stats)
+#endif
+    for (Block* b = head; b; b = b->next)
+      fill(b->count, b->count + NUMCOUNTERS, count_t(0));
+  }
+
+} // namespace GeographicLib
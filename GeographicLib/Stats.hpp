@@ -0,0 +1,147 @@
+/**
+ * \file Stats.hpp
+ * \brief Header for GeographicLib::Stats class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(STATS_HPP)
+#define STATS_HPP "$Id$"
+
+#if !defined(GEOGRAPHICLIB_STATS)
+/**
+ * Whether the iterative algorithms in %GeographicLib count their
+ * iterations and the branches they take (see GeographicLib::Stats).
+ * GEOGRAPHICLIB_STATS can be set to 0 (the default; no counting) or 1.
+ **********************************************************************/
+#define GEOGRAPHICLIB_STATS 0
+#endif
+
+namespace GeographicLib {
+
+  /**
+   * \brief Instrumentation counters
+   *
+   * If the library is compiled with GEOGRAPHICLIB_STATS = 1,
+   * Geodesic::Inverse and the inverse functions in TransverseMercatorExact
+   * count the calls, the starting guesses chosen, the special cases, the
+   * Newton iterations, and the early exits.  If the library is compiled
+   * with OpenMP, each thread has its own set of counters (held in an OpenMP
+   * threadprivate pointer), so the counting needs no locks.  Count returns
+   * the counts for the calling thread and Total sums them over all the
+   * threads which have counted anything.  Without OpenMP there is a single
+   * set of counters shared by all threads (which must then not count
+   * concurrently) and Count and Total are the same.  For the counters whose
+   * names end in _MAX, the largest value is recorded instead of the sum;
+   * this includes the calls which fail to converge.
+   *
+   * Otherwise (the default) the counting statements compile to nothing,
+   * Enabled returns false, and Count and Total return 0.  The setting must
+   * be the same for the library and the code which includes this header.
+   **********************************************************************/
+  class Stats {
+  public:
+    /**
+     * The counters.  The mean number of iterations per call is given by,
+     * e.g., GEOD_ITERATIONS / (GEOD_INVERSE - GEOD_MERIDIAN -
+     * GEOD_EQUATORIAL - GEOD_SPHERE) and the number of calls which failed
+     * to converge is, e.g., TME_ZETAINV - TME_ZETAINV_EXACT -
+     * TME_ZETAINV_CONVERGED.
+     **********************************************************************/
+    enum counter {
+      GEOD_INVERSE,		///< Calls to Geodesic::Inverse
+      GEOD_MERIDIAN,		///< Geodesic is a meridian
+      GEOD_EQUATORIAL,		///< Geodesic runs along the equator
+      GEOD_SPHERE,		///< Solved directly on a sphere
+      GEOD_START_SINGULAR,	///< Start at the singular antipodal point
+      GEOD_START_ANTIPODAL,	///< Start with the nearly antipodal guess
+      GEOD_START_EQUATORIAL,	///< Start heading nearly along equator
+      GEOD_START_SHORT,		///< Start with the short distance guess
+      GEOD_ITERATIONS,		///< Newton iterations
+      GEOD_ITERATIONS_MAX,	///< Maximum Newton iterations in one call
+      GEOD_EXACT,		///< Newton stopped with zero residual
+      GEOD_CONVERGED,		///< Newton converged
+      GEOD_LOCAL,		///< Calls to Inverse with a tolerance
+      GEOD_LOCAL_HIT,		///< Local approximation was good enough
+      TME_PSIINV,		///< Calls to inverse of isometric latitude
+      TME_PSIINV_EXACT,		///< Starting guess is exact; no Newton
+      TME_PSIINV_ITERATIONS,	///< Newton iterations for these
+      TME_ZETAINV,		///< Calls to zetainv (Forward)
+      TME_ZETAINV_SOUTHPOLE,	///< Start near the south pole
+      TME_ZETAINV_TAYLOR,	///< Start with Taylor series about branch point
+      TME_ZETAINV_SPHERICAL,	///< Start with spherical TM
+      TME_ZETAINV_EXACT,	///< Starting guess is accurate; no Newton
+      TME_ZETAINV_ITERATIONS,	///< Newton iterations
+      TME_ZETAINV_ITERATIONS_MAX, ///< Maximum Newton iterations in one call
+      TME_ZETAINV_CONVERGED,	///< Newton converged
+      TME_SIGMAINV,		///< Calls to sigmainv (Reverse)
+      TME_SIGMAINV_POLE,	///< Start near the pole of sigma
+      TME_SIGMAINV_TAYLOR,	///< Start with Taylor series about branch point
+      TME_SIGMAINV_PLANAR,	///< Start with the scaled identity map
+      TME_SIGMAINV_EXACT,	///< Starting guess is accurate; no Newton
+      TME_SIGMAINV_ITERATIONS,	///< Newton iterations
+      TME_SIGMAINV_ITERATIONS_MAX, ///< Maximum Newton iterations in one call
+      TME_SIGMAINV_CONVERGED,	///< Newton converged
+      NUMCOUNTERS		///< The number of counters
+    };
+    /**
+     * The type of the counts.
+     **********************************************************************/
+#if defined(_MSC_VER)
+    typedef unsigned __int64 count_t;
+#else
+    typedef unsigned long long count_t;
+#endif
+    /**
+     * Has the library been compiled with counting enabled?
+     **********************************************************************/
+    static bool Enabled() throw() { return GEOGRAPHICLIB_STATS != 0; }
+    /**
+     * The name of counter \e c, e.g., "GEOD_INVERSE".
+     **********************************************************************/
+    static const char* Name(counter c) throw();
+    /**
+     * The value of counter \e c for the calling thread.
+     **********************************************************************/
+    static count_t Count(counter c) throw();
+    /**
+     * The value of counter \e c summed (or, for the _MAX counters, maximized)
+     * over all threads.  The result is only exact if no other threads are
+     * counting at the time.
+     **********************************************************************/
+    static count_t Total(counter c) throw();
+    /**
+     * Zero the counters for the calling thread.
+     **********************************************************************/
+    static void Reset() throw();
+    /**
+     * Zero the counters for all the threads.  Call this only when no other
+     * threads are counting.
+     **********************************************************************/
+    static void ResetAll() throw();
+    /**
+     * The counters for the calling thread (used by the counting macros).
+     **********************************************************************/
+    static count_t* Local() throw();
+  };
+
+} // namespace GeographicLib
+
+#if GEOGRAPHICLIB_STATS
+#define GEOGRAPHICLIB_COUNT(c) \
+  (++GeographicLib::Stats::Local()[c])
+#define GEOGRAPHICLIB_COUNTN(c, n) \
+  (GeographicLib::Stats::Local()[c] += (n))
+#define GEOGRAPHICLIB_MAX(c, n) do { \
+    GeographicLib::Stats::count_t* _s = GeographicLib::Stats::Local(); \
+    GeographicLib::Stats::count_t _n = (n); \
+    if (_n > _s[c]) _s[c] = _n; \
+  } while (false)
+#else
+#define GEOGRAPHICLIB_COUNT(c) ((void)0)
+#define GEOGRAPHICLIB_COUNTN(c, n) ((void)0)
+#define GEOGRAPHICLIB_MAX(c, n) ((void)0)
+#endif
+
+#endif
@@ -40,6 +40,7 @@
 
 #include "GeographicLib/TransverseMercator.hpp"
 #include "GeographicLib/Constants.hpp"
+#include <new>
 #include <limits>
 
 namespace {
@@ -51,9 +52,6 @@ namespace GeographicLib {
 
   using namespace std;
 
-  const double TransverseMercator::tol =
-    0.1*sqrt(numeric_limits<double>::epsilon());
-
   TransverseMercator::TransverseMercator(double a, double invf, double k0)
     throw()
     : _a(a)
@@ -170,9 +168,96 @@ namespace GeographicLib {
     _a1 = _b1 * _a;
   }
 
-  const TransverseMercator
-  TransverseMercator::UTM(Constants::WGS84_a(), Constants::WGS84_invf(),
-			  Constants::UTM_k0());
+  namespace {
+    // Storage for UTM (zero until Init constructs it).
+    union {
+      double align;
+      char data[sizeof(TransverseMercator)];
+    } utmstore;
+  }
+
+  const TransverseMercator& TransverseMercator::UTM =
+    *reinterpret_cast<const TransverseMercator*>(utmstore.data);
+
+  int TransverseMercator::Init::_count = 0;
+
+  TransverseMercator::Init::Init() throw() {
+    if (_count++ == 0)
+      new (utmstore.data) TransverseMercator(Constants::WGS84_a(),
+					     Constants::WGS84_invf(),
+					     Constants::UTM_k0());
+  }
+
+  void TransverseMercator::ForwardSeries(double xip, double etap,
+					 double& xi, double& eta,
+					 double& gamma, double& k) const throw() {
+    // Sum the series for zeta in terms of zeta' as described in Forward.
+    double
+      c0 = cos(2 * xip), ch0 = cosh(2 * etap),
+      s0 = sin(2 * xip), sh0 = sinh(2 * etap),
+      ar = 2 * c0 * ch0, ai = -2 * s0 * sh0; // 2 * cos(2*zeta')
+    double			// Accumulators for zeta
+      xi0 = _hp[maxpow - 1], eta0 = 0,
+      xi1 = 0, eta1 = 0,
+      xi2, eta2;
+    double			// Accumulators for dzeta/dzeta'
+      yr0 = 2 * maxpow * _hp[maxpow - 1], yi0 = 0,
+      yr1 = 0, yi1 = 0,
+      yr2, yi2;
+    for (int j = maxpow; --j;) { // j = maxpow-1 .. 1
+      xi2 = xi1; eta2 = eta1; yr2 = yr1; yi2 = yi1;
+      xi1 = xi0; eta1 = eta0; yr1 = yr0; yi1 = yi0;
+      xi0  = ar * xi1 - ai * eta1 - xi2 + _hp[j - 1];
+      eta0 = ai * xi1 + ar * eta1 - eta2;
+      yr0 = ar * yr1 - ai * yi1 - yr2 + 2 * j * _hp[j - 1];
+      yi0 = ai * yr1 + ar * yi1 - yi2;
+    }
+    ar /= 2; ai /= 2;		// cos(2*zeta')
+    yr2 = 1 - yr1 + ar * yr0 - ai * yi0;
+    yi2 =   - yi1 + ai * yr0 + ar * yi0;
+    ar = s0 * ch0; ai = c0 * sh0; // sin(2*zeta')
+    xi  = xip  + ar * xi0 - ai * eta0;
+    eta = etap + ai * xi0 + ar * eta0;
+    // Fold in change in convergence and scale for Gauss-Schreiber TM to
+    // Gauss-Krueger TM.
+    gamma -= atan2(yi2, yr2);
+    k *= _b1 * hypot(yr2, yi2);
+  }
+
+  void TransverseMercator::ReverseSeries(double xi, double eta,
+					 double& xip, double& etap,
+					 double& gamma, double& k) const throw() {
+    // Sum the reverted series for zeta' in terms of zeta.
+    double
+      c0 = cos(2 * xi), ch0 = cosh(2 * eta),
+      s0 = sin(2 * xi), sh0 = sinh(2 * eta),
+      ar = 2 * c0 * ch0, ai = -2 * s0 * sh0; // 2 * cos(2*zeta)
+    double			// Accumulators for zeta'
+      xip0 = -_h[maxpow - 1], etap0 = 0,
+      xip1 = 0, etap1 = 0,
+      xip2, etap2;
+    double			// Accumulators for dzeta'/dzeta
+      yr0 = - 2 * maxpow * _h[maxpow - 1], yi0 = 0,
+      yr1 = 0, yi1 = 0,
+      yr2, yi2;
+    for (int j = maxpow; --j;) { // j = maxpow-1 .. 1
+      xip2 = xip1; etap2 = etap1; yr2 = yr1; yi2 = yi1;
+      xip1 = xip0; etap1 = etap0; yr1 = yr0; yi1 = yi0;
+      xip0  = ar * xip1 - ai * etap1 - xip2 - _h[j - 1];
+      etap0 = ai * xip1 + ar * etap1 - etap2;
+      yr0 = ar * yr1 - ai * yi1 - yr2 - 2 * j * _h[j - 1];
+      yi0 = ai * yr1 + ar * yi1 - yi2;
+    }
+    ar /= 2; ai /= 2;		// cos(2*zeta')
+    yr2 = 1 - yr1 + ar * yr0 - ai * yi0;
+    yi2 =   - yi1 + ai * yr0 + ar * yi0;
+    ar = s0 * ch0; ai = c0 * sh0; // sin(2*zeta)
+    xip  = xi  + ar * xip0 - ai * etap0;
+    etap = eta + ai * xip0 + ar * etap0;
+    // Convergence and scale for Gauss-Schreiber TM to Gauss-Krueger TM.
+    gamma = atan2(yi2, yr2);
+    k = _b1 / hypot(yr2, yi2);
+  }
 
   void TransverseMercator::Forward(double lon0, double lat, double lon,
 				   double& x, double& y,
@@ -295,37 +380,13 @@ namespace GeographicLib {
     //    [ cos(A+B) - 2*cos(B)*cos(A) + cos(A-B) = 0, A = n*x, B = x ]
     //    c[0] = 1; c[k] = 2*k*_hp[k-1]
     //    S = (c[0] - y[2]) + y[1] * cos(x)
-    double
-      c0 = cos(2 * xip), ch0 = cosh(2 * etap),
-      s0 = sin(2 * xip), sh0 = sinh(2 * etap),
-      ar = 2 * c0 * ch0, ai = -2 * s0 * sh0; // 2 * cos(2*zeta')
-    double			// Accumulators for zeta
-      xi0 = _hp[maxpow - 1], eta0 = 0,
-      xi1 = 0, eta1 = 0,
-      xi2, eta2;
-    double			// Accumulators for dzeta/dzeta'
-      yr0 = 2 * maxpow * _hp[maxpow - 1], yi0 = 0,
-      yr1 = 0, yi1 = 0,
-      yr2, yi2;
-    for (int j = maxpow; --j;) { // j = maxpow-1 .. 1
-      xi2 = xi1; eta2 = eta1; yr2 = yr1; yi2 = yi1;
-      xi1 = xi0; eta1 = eta0; yr1 = yr0; yi1 = yi0;
-      xi0  = ar * xi1 - ai * eta1 - xi2 + _hp[j - 1];
-      eta0 = ai * xi1 + ar * eta1 - eta2;
-      yr0 = ar * yr1 - ai * yi1 - yr2 + 2 * j * _hp[j - 1];
-      yi0 = ai * yr1 + ar * yi1 - yi2;
-    }
-    ar /= 2; ai /= 2;		// cos(2*zeta')
-    yr2 = 1 - yr1 + ar * yr0 - ai * yi0;
-    yi2 =   - yi1 + ai * yr0 + ar * yi0;
-    ar = s0 * ch0; ai = c0 * sh0; // sin(2*zeta')
-    double
-      xi  = xip  + ar * xi0 - ai * eta0,
-      eta = etap + ai * xi0 + ar * eta0;
-    // Fold in change in convergence and scale for Gauss-Schreiber TM to
-    // Gauss-Krueger TM.
-    gamma -= atan2(yi2, yr2);
-    k *= _b1 * hypot(yr2, yi2);
+    double xi, eta;
+    if (_n == 0) {
+      // On a sphere the series vanish
+      xi = xip;
+      eta = etap;
+    } else
+      ForwardSeries(xip, etap, xi, eta, gamma, k);
     gamma /= Constants::degree();
     y = _a1 * _k0 * (backside ? Constants::pi() - xi : xi) * latsign;
     x = _a1 * _k0 * eta * lonsign;
@@ -335,6 +396,29 @@ namespace GeographicLib {
     k *= _k0;
   }
 
+  void TransverseMercator::ForwardJacobian(double lon0, double lat, double lon,
+					   double& x, double& y,
+					   double& gamma, double& k,
+					   double jac[]) const throw() {
+    Forward(lon0, lat, lon, x, y, gamma, k);
+    // The projection is conformal, so a small displacement on the ellipsoid
+    // is scaled by k and rotated by gamma.  Convert unit changes (degrees) in
+    // lat and lon to northward and eastward displacements using the
+    // meridional and transverse radii of curvature.
+    double
+      phi = lat * Constants::degree(),
+      w2 = 1 - _e2 * sq(sin(phi)),
+      north = _a * _e2m / (w2 * sqrt(w2)) * Constants::degree(),
+      east = (abs(lat) == 90 ? 0 : _a * cos(phi) / sqrt(w2)) *
+      Constants::degree(),
+      g = gamma * Constants::degree(),
+      sg = k * sin(g), cg = k * cos(g);
+    jac[0] = -north * sg;       // dx/dlat
+    jac[1] =  east  * cg;       // dx/dlon
+    jac[2] =  north * cg;       // dy/dlat
+    jac[3] =  east  * sg;       // dy/dlon
+  }
+
   void TransverseMercator::Reverse(double lon0, double x, double y,
 				   double& lat, double& lon,
 				   double& gamma, double& k) const throw() {
@@ -353,36 +437,15 @@ namespace GeographicLib {
     bool backside = xi > Constants::pi()/2;
     if (backside)
       xi = Constants::pi() - xi;
-    double
-      c0 = cos(2 * xi), ch0 = cosh(2 * eta),
-      s0 = sin(2 * xi), sh0 = sinh(2 * eta),
-      ar = 2 * c0 * ch0, ai = -2 * s0 * sh0; // 2 * cos(2*zeta)
-    double			// Accumulators for zeta'
-      xip0 = -_h[maxpow - 1], etap0 = 0,
-      xip1 = 0, etap1 = 0,
-      xip2, etap2;
-    double			// Accumulators for dzeta'/dzeta
-      yr0 = - 2 * maxpow * _h[maxpow - 1], yi0 = 0,
-      yr1 = 0, yi1 = 0,
-      yr2, yi2;
-    for (int j = maxpow; --j;) { // j = maxpow-1 .. 1
-      xip2 = xip1; etap2 = etap1; yr2 = yr1; yi2 = yi1;
-      xip1 = xip0; etap1 = etap0; yr1 = yr0; yi1 = yi0;
-      xip0  = ar * xip1 - ai * etap1 - xip2 - _h[j - 1];
-      etap0 = ai * xip1 + ar * etap1 - etap2;
-      yr0 = ar * yr1 - ai * yi1 - yr2 - 2 * j * _h[j - 1];
-      yi0 = ai * yr1 + ar * yi1 - yi2;
-    }
-    ar /= 2; ai /= 2;		// cos(2*zeta')
-    yr2 = 1 - yr1 + ar * yr0 - ai * yi0;
-    yi2 =   - yi1 + ai * yr0 + ar * yi0;
-    ar = s0 * ch0; ai = c0 * sh0; // sin(2*zeta)
-    double
-      xip  = xi  + ar * xip0 - ai * etap0,
-      etap = eta + ai * xip0 + ar * etap0;
-    // Convergence and scale for Gauss-Schreiber TM to Gauss-Krueger TM.
-    gamma = atan2(yi2, yr2);
-    k = _b1 / hypot(yr2, yi2);
+    double xip, etap;
+    if (_n == 0) {
+      // On a sphere the series vanish
+      xip = xi;
+      etap = eta;
+      gamma = 0;
+      k = _b1;
+    } else
+      ReverseSeries(xi, eta, xip, etap, gamma, k);
     // JHS 154 has
     //
     // 	 beta = asin(sin(xip) / cosh(etap))
@@ -403,13 +466,14 @@ namespace GeographicLib {
       double
 	q = asinh(sin(xip)/r),
 	qp = q;
-      // min iterations = 1, max iterations = 3; mean = 2.8
-      for (int i = 0; i < numit; ++i) {
+      // min iterations = 1, max iterations = 3; mean = 2.8; none on a
+      // sphere
+      for (int i = 0; _e2 != 0 && i < numit; ++i) {
 	double
 	  t = tanh(qp),
 	  dqp = -(qp - _e * atanh(_e * t) - q) * (1 - _e2 * sq(t)) / _e2m;
 	qp += dqp;
-	if (abs(dqp) < tol)
+	if (abs(dqp) < tol())
 	  break;
       }
       phi = atan(sinh(qp));
@@ -10,6 +10,7 @@
 #define TRANSVERSEMERCATOR_HPP "$Id: TransverseMercator.hpp 6556 2009-02-26 15:44:49Z ckarney $"
 
 #include <cmath>
+#include <limits>
 
 #if !defined(TM_TX_MAXPOW)
 /**
@@ -51,7 +52,8 @@ namespace GeographicLib {
   private:
     static const int maxpow =
       TM_TX_MAXPOW > 8 ? 8 : (TM_TX_MAXPOW < 4 ? 4 : TM_TX_MAXPOW);
-    static const double tol;
+    static inline double tol() throw()
+    { return 0.1 * std::sqrt(std::numeric_limits<double>::epsilon()); }
     static const int numit = 5;
     const double _a, _f, _k0, _e2, _e, _e2m,  _n;
     double _a1, _b1, _h[maxpow], _hp[maxpow];
@@ -81,6 +83,12 @@ namespace GeographicLib {
     static inline double asinh(double x) throw() { return ::asinh(x); }
     static inline double atanh(double x) throw() { return ::atanh(x); }
 #endif
+    // The Krueger series for zeta in terms of zeta' (and the reverse), also
+    // applying the change in convergence gamma (radians) and scale k.
+    void ForwardSeries(double xip, double etap, double& xi, double& eta,
+		       double& gamma, double& k) const throw();
+    void ReverseSeries(double xi, double eta, double& xip, double& etap,
+		       double& gamma, double& k) const throw();
   public:
 
     /**
@@ -102,6 +110,18 @@ namespace GeographicLib {
 		 double& x, double& y,
 		 double& gamma, double& k) const throw();
 
+    /**
+     * The same as Forward(\e lon0, \e lat, \e lon, \e x, \e y, \e gamma,
+     * \e k) but also returns the Jacobian of the projection in \e jac[0..3]
+     * = [\e dx/\e dlat, \e dx/\e dlon, \e dy/\e dlat, \e dy/\e dlon]
+     * (meters per degree).  This is found from \e gamma and \e k (the
+     * projection is conformal) and costs little more than Forward, instead of
+     * the 4 extra calls needed to estimate it by central differences.
+     **********************************************************************/
+    void ForwardJacobian(double lon0, double lat, double lon,
+			 double& x, double& y, double& gamma, double& k,
+			 double jac[]) const throw();
+
     /**
      * Convert from transverse Mercator easting \e x (meters) and northing \e y
      * (meters) to latitude \e lat (degrees) and longitude \e lon (degrees) .
@@ -118,10 +138,27 @@ namespace GeographicLib {
      * A global instantiation of TransverseMercator with the WGS84 ellipsoid
      * and the UTM scale factor.  However, unlike UTM, no false easting or
      * northing is added.
+     *
+     * UTM is constructed before the static objects in any file which
+     * includes this header, so it may be used in their initialization.
      **********************************************************************/
-    const static TransverseMercator UTM;
+    const static TransverseMercator& UTM;
+
+    /// \cond SKIP
+    // Each file including this header has an Init; the first constructs UTM.
+    class Init {
+    public:
+      Init() throw();
+    private:
+      static int _count;
+    };
+    /// \endcond
   };
 
+  namespace {
+    TransverseMercator::Init TransverseMercator_init;
+  }
+
 } // namespace GeographicLib
 
 #endif
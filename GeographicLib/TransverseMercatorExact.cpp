@@ -38,7 +38,9 @@
  **********************************************************************/
 
 #include "GeographicLib/TransverseMercatorExact.hpp"
+#include "GeographicLib/Stats.hpp"
 #include "GeographicLib/Constants.hpp"
+#include <new>
 #include <limits>
 #include <algorithm>
 
@@ -51,15 +53,6 @@ namespace GeographicLib {
 
   using namespace std;
 
-  const double TransverseMercatorExact::tol = numeric_limits<double>::epsilon();
-  const double TransverseMercatorExact::tol1 = 0.1 * sqrt(tol);
-  const double TransverseMercatorExact::tol2 = 0.1 * tol;
-  const double TransverseMercatorExact::taytol = pow(tol, 0.6);
-      // Overflow value for asinh(tan(pi/2)) etc.
-  const double TransverseMercatorExact::ahypover =
-    (double)(numeric_limits<double>::digits)
-    /log((double)(numeric_limits<double>::radix)) + 2;
-
   TransverseMercatorExact::TransverseMercatorExact(double a, double invf,
 						   double k0, bool extendp)
     throw()
@@ -75,16 +68,32 @@ namespace GeographicLib {
     , _Ev(_mv)
   {}
 
-  const TransverseMercatorExact
-  TransverseMercatorExact::UTM(Constants::WGS84_a(), Constants::WGS84_invf(),
-			       Constants::UTM_k0());
+  namespace {
+    // Storage for UTM (zero until Init constructs it).
+    union {
+      double align;
+      char data[sizeof(TransverseMercatorExact)];
+    } utmstore;
+  }
+
+  const TransverseMercatorExact& TransverseMercatorExact::UTM =
+    *reinterpret_cast<const TransverseMercatorExact*>(utmstore.data);
+
+  int TransverseMercatorExact::Init::_count = 0;
+
+  TransverseMercatorExact::Init::Init() throw() {
+    if (_count++ == 0)
+      new (utmstore.data) TransverseMercatorExact(Constants::WGS84_a(),
+						  Constants::WGS84_invf(),
+						  Constants::UTM_k0());
+  }
 
   double  TransverseMercatorExact::psi(double phi) const throw() {
     double s = sin(phi);
     // Lee 9.4.  Rewrite atanh(sin(phi)) = asinh(tan(phi)) which is more
     // accurate.  Write tan(phi) this way to ensure that sign(tan(phi)) =
     // sign(phi)
-    return asinh(s / max(cos(phi), 0.1 * tol)) - _e * atanh(_e * s);
+    return asinh(s / max(cos(phi), 0.1 * tol())) - _e * atanh(_e * s);
   }
 
   double TransverseMercatorExact::psiinv(double psi) const throw() {
@@ -95,13 +104,20 @@ namespace GeographicLib {
     // and then substitute phi = atan(sinh(q)).  Note that
     // dpsi/dq = (1 - e^2)/(1 - e^2 * tanh(q)^2)
     double q = psi;		// Initial guess
+    GEOGRAPHICLIB_COUNT(Stats::TME_PSIINV);
+    if (psi == 0 || _e == 0) {
+      // The initial guess is exact on the equator (and on a sphere)
+      GEOGRAPHICLIB_COUNT(Stats::TME_PSIINV_EXACT);
+      return atan(sinh(q));
+    }
     for (int i = 0; i < numit; ++i) {
       // min iterations = 1, max iterations = 3; mean = 2.8
+      GEOGRAPHICLIB_COUNT(Stats::TME_PSIINV_ITERATIONS);
       double
 	t = tanh(q),
 	dq = -(q - _e * atanh(_e * t) - psi) * (1 - _mu * sq(t)) / _mv;
       q += dq;
-      if (abs(dq) < tol1)
+      if (abs(dq) < tol1())
 	break;
     }
     return atan(sinh(q));
@@ -120,8 +136,8 @@ namespace GeographicLib {
       d2 = sqrt(_mu * sq(cnu) + _mv * sq(cnv));
     psi =
       // Overflow to values s.t. tanh = 1.
-      (d1 ? asinh(snu * dnv / d1) : snu < 0 ? -ahypover : ahypover)
-      - (d2 ? _e * asinh(_e * snu / d2) : snu < 0 ? -ahypover : ahypover);
+      (d1 ? asinh(snu * dnv / d1) : snu < 0 ? -ahypover() : ahypover())
+      - (d2 ? _e * asinh(_e * snu / d2) : snu < 0 ? -ahypover() : ahypover());
     lam = (d1 != 0 && d2 != 0) ?
       atan2(dnu * snv, cnu * cnv) - _e * atan2(_e * cnu * snv, dnu * cnv) :
       0;
@@ -162,6 +178,7 @@ namespace GeographicLib {
       v = atan2(cos(lamx), sinh(psix)) * (1 + _mu/2);
       u = _Eu.K() - u;
       v = _Ev.K() - v;
+      GEOGRAPHICLIB_COUNT(Stats::TME_ZETAINV_SOUTHPOLE);
     } else if (psi < _e * Constants::pi()/2 &&
 	       lam > (1 - 2 * _e) * Constants::pi()/2) {
       // At w = w0 = i * Ev.K(), we have
@@ -185,11 +202,12 @@ namespace GeographicLib {
 	// to [-90, 0] in w space as required.
 	ang = atan2(dlam-psi, psi+dlam) - 0.75 * Constants::pi();
       // Error using this guess is about 0.21 * (rad/e)^(5/3)
-      retval = rad < _e * taytol;
+      retval = rad < _e * taytol();
       rad = pow(3 / (_mv * _e) * rad, 1/3.0);
       ang /= 3;
       u = rad * cos(ang);
       v = rad * sin(ang) + _Ev.K();
+      GEOGRAPHICLIB_COUNT(Stats::TME_ZETAINV_TAYLOR);
     } else {
       // Use spherical TM, Lee 12.6 -- writing atanh(sin(lam) / cosh(psi)) =
       // asinh(sin(lam) / hypot(cos(lam), sinh(psi))).  This takes care of the
@@ -199,6 +217,7 @@ namespace GeographicLib {
       // But scale to put 90,0 on the right place
       u *= _Eu.K() / (Constants::pi()/2);
       v *= _Eu.K() / (Constants::pi()/2);
+      GEOGRAPHICLIB_COUNT(Stats::TME_ZETAINV_SPHERICAL);
     }
     return retval;
   }
@@ -206,11 +225,16 @@ namespace GeographicLib {
   // Invert zeta using Newton's method
   void  TransverseMercatorExact::zetainv(double psi, double lam,
 					 double& u, double& v) const throw() {
-    if (zetainv0(psi, lam, u, v))
+    GEOGRAPHICLIB_COUNT(Stats::TME_ZETAINV);
+    if (zetainv0(psi, lam, u, v)) {
+      GEOGRAPHICLIB_COUNT(Stats::TME_ZETAINV_EXACT);
       return;
-    double stol2 = tol2 / sq(max(psi, 1.0));
+    }
+    double stol2 = tol2() / sq(max(psi, 1.0));
     // min iterations = 2, max iterations = 6; mean = 4.0
     for (int i = 0, trip = 0; i < numit; ++i) {
+      GEOGRAPHICLIB_COUNT(Stats::TME_ZETAINV_ITERATIONS);
+      GEOGRAPHICLIB_MAX(Stats::TME_ZETAINV_ITERATIONS_MAX, i + 1);
       double snu, cnu, dnu, snv, cnv, dnv;
       _Eu.sncndn(u, snu, cnu, dnu);
       _Ev.sncndn(v, snv, cnv, dnv);
@@ -224,8 +248,10 @@ namespace GeographicLib {
 	delv = psi1 * dv1 + lam1 * du1;
       u -= delu;
       v -= delv;
-      if (trip)
+      if (trip) {
+	GEOGRAPHICLIB_COUNT(Stats::TME_ZETAINV_CONVERGED);
 	break;
+      }
       double delw2 = sq(delu) + sq(delv);
       if (delw2 < stol2)
 	++trip;
@@ -275,6 +301,7 @@ namespace GeographicLib {
 	r2 = sq(x) + sq(y);
       u = _Eu.K() + x/r2;
       v = _Ev.K() - y/r2;
+      GEOGRAPHICLIB_COUNT(Stats::TME_SIGMAINV_POLE);
     } else if ((eta > 0.75 * _Ev.KE() && xi < 0.25 * _Eu.E())
 	       || eta > _Ev.KE()) {
       // At w = w0 = i * Ev.K(), we have
@@ -296,15 +323,17 @@ namespace GeographicLib {
 	// discussion in zetainv0 on the cut for ang.
 	ang = atan2(deta-xi, xi+deta) - 0.75 * Constants::pi();
       // Error using this guess is about 0.068 * rad^(5/3)
-      retval = rad < 2 * taytol;
+      retval = rad < 2 * taytol();
       rad = pow(3 / _mv * rad, 1/3.0);
       ang /= 3;
       u = rad * cos(ang);
       v = rad * sin(ang) + _Ev.K();
+      GEOGRAPHICLIB_COUNT(Stats::TME_SIGMAINV_TAYLOR);
     } else {
       // Else use w = sigma * Eu.K/Eu.E (which is correct in the limit _e -> 0)
       u = xi * _Eu.K()/_Eu.E();
       v = eta * _Eu.K()/_Eu.E();
+      GEOGRAPHICLIB_COUNT(Stats::TME_SIGMAINV_PLANAR);
     }
     return retval;
   }
@@ -312,10 +341,15 @@ namespace GeographicLib {
   // Invert sigma using Newton's method
   void  TransverseMercatorExact::sigmainv(double xi, double eta,
 					  double& u, double& v) const throw() {
-    if (sigmainv0(xi, eta, u, v))
+    GEOGRAPHICLIB_COUNT(Stats::TME_SIGMAINV);
+    if (sigmainv0(xi, eta, u, v)) {
+      GEOGRAPHICLIB_COUNT(Stats::TME_SIGMAINV_EXACT);
       return;
+    }
     // min iterations = 2, max iterations = 7; mean = 3.9
     for (int i = 0, trip = 0; i < numit; ++i) {
+      GEOGRAPHICLIB_COUNT(Stats::TME_SIGMAINV_ITERATIONS);
+      GEOGRAPHICLIB_MAX(Stats::TME_SIGMAINV_ITERATIONS_MAX, i + 1);
       double snu, cnu, dnu, snv, cnv, dnv;
       _Eu.sncndn(u, snu, cnu, dnu);
       _Ev.sncndn(v, snv, cnv, dnv);
@@ -329,10 +363,12 @@ namespace GeographicLib {
 	delv = xi1 * dv1 + eta1 * du1;
       u -= delu;
       v -= delv;
-      if (trip)
+      if (trip) {
+	GEOGRAPHICLIB_COUNT(Stats::TME_SIGMAINV_CONVERGED);
 	break;
+      }
       double delw2 = sq(delu) + sq(delv);
-      if (delw2 < tol2)
+      if (delw2 < tol2())
 	++trip;
     }
   }
@@ -348,7 +384,7 @@ namespace GeographicLib {
       s2 = sq(s),
       d = 1 - s2 * c2;
     // See comment after else clause for a discussion.
-    if ( !( phi > 0 && d > 0.75 && c2 * sq(c2 * _ep2) * s2 < tol ) ) {
+    if ( !( phi > 0 && d > 0.75 && c2 * sq(c2 * _ep2) * s2 < tol() ) ) {
       // Lee 55.12 -- negated for our sign convention.  gamma gives the bearing
       // (clockwise from true north) of grid north
       gamma = atan2(_mv * snu * snv * cnv, cnu * dnu * dnv);
@@ -11,6 +11,7 @@
 #define TRANSVERSEMERCATOREXACT_HPP "$Id: TransverseMercatorExact.hpp 6559 2009-02-28 16:49:53Z ckarney $"
 
 #include <cmath>
+#include <limits>
 #include "GeographicLib/EllipticFunction.hpp"
 
 namespace GeographicLib {
@@ -53,7 +54,17 @@ namespace GeographicLib {
 
   class TransverseMercatorExact {
   private:
-    static const double tol, tol1, tol2, taytol, ahypover;
+    friend class Registry;
+    static inline double tol() throw()
+    { return std::numeric_limits<double>::epsilon(); }
+    static inline double tol1() throw() { return 0.1 * std::sqrt(tol()); }
+    static inline double tol2() throw() { return 0.1 * tol(); }
+    static inline double taytol() throw() { return std::pow(tol(), 0.6); }
+    // Overflow value for asinh(tan(pi/2)) etc.
+    static inline double ahypover() throw() {
+      return double(std::numeric_limits<double>::digits) /
+	std::log(double(std::numeric_limits<double>::radix)) + 2;
+    }
     static const int numit = 10;
     const double _a, _f, _k0, _mu, _mv, _e, _ep2;
     const bool _extendp;
@@ -185,10 +196,27 @@ namespace GeographicLib {
      * A global instantiation of TransverseMercatorExact with the WGS84
      * ellipsoid and the UTM scale factor.  However, unlike UTM, no false
      * easting or northing is added.
+     *
+     * UTM is constructed before the static objects in any file which
+     * includes this header, so it may be used in their initialization.
      **********************************************************************/
-    const static TransverseMercatorExact UTM;
+    const static TransverseMercatorExact& UTM;
+
+    /// \cond SKIP
+    // Each file including this header has an Init; the first constructs UTM.
+    class Init {
+    public:
+      Init() throw();
+    private:
+      static int _count;
+    };
+    /// \endcond
   };
 
+  namespace {
+    TransverseMercatorExact::Init TransverseMercatorExact_init;
+  }
+
 } // namespace GeographicLib
 
 #endif
@@ -8,7 +8,7 @@
  *
  * Compile with
  *
- *   g++ -g -O3 -I.. -o TransverseMercatorTest TransverseMercatorTest.cpp TransverseMercatorExact.cpp Constants.cpp EllipticFunction.cpp TransverseMercator.cpp
+ *   g++ -g -O3 -I.. -o TransverseMercatorTest TransverseMercatorTest.cpp TransverseMercatorExact.cpp Constants.cpp EllipticFunction.cpp TransverseMercator.cpp PointFile.cpp Utility.cpp
  *
  * See \ref transversemercatortest for usage information.
  **********************************************************************/
@@ -16,13 +16,19 @@
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdio>
 #include "GeographicLib/EllipticFunction.hpp"
 #include "GeographicLib/TransverseMercatorExact.hpp"
 #include "GeographicLib/TransverseMercator.hpp"
+#include "GeographicLib/PointFile.hpp"
+#include "GeographicLib/Utility.hpp"
 
 int usage(int retval) {
   ( retval ? std::cerr : std::cout ) <<
-"TransverseMercatorTest [-r] [-t|-s]\n\
+"TransverseMercatorTest [-r] [-t|-s] [-R file] [-W file]\n\
 $Id: TransverseMercatorTest.cpp 6558 2009-02-27 23:42:54Z ckarney $\n\
 \n\
 Convert between geographic coordinates and transverse Mercator coordinates.\n\
@@ -53,12 +59,139 @@ The domain of easting (x) and northing (x) is the union of\n\
 -s and -t are mutually exclusive (the last flag specified is the operative\n\
 one).\n\
 \n\
+-R file reads the input from the lat and lon (or x and y with -r)\n\
+columns of a point file, a memory mapped binary file with named columns\n\
+of doubles (see the documentation of PointFile).  -W file writes the\n\
+results to the lat, lon, x, y, gamma, and k columns of a point file.\n\
+\n\
 -h prints this help.\n";
   return retval;
 }
 
+// Project the point (a, b) (latitude and longitude, or easting and
+// northing if reverse) storing the latitude, longitude, easting, northing,
+// convergence, and scale in element i of the columns v.
+void Project(bool reverse, bool series,
+	     const GeographicLib::TransverseMercatorExact& TME,
+	     const GeographicLib::TransverseMercator& TMS,
+	     double a, double b, double* const v[], size_t i) {
+  double
+    &lat = v[0][i], &lon = v[1][i], &x = v[2][i], &y = v[3][i],
+    &gamma = v[4][i], &k = v[5][i];
+  if (reverse) {
+    x = a; y = b;
+    if (series)
+      TMS.Reverse(0.0, x, y, lat, lon, gamma, k);
+    else
+      TME.Reverse(0.0, x, y, lat, lon, gamma, k);
+  } else {
+    lat = a; lon = b;
+    if (series)
+      TMS.Forward(0.0, lat, lon, x, y, gamma, k);
+    else
+      TME.Forward(0.0, lat, lon, x, y, gamma, k);
+  }
+}
+
+// Project the points in the point file infile (or on standard input if
+// infile is empty) writing the results to the point file outfile (or
+// standard output if outfile is empty).  The input columns are read in
+// place from the mapped file.  The points are handled in blocks which are
+// split between the threads; with standard output each thread formats its
+// share of the block and the blocks are written in order.
+int Files(const std::string& infile, const std::string& outfile,
+	  bool reverse, bool series,
+	  const GeographicLib::TransverseMercatorExact& TME,
+	  const GeographicLib::TransverseMercator& TMS) {
+  static const char* const names[6] = {"lat", "lon", "x", "y", "gamma", "k"};
+  const size_t block = size_t(1) << 16;
+  try {
+    GeographicLib::PointFile ifile, ofile;
+    std::vector<double> in[2];
+    const double* src[2] = {0, 0};
+    size_t n;
+    if (infile.empty()) {
+      double a, b;
+      while (std::cin >> a >> b) {
+	in[0].push_back(a);
+	in[1].push_back(b);
+      }
+      n = in[0].size();
+      for (int j = 0; j < 2 && n; ++j)
+	src[j] = &in[j][0];
+    } else {
+      ifile.Open(infile);
+      n = ifile.Size();
+      for (int j = 0; j < 2; ++j)
+	src[j] = ifile.Data(names[reverse ? j + 2 : j]);
+    }
+    std::vector<double> buf[6];
+    double* v[6];
+    if (outfile.empty())
+      for (int j = 0; j < 6; ++j) {
+	buf[j].resize(std::min(n, block));
+	v[j] = n ? &buf[j][0] : 0;
+      }
+    else {
+      ofile.Create(outfile, n, "lat lon x y gamma k", false, &ifile);
+      for (int j = 0; j < 6; ++j)
+	v[j] = ofile.Data(j);
+    }
+    // TME computes its complete elliptic integrals on first use; do this
+    // before it is shared between threads.
+    {
+      double lat, lon, gamma, k;
+      TME.Reverse(0.0, 0.0, 0.0, lat, lon, gamma, k);
+    }
+    const int nthreads = GeographicLib::Utility::SetThreads(0);
+    std::vector<std::string> text(nthreads);
+    for (size_t i0 = 0; i0 < n; i0 += block) {
+      const int
+	m = int(std::min(block, n - i0)),
+	nt = std::max(1, std::min(nthreads, m / 1000));
+      // Index into v: the block buffers for standard output, otherwise
+      // the output file.
+      const size_t off = outfile.empty() ? 0 : i0;
+#if defined(_OPENMP)
+#pragma omp parallel for num_threads(nt) schedule(static)
+#endif
+      for (int t = 0; t < nt; ++t) {
+	const int
+	  ia = int((long long)(m) * t / nt),
+	  ib = int((long long)(m) * (t + 1) / nt);
+	for (int i = ia; i < ib; ++i)
+	  Project(reverse, series, TME, TMS,
+		  src[0][i0 + i], src[1][i0 + i], v, off + i);
+	if (outfile.empty()) {
+	  std::string& s = text[t];
+	  s.clear();
+	  char line[200];
+	  for (int i = ia; i < ib; ++i) {
+	    int len = std::sprintf(line, "%.16g %.16g %.16g %.16g %.16g %.16g\n",
+				   v[0][i], v[1][i], v[2][i],
+				   v[3][i], v[4][i], v[5][i]);
+	    s.append(line, len);
+	  }
+	}
+      }
+      if (outfile.empty())
+	for (int t = 0; t < nt; ++t)
+	  std::fwrite(text[t].data(), 1, text[t].size(), stdout);
+    }
+    std::fflush(stdout);
+    ifile.Close();
+    ofile.Close();
+  }
+  catch (std::runtime_error& e) {
+    std::cerr << "ERROR: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
+
 int main(int argc, char* argv[]) {
   bool reverse = false, testing = false, series = false;
+  std::string infile, outfile;
   for (int m = 1; m < argc; ++m) {
     std::string arg(argv[m]);
     if (arg == "-r")
@@ -69,6 +202,12 @@ int main(int argc, char* argv[]) {
     } else if (arg == "-s") {
       testing = false;
       series = true;
+    } else if (arg == "-R") {
+      if (++m == argc) return usage(1);
+      infile = std::string(argv[m]);
+    } else if (arg == "-W") {
+      if (++m == argc) return usage(1);
+      outfile = std::string(argv[m]);
     } else
       return usage(arg != "-h");
   }
@@ -87,6 +226,9 @@ int main(int argc, char* argv[]) {
   const GeographicLib::TransverseMercator& TMS =
     GeographicLib::TransverseMercator::UTM;
 
+  if (!(infile.empty() && outfile.empty()))
+    return Files(infile, outfile, reverse, series, TME, TMS);
+
   std::cout << std::setprecision(16);
   while (true) {
     double lat, lon, x, y;
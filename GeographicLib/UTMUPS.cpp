@@ -65,52 +65,79 @@ namespace GeographicLib {
     return zone;
   }
 
-  void UTMUPS::Forward(double lat, double lon,
-		       int& zone, bool& northp, double& x, double& y,
-		       double& gamma, double& k,
-		       int setzone) {
-    CheckLatLon(lat, lon);
-    northp = lat >= 0;
-    zone = setzone >= 0 ? setzone : StandardZone(lat, lon);
-    if (setzone > 60)
-      throw out_of_range("Illegal UTM zone requested " + setzone);
-    double x1, y1;
-    bool utmp = zone > 0;
+  bool UTMUPS::DoForward(double lat, double lon,
+			 int& zone, bool& northp, double& x, double& y,
+			 double& gamma, double& k,
+			 int setzone, bool throwp) {
+    if (!CheckLatLon(lat, lon, throwp))
+      return false;
+    bool northp1 = lat >= 0;
+    int zone1 = setzone >= 0 ? setzone : StandardZone(lat, lon);
+    if (setzone > 60) {
+      if (!throwp) return false;
+      throw out_of_range("Illegal UTM zone requested " + str(setzone));
+    }
+    double x1, y1, gamma1, k1;
+    bool utmp = zone1 > 0;
     if (utmp) {
       double
-	lon0 = CentralMeridian(zone),
+	lon0 = CentralMeridian(zone1),
 	dlon = lon - lon0;
       dlon = abs(dlon - 360 * floor((dlon + 180)/360));
-      if (dlon > 60)
+      if (dlon > 60) {
 	// Check isn't really necessary because CheckCoords catches this case.
 	// But this allows a more meaningful error message to be given.
+	if (!throwp) return false;
 	throw out_of_range("Longitude " + str(lon)
 				+ "d more than 60d from center of UTM zone "
-				+ str(zone));
-      TransverseMercator::UTM.Forward(lon0, lat, lon, x1, y1, gamma, k);
+				+ str(zone1));
+      }
+      TransverseMercator::UTM.Forward(lon0, lat, lon, x1, y1, gamma1, k1);
     } else {
-      if (abs(lat) < 70)
+      if (abs(lat) < 70) {
 	// Check isn't really necessary ... (see above).
+	if (!throwp) return false;
 	throw out_of_range("Latitude " + str(lat)
 				+ "d more than 20d from "
-				+ (northp ? "N" : "S") + " pole");
-      PolarStereographic::UPS.Forward(northp, lat, lon, x1, y1, gamma, k);
+				+ (northp1 ? "N" : "S") + " pole");
+      }
+      PolarStereographic::UPS.Forward(northp1, lat, lon, x1, y1, gamma1, k1);
     }
-    int ind = (utmp ? 2 : 0) + (northp ? 1 : 0);
-    x = x1 + falseeasting[ind];
-    y = y1 + falsenorthing[ind];
-    if (! CheckCoords(zone > 0, northp, x, y, false) )
+    int ind = (utmp ? 2 : 0) + (northp1 ? 1 : 0);
+    x1 += falseeasting[ind];
+    y1 += falsenorthing[ind];
+    if (! CheckCoords(zone1 > 0, northp1, x1, y1, false) ) {
+      if (!throwp) return false;
       throw out_of_range("Latitude " + str(lat) +
 			      ", longitude " + str(lon) +
 			      " out of legal range for " +
-			      (utmp ? "UTM zone " + str(zone) : "UPS"));
+			      (utmp ? "UTM zone " + str(zone1) : "UPS"));
+    }
+    zone = zone1;
+    northp = northp1;
+    x = x1;
+    y = y1;
+    gamma = gamma1;
+    k = k1;
+    return true;
   }
 
-  void UTMUPS::Reverse(int zone, bool northp, double x, double y,
-		       double& lat, double& lon, double& gamma, double& k) {
-    if (! (zone >= 0 && zone <= 60))
+  void UTMUPS::Forward(double lat, double lon,
+		       int& zone, bool& northp, double& x, double& y,
+		       double& gamma, double& k,
+		       int setzone) {
+    DoForward(lat, lon, zone, northp, x, y, gamma, k, setzone, true);
+  }
+
+  bool UTMUPS::DoReverse(int zone, bool northp, double x, double y,
+			 double& lat, double& lon, double& gamma, double& k,
+			 bool throwp) {
+    if (! (zone >= 0 && zone <= 60)) {
+      if (!throwp) return false;
       throw out_of_range("Illegal UTM zone " + str(zone));
-    CheckCoords(zone > 0, northp, x, y);
+    }
+    if (!CheckCoords(zone > 0, northp, x, y, throwp))
+      return false;
     bool utmp = zone > 0;
     int ind = (utmp ? 2 : 0) + (northp ? 1 : 0);
     x -= falseeasting[ind];
@@ -120,16 +147,27 @@ namespace GeographicLib {
 				      x, y, lat, lon, gamma, k);
     else
       PolarStereographic::UPS.Reverse(northp, x, y, lat, lon, gamma, k);
+    return true;
   }
 
-  void UTMUPS::CheckLatLon(double lat, double lon) {
-    if (! (lat >= -90 && lat <= 90))
+  void UTMUPS::Reverse(int zone, bool northp, double x, double y,
+		       double& lat, double& lon, double& gamma, double& k) {
+    DoReverse(zone, northp, x, y, lat, lon, gamma, k, true);
+  }
+
+  bool UTMUPS::CheckLatLon(double lat, double lon, bool throwp) {
+    if (! (lat >= -90 && lat <= 90)) {
+      if (!throwp) return false;
       throw out_of_range("Latitude " + str(lat) +
 			      "d not in [-90d, 90d]");
-    if (! (lon >= -180 && lon <= 360))
+    }
+    if (! (lon >= -180 && lon <= 360)) {
+      if (!throwp) return false;
       throw out_of_range("Latitude " + str(lon) +
 			      "d not in [-180d, 360d]");
     }
+    return true;
+  }
 
   bool UTMUPS::CheckCoords(bool utmp, bool northp, double x, double y,
 			   bool throwp) {
@@ -67,11 +67,24 @@ namespace GeographicLib {
     template<typename T> static std::string str(T x) {
       std::ostringstream s; s << x; return s.str();
     }
-    static void CheckLatLon(double lat, double lon);
+    // Throw an error if latitude or longitude are out of range.  If throwp =
+    // false, return bool instead.
+    static bool CheckLatLon(double lat, double lon, bool throwp = true);
     // Throw an error if easting or northing are outside standard ranges.  If
     // throwp = false, return bool instead.
     static bool CheckCoords(bool utmp, bool northp, double x, double y,
 			    bool throwp = true);
+    // The implementations of Forward and Reverse.  On failure, throw an error
+    // if throwp, otherwise return false.
+    static bool DoForward(double lat, double lon,
+			  int& zone, bool& northp, double& x, double& y,
+			  double& gamma, double& k,
+			  int setzone, bool throwp);
+    static bool DoReverse(int zone, bool northp, double x, double y,
+			  double& lat, double& lon, double& gamma, double& k,
+			  bool throwp);
+    friend class GeoCoords;	// GeoCoords::Parse uses DoForward, DoReverse
+    friend class GeoCoordsArray; // and so does GeoCoordsArray
   public:
 
     /**
@@ -0,0 +1,99 @@
+/**
+ * \file Utility.cpp
+ * \brief Implementation for GeographicLib::Utility class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#include "GeographicLib/Utility.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+namespace {
+  char RCSID[] = "$Id$";
+  char RCSID_H[] = UTILITY_HPP;
+}
+
+namespace GeographicLib {
+
+  using namespace std;
+
+  int Utility::SetThreads(int nthreads) throw() {
+#if defined(_OPENMP)
+    if (nthreads > 0)
+      omp_set_num_threads(nthreads);
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+  }
+
+  bool Utility::ReadNumber(const char* s, int len, double& x) throw() {
+    char buf[64];
+    if (len >= int(sizeof(buf)))
+      return false;
+    for (int i = 0; i < len; ++i)
+      if (!(isdigit((unsigned char)(s[i])) || strchr("+-.eE", s[i])))
+	return false;
+    memcpy(buf, s, len);
+    buf[len] = '\0';
+    char* end;
+    x = strtod(buf, &end);
+    return end == buf + len && abs(x) <= numeric_limits<double>::max();
+  }
+
+  void Utility::LittleEndian(double x[], size_t n) throw() {
+    const int one = 1;
+    if (*reinterpret_cast<const char*>(&one))
+      return;
+    for (size_t i = 0; i < n; ++i) {
+      char* p = reinterpret_cast<char*>(x + i);
+      reverse(p, p + sizeof(double));
+    }
+  }
+
+  bool Utility::LineBlocks::Next() {
+    if (_eof)
+      return false;
+    // Move the partial line left from the last block to the front.
+    size_t carry = _len - _stop;
+    if (carry)
+      memmove(&_buf[0], &_buf[0] + _stop, carry);
+    _len = carry;
+    while (true) {
+      _buf.resize(_len + _blocksize);
+      size_t nread = fread(&_buf[0] + _len, 1, _blocksize, _file);
+      _len += nread;
+      _stop = _len;
+      _eof = nread < _blocksize;
+      if (_eof)
+	break;
+      // Only return complete lines; keep the rest for the next block.
+      while (_stop > 0 && _buf[_stop - 1] != '\n')
+	--_stop;
+      if (_stop > 0)
+	break;
+      // No newline yet; read more
+    }
+    _beg.clear();
+    _end.clear();
+    for (size_t i = 0; i < _stop;) {
+      const char* nl =
+	static_cast<const char*>(memchr(&_buf[0] + i, '\n', _stop - i));
+      size_t j = nl ? nl - &_buf[0] : _stop;
+      _beg.push_back(i);
+      _end.push_back(j);
+      i = j + 1;
+    }
+    return true;
+  }
+
+} // namespace GeographicLib
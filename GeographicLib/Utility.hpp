@@ -0,0 +1,107 @@
+/**
+ * \file Utility.hpp
+ * \brief Header for GeographicLib::Utility class
+ *
+ * Copyright (c) the GeographicLib contributors (2009)
+ * and licensed under the LGPL.
+ **********************************************************************/
+
+#if !defined(UTILITY_HPP)
+#define UTILITY_HPP "$Id$"
+
+#include <cstdio>
+#include <cstddef>
+#include <vector>
+
+namespace GeographicLib {
+
+  /**
+   * \brief Input helpers for the command line utilities
+   *
+   * The block-parallel and binary modes of the command line utilities set
+   * the number of threads, read plain decimal numbers without using
+   * streams, read the standard input in blocks of complete lines, and
+   * convert binary records to and from little-endian order in the same
+   * way.  This class holds the code for this.
+   **********************************************************************/
+  class Utility {
+  public:
+
+    /**
+     * Set the number of OpenMP threads to \e nthreads if this is positive
+     * (this also sets the number used by the batch functions of the
+     * library, see Parallel).  Return the number of threads to use, which
+     * is 1 if compiled without OpenMP.
+     **********************************************************************/
+    static int SetThreads(int nthreads) throw();
+
+    /**
+     * Read the \e len chars at \e s as a plain decimal number, storing it
+     * in \e x.  Return false for any other form (e.g., hexadecimal or
+     * infinite values or trailing characters) which the caller should then
+     * handle in the usual way.
+     **********************************************************************/
+    static bool ReadNumber(const char* s, int len, double& x) throw();
+
+    /**
+     * Reverse the bytes of the \e n doubles at \e x if this machine is
+     * big-endian so that they are converted to or from little-endian order.
+     **********************************************************************/
+    static void LittleEndian(double x[], std::size_t n) throw();
+
+    /**
+     * \brief Read a file in blocks of complete lines
+     *
+     * Next reads a block of about \e blocksize chars from the file and
+     * splits it into lines (without the trailing newlines).  A partial
+     * line at the end of the block is carried over to the next block.  The
+     * lines of a block are valid until the next call to Next.
+     **********************************************************************/
+    class LineBlocks {
+    private:
+      std::FILE* _file;
+      std::size_t _blocksize, _len, _stop;
+      bool _eof;
+      std::vector<char> _buf;
+      std::vector<std::size_t> _beg, _end;
+    public:
+
+      /**
+       * Set up to read \e file in blocks of \e blocksize chars.
+       **********************************************************************/
+      explicit LineBlocks(std::FILE* file,
+			  std::size_t blocksize = std::size_t(1) << 22)
+	throw()
+	: _file(file)
+	, _blocksize(blocksize)
+	, _len(0)
+	, _stop(0)
+	, _eof(false) {}
+
+      /**
+       * Read the next block of lines.  Return false at the end of the file.
+       * The last block (ending at the end of the file) may have no lines.
+       * This throws std::bad_alloc if the buffers can't be allocated.
+       **********************************************************************/
+      bool Next();
+
+      /**
+       * The number of lines in the current block.
+       **********************************************************************/
+      int Lines() const throw() { return int(_beg.size()); }
+
+      /**
+       * The start of line \e i of the current block.
+       **********************************************************************/
+      const char* Line(int i) const throw() { return &_buf[0] + _beg[i]; }
+
+      /**
+       * The length of line \e i of the current block.
+       **********************************************************************/
+      int Length(int i) const throw() { return int(_end[i] - _beg[i]); }
+    };
+  };
+
+} // namespace GeographicLib
+
+#endif